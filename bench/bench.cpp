@@ -0,0 +1,394 @@
+/**
+ * @file bench.cpp
+ * @author Adam Berkeš <berkeada@fit.cvut.cz>
+ * @date 2026-10-19
+ *
+ * Micro-benchmarks of object rasterizers, encoders and scene parsing.
+ * Results are printed to stdout as JSON, optional arguments are substrings
+ * of which at least one has to be contained in "group/name" of a benchmark
+ * for it to be run.
+ */
+
+#include "../src/encoder/bmp_encoder.hpp"
+#include "../src/encoder/png_encoder.hpp"
+#include "../src/encoder/ppm_encoder.hpp"
+#include "../src/image/image_builder.hpp"
+#include "../src/image/span_fill.hpp"
+#include "../src/object/circle.hpp"
+#include "../src/object/curve.hpp"
+#include "../src/object/ellipse.hpp"
+#include "../src/object/line.hpp"
+#include "../src/object/object_registry.hpp"
+#include "../src/object/polygon.hpp"
+#include "../src/object/rectangle.hpp"
+#include "../src/object/regular_polygon.hpp"
+#include "../src/object/path.hpp"
+#include "../src/object/polyline.hpp"
+#include "../src/object/spiral.hpp"
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <vector>
+
+using namespace std;
+using bench_clock = chrono::steady_clock;
+
+/** Minimum duration of a single sample */
+constexpr double MIN_SAMPLE_NS = 20e6;
+/** Number of samples the best one is chosen from */
+constexpr int SAMPLE_COUNT = 5;
+
+/** Result of a single benchmark */
+struct Result
+{
+    string group, name, params;
+    long iterations;
+    double ns_per_op;
+    /** Number of pixels processed by a single operation, 0 if it doesn't process pixels */
+    long pixels;
+    /** Number of bytes processed by a single operation */
+    long bytes;
+};
+
+/** Stream buffer discarding everything written into it */
+class NullBuffer : public streambuf
+{
+protected:
+    int overflow(int c) override { return c; }
+
+    streamsize xsputn(const char *, streamsize count) override { return count; }
+};
+
+/**
+ * @brief Run the operation repeatedly, first calibrating the number of calls
+ * so that each sample takes at least MIN_SAMPLE_NS
+ *
+ * @param op Benchmarked operation
+ * @return pair<long, double> Number of calls per sample and the best time of a single call in ns
+ */
+static pair<long, double> measure(const function<void()> &op)
+{
+    long iterations = 1;
+
+    while (true)
+    {
+        auto start = bench_clock::now();
+        for (long i = 0; i < iterations; i++)
+            op();
+        double ns = chrono::duration<double, nano>(bench_clock::now() - start).count();
+
+        if (ns >= MIN_SAMPLE_NS)
+            break;
+
+        iterations *= 2;
+    }
+
+    double best = numeric_limits<double>::max();
+    for (int sample = 0; sample < SAMPLE_COUNT; sample++)
+    {
+        auto start = bench_clock::now();
+        for (long i = 0; i < iterations; i++)
+            op();
+        double ns = chrono::duration<double, nano>(bench_clock::now() - start).count();
+
+        best = min(best, ns / iterations);
+    }
+
+    return {iterations, best};
+}
+
+/** Collection of benchmarks which are run only if they match the filters */
+class Bench
+{
+    vector<string> filters;
+    vector<Result> results;
+
+public:
+    Bench(vector<string> filters_) : filters(std::move(filters_)) {}
+
+    /** Check whether the benchmark was selected to be run */
+    bool is_selected(const string &group, const string &name) const
+    {
+        string id = group + '/' + name;
+
+        if (filters.empty())
+            return true;
+
+        for (const string &filter : filters)
+            if (id.find(filter) != string::npos)
+                return true;
+
+        return false;
+    }
+
+    /** Run the benchmark, pixels and bytes are the amount processed by a single operation */
+    void run(const string &group, const string &name, const string &params,
+             long pixels, long bytes, const function<void()> &op)
+    {
+        if (!is_selected(group, name))
+            return;
+
+        const auto &[iterations, ns_per_op] = measure(op);
+        results.push_back({group, name, params, iterations, ns_per_op, pixels, bytes});
+
+        cerr << group << '/' << name << ' ' << params << ": " << ns_per_op << " ns" << endl;
+    }
+
+    /** Print all the results as JSON */
+    void print_json(ostream &os) const
+    {
+        os << "{\n"
+           << "  \"span_fill_kernel\": \"" << span_fill::get_kernel_name() << "\",\n"
+           << "  \"results\": [";
+
+        for (size_t i = 0; i < results.size(); i++)
+        {
+            const Result &res = results[i];
+            double seconds = res.ns_per_op / 1e9;
+
+            os << (i == 0 ? "\n" : ",\n")
+               << "    {\"group\": \"" << res.group << "\", \"name\": \"" << res.name
+               << "\", \"params\": \"" << res.params << "\", \"iterations\": " << res.iterations
+               << ", \"ns_per_op\": " << res.ns_per_op << ", \"pixels\": " << res.pixels
+               << ", \"ns_per_pixel\": ";
+
+            if (res.pixels > 0)
+                os << res.ns_per_op / res.pixels;
+            else
+                os << "null";
+
+            os << ", \"bytes\": " << res.bytes
+               << ", \"mb_per_s\": " << (res.bytes / 1e6) / seconds << '}';
+        }
+
+        os << "\n  ]\n}" << endl;
+    }
+};
+
+/** Count pixels of the image which differ from the background */
+static long count_drawn(const Image &image, const Pixel &background)
+{
+    long count = 0;
+
+    for (int y = 0; y < image.get_height(); y++)
+        for (int x = 0; x < image.get_width(); x++)
+        {
+            Pixel pixel = image.get_buffer()(x, y);
+            count += pixel.r != background.r || pixel.g != background.g || pixel.b != background.b;
+        }
+
+    return count;
+}
+
+/**
+ * @brief Get parameters of an object fitting into square of given size
+ * placed at the margin of the canvas
+ */
+static string get_object_params(const string &name, int size, int width, int margin)
+{
+    int c = margin + size / 2, end = margin + size;
+    string m = to_string(margin), style = " width=" + to_string(width) + " color=#fff";
+
+    if (name == "line")
+        return "((" + m + ',' + m + ");(" + to_string(end) + ',' +
+               to_string(margin + size * 3 / 5) + "))" + style;
+    else if (name == "circle")
+        return "(" + to_string(c) + ',' + to_string(c) + ") radius=" + to_string(size / 2) + style;
+    else if (name == "ellipse")
+        return "(" + to_string(c) + ',' + to_string(c) + ") radius_x=" + to_string(size / 2) +
+               " radius_y=" + to_string(size / 3) + style;
+    else if (name == "curve")
+        return "((" + m + ',' + to_string(end) + ");(" + to_string(c) + ',' + m + ");(" +
+               to_string(end) + ',' + to_string(end) + "))" + style;
+    else if (name == "rectangle")
+        return "((" + m + ',' + m + ");(" + to_string(end) + ',' + to_string(end) + "))" + style;
+    else if (name == "polygon")
+        return "((" + to_string(c) + ',' + m + ");(" + to_string(end) + ',' + to_string(c) +
+               ");(" + to_string(margin + size * 3 / 4) + ',' + to_string(end) + ");(" +
+               to_string(margin + size / 4) + ',' + to_string(end) + ");(" + m + ',' +
+               to_string(c) + "))" + style;
+    else if (name == "polyline")
+        return "((" + m + ',' + to_string(end) + ");(" + to_string(margin + size / 3) + ',' + m +
+               ");(" + to_string(margin + size * 2 / 3) + ',' + to_string(end) + ");(" +
+               to_string(end) + ',' + m + ")) join=round cap=round" + style;
+    else if (name == "regular_polygon")
+        return "(" + to_string(c) + ',' + to_string(margin + size / 10) +
+               ") n_sides=7 side=" + to_string(max(1, size * 2 / 5)) + style;
+    else
+        return "(" + to_string(c) + ',' + to_string(c) + ") rotations=" +
+               to_string(max(1, size / (8 * width))) + style;
+}
+
+/** Benchmark rendering of every object across sizes and stroke widths, aliased and anti-aliased */
+static void bench_objects(Bench &bench, const ObjectRegistry &registry)
+{
+    const Pixel background;
+
+    for (const string &name : vector<string>{"line", "circle", "ellipse", "curve", "rectangle",
+                                             "polygon", "polyline", "regular_polygon", "spiral"})
+        for (int size : {16, 128, 1024})
+            for (int width : {1, 4, 16})
+                for (bool antialiased : {false, true})
+                {
+                    if (!bench.is_selected("object", name))
+                        continue;
+
+                    // Spirals grow with their width, so the canvas is sized generously
+                    int margin = 4 * width + 8, canvas = size + 2 * margin;
+                    if (name == "spiral")
+                        canvas *= 3;
+
+                    Object::ptr obj = registry.parse_from_str(
+                        name + ' ' + get_object_params(name, size, width, margin), nullptr);
+                    Image image(canvas, canvas, background);
+                    image.set_antialiased(antialiased);
+                    obj->render(image, Transform());
+                    long pixels = count_drawn(image, background);
+
+                    bench.run("object", name,
+                              "size=" + to_string(size) + " width=" + to_string(width) +
+                                  (antialiased ? " antialiased" : ""),
+                              pixels, pixels * sizeof(Pixel),
+                              [&]()
+                              { obj->render(image, Transform()); });
+                }
+}
+
+/** Benchmark every encoder across image sizes, the output is discarded */
+static void bench_encoders(Bench &bench, const ObjectRegistry &registry)
+{
+    PPMEncoder ppm;
+    BMPEncoder bmp;
+    PNGEncoder png;
+    NullBuffer null_buffer;
+    ostream out(&null_buffer);
+
+    for (int size : {256, 1024, 2048})
+    {
+        // Some content, so that compression has something to work with
+        Image image(size, size, Pixel("#203040"));
+        for (int i = 1; i <= 8; i++)
+            registry
+                .parse_from_str("circle (" + to_string(size / 2) + ',' + to_string(size / 2) +
+                                    ") radius=" + to_string(size * i / 18) + " width=" +
+                                    to_string(i) + " color=#" + to_string(i * 111 % 1000),
+                                nullptr)
+                ->render(image, Transform());
+
+        long pixels = static_cast<long>(size) * size;
+        string params = "size=" + to_string(size) + 'x' + to_string(size);
+
+        for (const auto &[name, encoder] : {pair<string, const Encoder *>("ppm", &ppm),
+                                            pair<string, const Encoder *>("bmp", &bmp),
+                                            pair<string, const Encoder *>("png", &png)})
+            bench.run("encoder", name, params, pixels, image.get_size(),
+                      [&, encoder = encoder]()
+                      { encoder->encode(out, image); });
+    }
+}
+
+/**
+ * Benchmark filling spans with opaque colors, compositing translucent ones over them
+ * and downsampling supersampled rows
+ */
+static void bench_spans(Bench &bench)
+{
+    for (int length : {16, 256, 4096})
+    {
+        Image image(length, 1, Pixel("#203040"));
+        long bytes = length * sizeof(Pixel);
+
+        for (const auto &[name, color] : {pair<string, Color>("fill", Color("#ff8040")),
+                                          pair<string, Color>("blend", Color("#ff804080"))})
+            bench.run("span", name, "length=" + to_string(length), length, bytes,
+                      [&, color = color]()
+                      { image.get_buffer().fill_span(0, 0, length, color); });
+
+        // Averaging the samples of a supersampled row, which is done while encoding it
+        for (int factor : {2, 4})
+        {
+            Image supersampled(length * factor, factor, Pixel("#203040"));
+            supersampled.set_supersampling(factor);
+            vector<Pixel> row(length);
+            vector<unsigned char> alpha(length);
+
+            bench.run("span", "downsample",
+                      "length=" + to_string(length) + " factor=" + to_string(factor), length,
+                      bytes * factor * factor, [&]()
+                      { supersampled.resolve_row(0, row.data(), alpha.data()); });
+        }
+    }
+}
+
+/** Benchmark parsing of scene files with given number of objects */
+static void bench_parsing(Bench &bench, const ObjectRegistry &registry)
+{
+    const vector<string> object_lines = {
+        "line ((10,10);(500,300)) width=3 color=#f00",
+        "circle (500,500) radius=120 width=4",
+        "ellipse (300,200) radius_x=80 radius_y=40 color=#0f0",
+        "curve ((10,10);(200,400);(400,10)) width=2",
+        "rectangle ((100,100);(300,250)) width=5 color=#00f",
+        "polygon ((100,100);(200,200);(100,300);(0,200))",
+        "spiral (600,600) rotations=4",
+        "regular_polygon (700,300) n_sides=6 side=40",
+        "shape (20,20) scale=(2,1)"};
+    const string group = "start_group shape\n"
+                         "    line ((0,0);(10,10))\n"
+                         "    circle (5,5) radius=4\n"
+                         "end_group\n";
+
+    for (int count : {1000, 10000, 100000})
+    {
+        if (!bench.is_selected("parse", "image_builder"))
+            continue;
+
+        filesystem::path file = filesystem::temp_directory_path() / "shapescape_bench_scene.txt";
+        {
+            ofstream out(file);
+            out << "image 1000 1000 background=#000\n"
+                << group;
+            for (int i = 0; i < count; i++)
+                out << object_lines[i % object_lines.size()] << '\n';
+        }
+
+        bench.run("parse", "image_builder", "objects=" + to_string(count), 0,
+                  filesystem::file_size(file),
+                  [&]()
+                  { ImageBuilder builder(registry, file.string()); });
+
+        filesystem::remove(file);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    ObjectRegistry registry;
+    registry
+        .add("line", Line::parse_from_str)
+        .add("circle", Circle::parse_from_str)
+        .add("rectangle", Rectangle::parse_from_str)
+        .add("ellipse", Ellipse::parse_from_str)
+        .add("polygon", Polygon::parse_from_str)
+        .add("curve", Curve::parse_from_str)
+        .add("spiral", Spiral::parse_from_str)
+        .add("regular_polygon", RegularPolygon::parse_from_str)
+        .add("path", Path::parse_from_str)
+        .add("polyline", Polyline::parse_from_str);
+
+    Bench bench(vector<string>(argv + 1, argv + argc));
+
+    bench_objects(bench, registry);
+    bench_encoders(bench, registry);
+    bench_spans(bench);
+    bench_parsing(bench, registry);
+
+    bench.print_json(cout);
+
+    return EXIT_SUCCESS;
+}
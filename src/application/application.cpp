@@ -5,15 +5,299 @@
  */
 
 #include "application.hpp"
-#include "../image/image_builder.hpp"
+#include "render_server.hpp"
+#include "../trace.hpp"
+#include "../utils.hpp"
+#include "../work_stealing_pool.hpp"
 
-#include <filesystem>
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <poll.h>
+#include <sstream>
+#include <stdexcept>
+#include <sys/inotify.h>
+#include <thread>
+#include <unistd.h>
 
 using namespace std;
+using namespace utils;
+
+/** Server which is stopped by SIGINT and SIGTERM */
+static RenderServer *running_server = nullptr;
+/** Whether the process was asked to terminate by SIGINT or SIGTERM */
+static volatile sig_atomic_t is_interrupted = 0;
+/** Interval of checking whether the watched source should stop being watched */
+constexpr int WATCH_POLL_MS = 100;
+
+/** Stop the running server or watching once the process is asked to terminate */
+static void interrupt(int)
+{
+    is_interrupted = 1;
+
+    if (running_server != nullptr)
+        running_server->stop();
+}
 
 Application::Application(const ObjectRegistry &objects_, const EncoderRegistry &encoders_)
     : objects(objects_), encoders(encoders_) {}
 
+vector<Application::BatchJob> Application::parse_manifest(const string &manifest)
+{
+    fstream is = try_open_file(manifest);
+    vector<BatchJob> jobs;
+    string line;
+
+    for (size_t line_number = 1; getline(is, line); line_number++)
+    {
+        istringstream line_stream(line);
+        BatchJob job;
+
+        if (!(line_stream >> job.source) || job.source[0] == '#')
+            continue;
+
+        for (string output; line_stream >> output;)
+            job.outputs.push_back(output);
+
+        if (job.outputs.empty())
+            throw invalid_argument(manifest + ':' + to_string(line_number) +
+                                   ": no output files entered for " + job.source);
+
+        jobs.push_back(std::move(job));
+    }
+
+    check_fstream(is, manifest);
+
+    return jobs;
+}
+
+void Application::render_to_file(ImageBuilder &image_builder, const filesystem::path &file,
+                                 const ApplicationArgs &args, Stats *stats,
+                                 ostream &err_out) const
+{
+    string extension = file.extension().string();
+    if (!extension.empty())
+        extension = extension.substr(1);
+    const Encoder &encoder = encoders.get(extension, &err_out);
+
+    if (image_builder.get_frame_count() > 1)
+        render_frames(image_builder, file, encoder, args, stats);
+    else if (args.get_band_height() > 0)
+    {
+        fstream out = try_open_file(file, ios_base::binary | ios_base::out);
+        image_builder.render_streamed(encoder, out, args.get_band_height());
+        check_fstream(out, file.filename());
+    }
+    else
+    {
+        if (args.get_is_mapped())
+            image_builder.map_image(encoder, file);
+        image_builder.render();
+
+        Stopwatch stopwatch;
+        encoder.encode_to_file(file, image_builder.get_image());
+        if (stats != nullptr)
+            stats->add_time("encode:" + encoder.get_name(), stopwatch.elapsed());
+    }
+}
+
+void Application::render_frames(const ImageBuilder &image_builder, const filesystem::path &file,
+                                const Encoder &encoder, const ApplicationArgs &args,
+                                Stats *stats) const
+{
+    if (args.get_band_height() > 0 || args.get_is_mapped())
+        throw invalid_argument("frames of an animation can't be rendered in bands "
+                               "or into mapped files");
+
+    size_t frame_count = image_builder.get_frame_count(),
+           digits = to_string(frame_count - 1).size();
+    vector<optional<string>> errors(frame_count);
+    Stopwatch stopwatch;
+
+    auto render_frame = [&](size_t frame)
+    {
+        string number = to_string(frame);
+        filesystem::path frame_file = file;
+        frame_file.replace_filename(file.stem().string() + '_' +
+                                    string(digits - number.size(), '0') + number +
+                                    file.extension().string());
+
+        try
+        {
+            encoder.encode_to_file(frame_file, image_builder.render_frame(frame));
+        }
+        catch (const exception &e)
+        {
+            errors[frame] = e.what();
+        }
+    };
+
+    // Jobs of a batch already keep all the workers busy
+    if (args.is_batch())
+        for (size_t frame = 0; frame < frame_count; frame++)
+            render_frame(frame);
+    else
+    {
+        WorkStealingPool pool(args.get_jobs());
+
+        for (size_t frame = 0; frame < frame_count; frame++)
+            pool.submit([&, frame]()
+                        { render_frame(frame); });
+    }
+
+    for (const optional<string> &error : errors)
+        if (error)
+            throw runtime_error(*error);
+
+    if (stats != nullptr)
+        stats->add_time("frames:" + encoder.get_name(), stopwatch.elapsed());
+}
+
+size_t Application::run_batch(const ApplicationArgs &args) const
+{
+    if (args.get_stats_file() || args.get_profile_count() > 0)
+        throw invalid_argument("statistics and profiles can't be collected in batch mode");
+
+    vector<BatchJob> jobs;
+    if (!args.get_manifest().empty())
+        jobs = parse_manifest(args.get_manifest());
+
+    // Each of the sources is rendered next to itself in all the formats entered
+    for (const string &source : args.get_sources())
+    {
+        BatchJob job{source, {}};
+
+        for (const auto &[opt, file] : args.get_options())
+            if (opt == Opt::Render)
+                job.outputs.push_back(
+                    filesystem::path(source).replace_extension(filesystem::path(file).extension()));
+
+        jobs.push_back(std::move(job));
+    }
+
+    vector<optional<string>> errors(jobs.size());
+    // Workers don't share cerr, so the output of the scenes isn't interleaved
+    vector<string> messages(jobs.size());
+    {
+        WorkStealingPool pool(args.get_jobs());
+
+        for (size_t i = 0; i < jobs.size(); i++)
+            pool.submit(
+                [&, i]()
+                {
+                    trace::Span span("batch", [&]()
+                                     { return jobs[i].source; });
+                    ostringstream err_out;
+
+                    try
+                    {
+                        ImageBuilder image_builder(objects, jobs[i].source, nullptr, &err_out);
+                        image_builder.set_antialiased(args.get_is_antialiased());
+                        image_builder.set_supersampling(args.get_supersampling());
+
+                        for (const string &output : jobs[i].outputs)
+                            render_to_file(image_builder, output, args, nullptr, err_out);
+                    }
+                    catch (const exception &e)
+                    {
+                        errors[i] = e.what();
+                    }
+                    messages[i] = err_out.str();
+                });
+    }
+
+    size_t failed = 0;
+    for (size_t i = 0; i < jobs.size(); i++)
+    {
+        istringstream message_stream(messages[i]);
+        for (string message; getline(message_stream, message);)
+            cerr << jobs[i].source << ": " << message << endl;
+
+        if (errors[i])
+        {
+            cerr << jobs[i].source << ": " << *errors[i] << endl;
+            failed++;
+        }
+    }
+
+    return failed;
+}
+
+void Application::watch(const ApplicationArgs &args, unique_ptr<ImageBuilder> image_builder) const
+{
+    if (args.get_band_height() > 0)
+        throw invalid_argument("watched source can't be rendered in bands");
+
+    // Editors often replace the file instead of writing into it, so the directory is watched
+    filesystem::path source = args.get_image_config(), directory = source.parent_path();
+    if (directory.empty())
+        directory = ".";
+
+    int fd = inotify_init1(IN_CLOEXEC);
+    if (fd == -1 || inotify_add_watch(fd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) == -1)
+    {
+        string error = strerror(errno);
+        if (fd != -1)
+            close(fd);
+        throw runtime_error("failed to watch " + source.string() + ": " + error);
+    }
+
+    cerr << "watching " << source.string() << " for changes" << endl;
+    alignas(inotify_event) char events[4096];
+
+    while (!is_interrupted)
+    {
+        pollfd watched{fd, POLLIN, 0};
+        if (poll(&watched, 1, WATCH_POLL_MS) <= 0)
+            continue;
+
+        ssize_t size = read(fd, events, sizeof(events));
+        bool is_changed = false;
+
+        for (ssize_t offset = 0; offset < size;)
+        {
+            const auto *event = reinterpret_cast<const inotify_event *>(events + offset);
+            is_changed |= event->len > 0 && source.filename() == event->name;
+            offset += sizeof(inotify_event) + event->len;
+        }
+
+        if (!is_changed)
+            continue;
+
+        // A source which can't be parsed is reported, and the last image is kept
+        try
+        {
+            Stopwatch stopwatch;
+            auto next = make_unique<ImageBuilder>(objects, source.string());
+            next->set_antialiased(args.get_is_antialiased());
+            next->set_supersampling(args.get_supersampling());
+            Rect dirty = next->render_incrementally(*image_builder);
+            image_builder = std::move(next);
+            double render_time = stopwatch.elapsed().wall;
+
+            if (!dirty.is_empty())
+                for (const auto &[opt, file] : args.get_options())
+                    if (opt == Opt::Render)
+                        render_to_file(*image_builder, file, args, nullptr);
+
+            cerr << "rendered " << dirty.get_width() << 'x' << dirty.get_height()
+                 << " pixels again in " << render_time * 1e3 << " ms, encoded in "
+                 << (stopwatch.elapsed().wall - render_time) * 1e3 << " ms" << endl;
+        }
+        catch (const exception &e)
+        {
+            cerr << e.what() << endl;
+        }
+    }
+
+    close(fd);
+}
+
 void Application::run(const ApplicationArgs &args)
 {
     if (args.get_options().size() > 0 && args.get_options()[0].first == Opt::Help)
@@ -22,24 +306,80 @@ void Application::run(const ApplicationArgs &args)
         return;
     }
 
-    ImageBuilder image_builder(objects, args.get_image_config());
+    if (!args.get_trace_file().empty())
+    {
+        trace::enable();
+        trace::set_thread_name("main");
+    }
+
+    size_t failed = 0;
+    const optional<string> &stats_file = args.get_stats_file();
+    Stats stats;
+    Stats *collected_stats = stats_file ? &stats : nullptr;
+    ObjectProfile profile;
+
+    if (!args.get_socket_path().empty())
+    {
+        size_t concurrency = args.get_jobs() > 0 ? args.get_jobs()
+                                                 : max(thread::hardware_concurrency(), 1u);
+        RenderServer server(objects, encoders, args.get_socket_path(), concurrency,
+                            args.get_queue_capacity(), args.get_band_height(),
+                            args.get_is_antialiased(), args.get_supersampling(),
+                            args.get_max_pixels());
+
+        running_server = &server;
+        signal(SIGINT, interrupt);
+        signal(SIGTERM, interrupt);
+        server.run();
+        running_server = nullptr;
 
-    filesystem::path render_to_path;
-    for (const pair<Opt, string> &cmd : args.get_options())
+        cerr << "server stopped after " << server.get_request_count() << " requests" << endl;
+    }
+    else if (args.is_batch())
+        failed = run_batch(args);
+    else
     {
-        switch (cmd.first)
+        auto image_builder = make_unique<ImageBuilder>(objects, args.get_image_config(),
+                                                       collected_stats);
+        image_builder->set_antialiased(args.get_is_antialiased());
+        image_builder->set_supersampling(args.get_supersampling());
+        if (args.get_profile_count() > 0)
+            image_builder->set_profile(&profile);
+
+        for (const auto &[opt, file] : args.get_options())
+            if (opt == Opt::Render)
+                render_to_file(*image_builder, file, args, collected_stats);
+
+        if (args.get_is_watched())
         {
-        case Opt::Help:
-            ApplicationArgs::print_help();
-            return;
-        case Opt::Render:
-            image_builder.render();
-            render_to_path = cmd.second;
-            string extension = render_to_path.extension().string();
-            if (!extension.empty())
-                extension = extension.substr(1);
-            encoders.get(extension).encode_to_file(render_to_path, image_builder.get_image());
-            break;
+            signal(SIGINT, interrupt);
+            signal(SIGTERM, interrupt);
+            watch(args, std::move(image_builder));
         }
     }
+
+    if (args.get_profile_count() > 0)
+        profile.print(cerr, args.get_profile_count());
+
+    if (trace::is_enabled())
+    {
+        trace::disable();
+        fstream out = try_open_file(args.get_trace_file(), ios_base::out);
+        trace::write_json(out);
+        check_fstream(out, args.get_trace_file());
+    }
+
+    if (failed > 0)
+        throw runtime_error(to_string(failed) + " scenes of the batch failed");
+
+    if (!stats_file)
+        return;
+    else if (stats_file->empty())
+        stats.print(cerr);
+    else
+    {
+        fstream out = try_open_file(*stats_file, ios_base::out);
+        stats.print_json(out);
+        check_fstream(out, *stats_file);
+    }
 }
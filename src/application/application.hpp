@@ -8,16 +8,101 @@
 
 #include "application_args.hpp"
 #include "../encoder/encoder_registry.hpp"
+#include "../image/image_builder.hpp"
 #include "../object/object_registry.hpp"
+#include "../stats.hpp"
+
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
 
 /**
  * @brief Class representing the whole ShapeScape application
  */
 class Application
 {
+    /** Scene rendered in batch mode along with the files it should be rendered into */
+    struct BatchJob
+    {
+        std::string source;
+        std::vector<std::string> outputs;
+    };
+
     ObjectRegistry objects;
     EncoderRegistry encoders;
 
+    /**
+     * @brief Parse manifest of a batch, each line of which contains a source
+     * followed by the files it should be rendered into separated by whitespace.
+     * Empty lines and lines starting with '#' are skipped
+     *
+     * @throws std::invalid_argument If the manifest couldn't be read, or a line
+     * doesn't contain any output file
+     * @param manifest File containing the manifest
+     * @return std::vector<BatchJob>
+     */
+    static std::vector<BatchJob> parse_manifest(const std::string &manifest);
+
+    /**
+     * @brief Render the image into a file, in the format given by its extension
+     *
+     * @throws std::invalid_argument If the format isn't supported or the file
+     * couldn't be opened
+     * @throws std::runtime_error If something went wrong while encoding
+     * @param image_builder Builder of the image
+     * @param file Output file
+     * @param args Arguments which determine the way the image is rendered
+     * @param stats Statistics to be collected, nullptr if they aren't collected
+     * @param err_out Stream verbose errors are printed to
+     */
+    void render_to_file(ImageBuilder &image_builder, const std::filesystem::path &file,
+                        const ApplicationArgs &args, Stats *stats,
+                        std::ostream &err_out = std::cerr) const;
+
+    /**
+     * @brief Render all the frames of an animation into numbered files next to the given one,
+     * e.g. frames of "out.png" are written into "out_00.png", "out_01.png" and so on.
+     * The frames are rendered in parallel, unless they are a part of a batch
+     *
+     * @throws std::invalid_argument If the frames should be rendered in bands
+     * or into mapped files
+     * @throws std::runtime_error If any of the frames couldn't be rendered or encoded
+     * @param image_builder Builder of the animation
+     * @param file Output file the numbered files are named after
+     * @param encoder Encoder of the format of the file
+     * @param args Arguments which determine the way the frames are rendered
+     * @param stats Statistics to be collected, nullptr if they aren't collected
+     */
+    void render_frames(const ImageBuilder &image_builder, const std::filesystem::path &file,
+                       const Encoder &encoder, const ApplicationArgs &args, Stats *stats) const;
+
+    /**
+     * @brief Render all the scenes of a batch on a pool of workers, sharing
+     * the registries. A failed scene doesn't stop the rest of the batch,
+     * errors and verbose messages of each scene are reported under its source
+     * once all the scenes are finished
+     *
+     * @throws std::invalid_argument If the manifest couldn't be parsed,
+     * or an option which doesn't support batch mode was entered
+     * @param args Arguments of the application
+     * @return size_t Number of scenes which failed
+     */
+    size_t run_batch(const ApplicationArgs &args) const;
+
+    /**
+     * @brief Watch the source for changes until the process is interrupted, rendering
+     * again only the regions of the image where the objects changed and encoding
+     * the image into the output files again
+     *
+     * @throws std::invalid_argument If the image should be rendered in bands
+     * @throws std::runtime_error If the source couldn't be watched
+     * @param args Arguments of the application
+     * @param image_builder Builder of the already rendered source
+     */
+    void watch(const ApplicationArgs &args, std::unique_ptr<ImageBuilder> image_builder) const;
+
 public:
     /**
      * @brief Construct a new Application object with given ObjectRegistry and EncoderRegistry
@@ -5,10 +5,12 @@
  */
 
 #include "application_args.hpp"
+#include "../utils.hpp"
 
 #include <getopt.h>
 
 using namespace std;
+using namespace utils;
 
 constexpr int opt_to_underlying(Opt opt) noexcept
 {
@@ -16,19 +18,45 @@ constexpr int opt_to_underlying(Opt opt) noexcept
 }
 
 const char *ApplicationArgs::help_msg =
-    "Usage: <option(s)> SOURCE\n"
+    "Usage: <option(s)> SOURCE...\n"
+    "Several SOURCEs are rendered in batch mode, each of them into files named after\n"
+    "the SOURCE, in formats given by extensions of the files entered with --render\n"
     "Options:\n"
     "\t-h, --help\tShow this help message\n"
-    "\t-r, --render=FILENAME\tRender image into [FILENAME]\n";
+    "\t-r, --render=FILENAME\tRender image into [FILENAME]\n"
+    "\t-b, --band-height=ROWS\tRender and encode the image [ROWS] rows at a time\n"
+    "\t-m, --mmap\tRender straight into the memory-mapped output file (BMP and PPM)\n"
+    "\t-a, --antialias\tRender the objects with smooth, anti-aliased edges\n"
+    "\t-x, --ssaa=FACTOR\tRender [FACTOR]x[FACTOR] samples per pixel (2 or 4)\n"
+    "\t\tand average them while encoding\n"
+    "\t-s, --stats[=FILE]\tPrint timing of each phase, object and pixel counts,\n"
+    "\t\tand peak memory usage, or write them into [FILE] as JSON\n"
+    "\t-t, --trace=FILE\tRecord spans of parsing, rendering and encoding into [FILE]\n"
+    "\t\tin the Chrome trace event format (chrome://tracing, Perfetto)\n"
+    "\t-p, --profile-objects[=COUNT]\tPrint [COUNT] (10 by default) source lines\n"
+    "\t\tand group definitions which took the longest to render\n"
+    "\t-B, --batch=MANIFEST\tRender all scenes listed in [MANIFEST], each line of\n"
+    "\t\twhich is a SOURCE followed by the files it should be rendered into\n"
+    "\t-j, --jobs=N\tRender [N] scenes at once in batch and server mode\n"
+    "\t\t(all CPUs by default)\n"
+    "\t-S, --serve=SOCKET\tRun as a server rendering scenes received over the Unix\n"
+    "\t\tdomain [SOCKET], no SOURCE is needed\n"
+    "\t-q, --queue=N\tMaximum number of connections waiting for the server (64)\n"
+    "\t-P, --max-pixels=N\tMaximum number of pixels of a canvas rendered by the server\n"
+    "\t\t(64000000), larger scenes are refused with an error\n"
+    "\t-w, --watch\tRender the SOURCE again whenever it changes, only the regions\n"
+    "\t\twhere the objects changed are rendered again\n";
 
 ApplicationArgs::ApplicationArgs(int argc, char *argv[])
 {
     parse_opts(argc, argv);
 
+    sources.assign(argv + optind, argv + argc);
+
     if (argc <= 1)
         options.push_back({Opt::Help, ""});
-    else if (optind != argc)
-        image_config = argv[argc - 1];
+    else if (!sources.empty())
+        image_config = sources.front();
 }
 
 void ApplicationArgs::parse_opts(int argc, char *argv[])
@@ -36,11 +64,24 @@ void ApplicationArgs::parse_opts(int argc, char *argv[])
     const option opts[] = {
         {"help", no_argument, nullptr, opt_to_underlying(Opt::Help)},
         {"render", required_argument, nullptr, opt_to_underlying(Opt::Render)},
+        {"band-height", required_argument, nullptr, opt_to_underlying(Opt::BandHeight)},
+        {"mmap", no_argument, nullptr, opt_to_underlying(Opt::Mmap)},
+        {"antialias", no_argument, nullptr, opt_to_underlying(Opt::Antialias)},
+        {"ssaa", required_argument, nullptr, opt_to_underlying(Opt::Supersampling)},
+        {"stats", optional_argument, nullptr, opt_to_underlying(Opt::Stats)},
+        {"trace", required_argument, nullptr, opt_to_underlying(Opt::Trace)},
+        {"profile-objects", optional_argument, nullptr, opt_to_underlying(Opt::ProfileObjects)},
+        {"batch", required_argument, nullptr, opt_to_underlying(Opt::Batch)},
+        {"jobs", required_argument, nullptr, opt_to_underlying(Opt::Jobs)},
+        {"serve", required_argument, nullptr, opt_to_underlying(Opt::Serve)},
+        {"queue", required_argument, nullptr, opt_to_underlying(Opt::Queue)},
+        {"max-pixels", required_argument, nullptr, opt_to_underlying(Opt::MaxPixels)},
+        {"watch", no_argument, nullptr, opt_to_underlying(Opt::Watch)},
         {nullptr, no_argument, nullptr, 0}};
 
     while (true)
     {
-        const int opt = getopt_long(argc, argv, "hr:", opts, 0);
+        const int opt = getopt_long(argc, argv, "hr:b:max:s::t:p::B:j:S:q:P:w", opts, 0);
 
         if (opt == -1)
             break;
@@ -52,13 +93,53 @@ void ApplicationArgs::parse_opts(int argc, char *argv[])
             break;
         case opt_to_underlying(Opt::Render):
             options.push_back({Opt::Render, optarg});
+            break;
+        case opt_to_underlying(Opt::BandHeight):
+            band_height = extract_int_arg(string("band-height=") + optarg, "band-height", 1);
+            break;
+        case opt_to_underlying(Opt::Mmap):
+            is_mapped = true;
+            break;
+        case opt_to_underlying(Opt::Antialias):
+            is_antialiased = true;
+            break;
+        case opt_to_underlying(Opt::Supersampling):
+            supersampling = extract_int_arg(string("ssaa=") + optarg, "ssaa", 1);
+            break;
+        case opt_to_underlying(Opt::Stats):
+            stats_file = optarg == nullptr ? "" : optarg;
+            break;
+        case opt_to_underlying(Opt::Trace):
+            trace_file = optarg;
+            break;
+        case opt_to_underlying(Opt::ProfileObjects):
+            profile_count = optarg == nullptr
+                                ? 10
+                                : extract_int_arg(string("profile-objects=") + optarg,
+                                                  "profile-objects", 1);
+            break;
+        case opt_to_underlying(Opt::Batch):
+            manifest = optarg;
+            break;
+        case opt_to_underlying(Opt::Jobs):
+            jobs = extract_int_arg(string("jobs=") + optarg, "jobs", 1);
+            break;
+        case opt_to_underlying(Opt::Serve):
+            socket_path = optarg;
+            break;
+        case opt_to_underlying(Opt::Queue):
+            queue_capacity = extract_int_arg(string("queue=") + optarg, "queue");
+            break;
+        case opt_to_underlying(Opt::MaxPixels):
+            max_pixels = extract_int_arg(string("max-pixels=") + optarg, "max-pixels", 1);
+            break;
+        case opt_to_underlying(Opt::Watch):
+            is_watched = true;
+            break;
         default:
             break;
         }
     }
-
-    if (optind != (argc - 1) && optind < argc)
-        throw invalid_argument("invalid argument entered: " + string(argv[optind]));
 }
 
 ostream &ApplicationArgs::print_help(ostream &os)
@@ -77,3 +158,78 @@ const string &ApplicationArgs::get_image_config() const
 {
     return image_config;
 }
+
+const vector<string> &ApplicationArgs::get_sources() const
+{
+    return sources;
+}
+
+const string &ApplicationArgs::get_manifest() const
+{
+    return manifest;
+}
+
+int ApplicationArgs::get_jobs() const
+{
+    return jobs;
+}
+
+bool ApplicationArgs::is_batch() const
+{
+    return !manifest.empty() || sources.size() > 1;
+}
+
+bool ApplicationArgs::get_is_antialiased() const
+{
+    return is_antialiased;
+}
+
+int ApplicationArgs::get_supersampling() const
+{
+    return supersampling;
+}
+
+int ApplicationArgs::get_band_height() const
+{
+    return band_height;
+}
+
+bool ApplicationArgs::get_is_mapped() const
+{
+    return is_mapped;
+}
+
+const optional<string> &ApplicationArgs::get_stats_file() const
+{
+    return stats_file;
+}
+
+const string &ApplicationArgs::get_trace_file() const
+{
+    return trace_file;
+}
+
+int ApplicationArgs::get_profile_count() const
+{
+    return profile_count;
+}
+
+const string &ApplicationArgs::get_socket_path() const
+{
+    return socket_path;
+}
+
+int ApplicationArgs::get_queue_capacity() const
+{
+    return queue_capacity;
+}
+
+int ApplicationArgs::get_max_pixels() const
+{
+    return max_pixels;
+}
+
+bool ApplicationArgs::get_is_watched() const
+{
+    return is_watched;
+}
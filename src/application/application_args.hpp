@@ -7,6 +7,7 @@
 #pragma once
 
 #include <iostream>
+#include <optional>
 #include <string>
 #include <vector>
 
@@ -17,6 +18,19 @@
 enum class Opt : int
 {
     Render = 'r',
+    BandHeight = 'b',
+    Mmap = 'm',
+    Stats = 's',
+    Trace = 't',
+    ProfileObjects = 'p',
+    Batch = 'B',
+    Jobs = 'j',
+    Serve = 'S',
+    Queue = 'q',
+    MaxPixels = 'P',
+    Watch = 'w',
+    Antialias = 'a',
+    Supersampling = 'x',
     Help = 'h'
 };
 
@@ -40,6 +54,34 @@ class ApplicationArgs
 
     std::vector<std::pair<Opt, std::string>> options;
     std::string image_config;
+    /** All the image configurations entered, there are several of them in batch mode */
+    std::vector<std::string> sources;
+    /** Manifest of scenes to be rendered in batch mode, empty if there is none */
+    std::string manifest;
+    /** Number of scenes rendered at once in batch and server mode, 0 to use all hardware threads */
+    int jobs = 0;
+    /** Socket the server listens on, empty if the application doesn't run as a server */
+    std::string socket_path;
+    /** Maximum number of connections waiting to be handled by the server */
+    int queue_capacity = 64;
+    /** Maximum number of pixels of the canvas of a scene rendered by the server */
+    int max_pixels = 64'000'000;
+    /** Render the source again whenever it changes */
+    bool is_watched = false;
+    /** Number of rows rendered at once when streaming, 0 renders the whole image */
+    int band_height = 0;
+    /** Render straight into the memory-mapped output file if the format allows it */
+    bool is_mapped = false;
+    /** Render the objects with anti-aliased edges */
+    bool is_antialiased = false;
+    /** Number of samples along each axis of a pixel */
+    int supersampling = 1;
+    /** File the statistics should be written into, empty to print them */
+    std::optional<std::string> stats_file;
+    /** File the trace should be written into, empty if it shouldn't be recorded */
+    std::string trace_file;
+    /** Number of the most expensive objects to be printed, 0 if they shouldn't be profiled */
+    int profile_count = 0;
 
     /** Parse the command line options and arguments */
     void parse_opts(int argc, char *argv[]);
@@ -62,4 +104,54 @@ public:
 
     /** Image config getter */
     const std::string &get_image_config() const;
+
+    /** Sources getter, i.e. all the image configurations entered */
+    const std::vector<std::string> &get_sources() const;
+
+    /** Manifest getter, empty if no manifest was entered */
+    const std::string &get_manifest() const;
+
+    /** Jobs getter, 0 if all hardware threads should be used */
+    int get_jobs() const;
+
+    /** Check whether multiple scenes should be rendered, i.e. a manifest or several sources were entered */
+    bool is_batch() const;
+
+    /** Socket path getter, empty if the application doesn't run as a server */
+    const std::string &get_socket_path() const;
+
+    /** Queue capacity getter */
+    int get_queue_capacity() const;
+
+    /** Getter of the maximum number of pixels of a scene rendered by the server */
+    int get_max_pixels() const;
+
+    /** Check whether the source should be rendered again whenever it changes */
+    bool get_is_watched() const;
+
+    /** Anti-aliasing getter */
+    bool get_is_antialiased() const;
+
+    /** Supersampling factor getter, 1 if the image isn't supersampled */
+    int get_supersampling() const;
+
+    /** Band height getter, 0 if the image shouldn't be rendered in bands */
+    int get_band_height() const;
+
+    /** Check whether the image should be rendered into the memory-mapped output file */
+    bool get_is_mapped() const;
+
+    /**
+     * @brief Get file the statistics should be written into as JSON
+     *
+     * @return const std::optional<std::string>& Empty if statistics shouldn't be
+     * collected, empty string if they should be printed to stderr
+     */
+    const std::optional<std::string> &get_stats_file() const;
+
+    /** Trace file getter, empty if the trace shouldn't be recorded */
+    const std::string &get_trace_file() const;
+
+    /** Get number of the most expensive objects to be printed, 0 if they shouldn't be profiled */
+    int get_profile_count() const;
 };
\ No newline at end of file
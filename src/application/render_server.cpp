@@ -0,0 +1,358 @@
+/**
+ * @file render_server.cpp
+ * @author Adam Berkeš <berkeada@fit.cvut.cz>
+ * @date 2026-10-19
+ */
+
+#include "render_server.hpp"
+#include "../image/image_builder.hpp"
+#include "../stats.hpp"
+#include "../trace.hpp"
+#include "../work_stealing_pool.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <iomanip>
+#include <iostream>
+#include <memory_resource>
+#include <poll.h>
+#include <sstream>
+#include <stdexcept>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+using namespace std;
+
+/** Maximum size of a scene accepted in a single request */
+constexpr size_t MAX_SCENE_SIZE = 64 << 20;
+/** Maximum length of the line preceding a request */
+constexpr size_t MAX_HEADER_LENGTH = 64;
+/** Time after which an idle connection is closed */
+constexpr int IDLE_TIMEOUT_S = 30;
+/** Time a client may take to send the rest of a request it started */
+constexpr int REQUEST_TIMEOUT_S = 5;
+/** Interval of checking whether the server should stop */
+constexpr int STOP_POLL_MS = 100;
+
+/**
+ * @brief Read a line terminated by '\n' from the socket, without the terminator
+ *
+ * @return true If the line was read, false if the connection was closed before
+ * anything was read, or if the line is too long
+ */
+static bool read_line(int fd, string &line)
+{
+    line.clear();
+    char c;
+
+    while (line.size() <= MAX_HEADER_LENGTH)
+    {
+        if (recv(fd, &c, 1, 0) != 1)
+            return false;
+        else if (c == '\n')
+            return true;
+
+        line += c;
+    }
+
+    return false;
+}
+
+/** Read exactly size bytes from the socket */
+static bool read_exactly(int fd, char *data, size_t size)
+{
+    while (size > 0)
+    {
+        ssize_t count = recv(fd, data, size, 0);
+
+        if (count <= 0)
+            return false;
+
+        data += count;
+        size -= count;
+    }
+
+    return true;
+}
+
+/** Write all the bytes into the socket */
+static bool write_all(int fd, const char *data, size_t size)
+{
+    while (size > 0)
+    {
+        ssize_t count = send(fd, data, size, MSG_NOSIGNAL);
+
+        if (count <= 0)
+            return false;
+
+        data += count;
+        size -= count;
+    }
+
+    return true;
+}
+
+/** Send a response consisting of the header line and the body */
+static bool send_response(int fd, const string &header, const string &body)
+{
+    string line = header + '\n';
+
+    return write_all(fd, line.data(), line.size()) && write_all(fd, body.data(), body.size());
+}
+
+RenderServer::RenderServer(const ObjectRegistry &objects_, const EncoderRegistry &encoders_,
+                           const string &socket_path_, size_t concurrency_,
+                           size_t queue_capacity_, int band_height_, bool antialiased_,
+                           int supersampling_, size_t max_pixels_)
+    : objects(objects_), encoders(encoders_), socket_path(socket_path_),
+      concurrency(concurrency_), queue_capacity(queue_capacity_), band_height(band_height_),
+      antialiased(antialiased_), supersampling(supersampling_), max_pixels(max_pixels_)
+{
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+
+    if (concurrency == 0)
+        throw invalid_argument("concurrency of the server has to be a positive integer");
+    else if (socket_path.empty() || socket_path.size() >= sizeof(address.sun_path))
+        throw invalid_argument("invalid socket path: " + socket_path);
+
+    strcpy(address.sun_path, socket_path.c_str());
+
+    // Only a socket left behind by a previous server is replaced, never a regular file
+    struct stat status;
+    if (lstat(socket_path.c_str(), &status) == 0 && S_ISSOCK(status.st_mode))
+        unlink(socket_path.c_str());
+
+    listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listen_fd == -1)
+        throw runtime_error(string("failed to create socket: ") + strerror(errno));
+
+    if (bind(listen_fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) == -1 ||
+        listen(listen_fd, static_cast<int>(concurrency + queue_capacity)) == -1)
+    {
+        string error = strerror(errno);
+        close(listen_fd);
+        throw runtime_error("failed to listen on socket: " + socket_path + ": " + error);
+    }
+
+    if (pipe2(wake_fds, O_CLOEXEC | O_NONBLOCK) == -1)
+    {
+        string error = strerror(errno);
+        close(listen_fd);
+        unlink(socket_path.c_str());
+        throw runtime_error("failed to create pipe: " + error);
+    }
+}
+
+RenderServer::~RenderServer()
+{
+    close(listen_fd);
+    close(wake_fds[0]);
+    close(wake_fds[1]);
+    unlink(socket_path.c_str());
+}
+
+void RenderServer::run()
+{
+    using clock = chrono::steady_clock;
+    // Connections waiting for their next request, along with the time they became idle
+    vector<pair<int, clock::time_point>> idle;
+    {
+        WorkStealingPool pool(concurrency);
+        vector<pollfd> fds;
+
+        auto dispatch = [&](int fd, clock::time_point arrived_at)
+        {
+            if (connection_count.load() >= concurrency + queue_capacity)
+            {
+                send_response(fd, "ERROR 15", "server is busy\n");
+                close(fd);
+                return;
+            }
+
+            connection_count++;
+            pool.submit([this, fd, arrived_at]()
+                        {
+                            double queued = chrono::duration<double>(clock::now() - arrived_at).count();
+                            if (handle_request(fd, queued) && !is_stopping.load())
+                                return_connection(fd);
+                            else
+                                close(fd);
+                            connection_count--; });
+        };
+
+        while (!is_stopping.load())
+        {
+            fds.assign({{listen_fd, POLLIN, 0}, {wake_fds[0], POLLIN, 0}});
+            for (const auto &[fd, _] : idle)
+                fds.push_back({fd, POLLIN, 0});
+
+            if (poll(fds.data(), fds.size(), STOP_POLL_MS) < 0)
+                continue;
+
+            clock::time_point now = clock::now();
+            vector<pair<int, clock::time_point>> still_idle;
+
+            for (size_t i = 0; i < idle.size(); i++)
+                if (fds[i + 2].revents != 0)
+                    dispatch(idle[i].first, now);
+                else if (now - idle[i].second >= chrono::seconds(IDLE_TIMEOUT_S))
+                    close(idle[i].first);
+                else
+                    still_idle.push_back(idle[i]);
+            idle.swap(still_idle);
+
+            if (fds[1].revents & POLLIN)
+            {
+                char drained[64];
+                while (read(wake_fds[0], drained, sizeof(drained)) > 0)
+                    ;
+
+                lock_guard<mutex> lock(returned_mutex);
+                for (int fd : returned)
+                    idle.push_back({fd, now});
+                returned.clear();
+            }
+
+            if (fds[0].revents & POLLIN)
+            {
+                int fd = accept(listen_fd, nullptr, nullptr);
+                if (fd == -1)
+                    continue;
+
+                timeval timeout{REQUEST_TIMEOUT_S, 0};
+                setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+                dispatch(fd, now);
+            }
+        }
+    }
+
+    // The pool has finished all the requests, so no connection is returned anymore
+    for (const auto &[fd, _] : idle)
+        close(fd);
+    for (int fd : returned)
+        close(fd);
+    returned.clear();
+}
+
+void RenderServer::return_connection(int fd)
+{
+    {
+        lock_guard<mutex> lock(returned_mutex);
+        returned.push_back(fd);
+    }
+
+    // A full pipe already wakes the accepting thread up
+    char wake = 0;
+    if (write(wake_fds[1], &wake, 1) == -1 && errno != EAGAIN)
+        cerr << "failed to wake up the server: " << strerror(errno) << endl;
+}
+
+void RenderServer::stop()
+{
+    is_stopping.store(true);
+}
+
+size_t RenderServer::get_request_count() const
+{
+    return request_count.load();
+}
+
+string RenderServer::render(const string &format, const string &scene,
+                            RequestTiming &timing) const
+{
+    // Memory of the objects is reused by the following requests of the same worker
+    thread_local pmr::unsynchronized_pool_resource scratch;
+
+    const Encoder &encoder = encoders.get(format, nullptr);
+    istringstream is(scene);
+    ostringstream out;
+
+    Stopwatch parse_stopwatch;
+    // The canvas is checked before any of the scene is parsed or allocated
+    istringstream config_stream(scene);
+    const auto &[width, height, _, frames] = ImageBuilder::parse_image_config(config_stream,
+                                                                              "request");
+    if (static_cast<size_t>(width) * height > max_pixels)
+        throw invalid_argument("canvas of " + to_string(width) + 'x' + to_string(height) +
+                               " pixels exceeds the limit of " + to_string(max_pixels) +
+                               " pixels");
+
+    // The error message is sent to the client only, the server's stderr stays clean
+    ImageBuilder image_builder(objects, is, nullptr, &scratch, nullptr);
+    image_builder.set_antialiased(antialiased);
+    image_builder.set_supersampling(supersampling);
+    timing.parse = parse_stopwatch.elapsed().wall;
+
+    // Streamed rendering encodes each band right away, so the encoding can't be told apart
+    Stopwatch render_stopwatch;
+    if (band_height > 0)
+    {
+        image_builder.render_streamed(encoder, out, band_height);
+        timing.render = render_stopwatch.elapsed().wall;
+    }
+    else
+    {
+        image_builder.render();
+        timing.render = render_stopwatch.elapsed().wall;
+
+        Stopwatch encode_stopwatch;
+        encoder.encode(out, image_builder.get_image());
+        timing.encode = encode_stopwatch.elapsed().wall;
+    }
+
+    return out.str();
+}
+
+bool RenderServer::handle_request(int fd, double queued)
+{
+    string header;
+    if (!read_line(fd, header))
+        return false;
+
+    istringstream header_stream(header);
+    string format, scene;
+    size_t size = 0;
+
+    if (!(header_stream >> format >> size) || size > MAX_SCENE_SIZE)
+    {
+        send_response(fd, "ERROR 16", "invalid request\n");
+        return false;
+    }
+
+    scene.resize(size);
+    if (!read_exactly(fd, scene.data(), size))
+        return false;
+
+    size_t id = ++request_count;
+    trace::Span span("request", [&]()
+                     { return "request " + to_string(id); });
+    RequestTiming timing;
+    string response, body;
+
+    try
+    {
+        body = render(format, scene, timing);
+        response = "OK " + to_string(body.size()) + ' ' +
+                   to_string(static_cast<long>(timing.parse * 1e6)) + ' ' +
+                   to_string(static_cast<long>(timing.render * 1e6)) + ' ' +
+                   to_string(static_cast<long>(timing.encode * 1e6));
+    }
+    catch (const exception &e)
+    {
+        body = string(e.what()) + '\n';
+        response = "ERROR " + to_string(body.size());
+    }
+
+    ostringstream log;
+    log << fixed << setprecision(3) << "request " << id << ": " << format << ' '
+        << response.substr(0, response.find(' ')) << ", " << body.size() << " B, queued "
+        << queued * 1e3 << " ms, parse " << timing.parse * 1e3 << " ms, render "
+        << timing.render * 1e3 << " ms, encode " << timing.encode * 1e3 << " ms\n";
+    cerr << log.str() << flush;
+
+    return send_response(fd, response, body);
+}
@@ -0,0 +1,134 @@
+/**
+ * @file render_server.hpp
+ * @author Adam Berkeš <berkeada@fit.cvut.cz>
+ * @date 2026-10-19
+ */
+
+#pragma once
+
+#include "../encoder/encoder_registry.hpp"
+#include "../object/object_registry.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Server rendering scenes received over a Unix domain socket, which keeps
+ * the registries, worker threads and their memory warm between the requests.
+ *
+ * Each connection may carry any number of requests, a request is a line
+ * "FORMAT LENGTH" followed by LENGTH bytes of the image configuration.
+ * The response is a line "OK LENGTH PARSE_US RENDER_US ENCODE_US" followed by
+ * LENGTH bytes of the encoded image, or "ERROR LENGTH" followed by LENGTH bytes
+ * of the error message. Connections which would exceed the queue are refused
+ * right away with an error, and so are scenes whose canvas exceeds the pixel limit.
+ *
+ * Each request is a separate task of the workers, connections waiting for their
+ * next request are watched by the accepting thread until they time out, so that
+ * idle clients don't keep the workers from the other requests
+ */
+class RenderServer
+{
+    /** Wall time spent in the phases of a single request in seconds */
+    struct RequestTiming
+    {
+        double parse = 0, render = 0, encode = 0;
+    };
+
+    const ObjectRegistry &objects;
+    const EncoderRegistry &encoders;
+    std::string socket_path;
+    /** Maximum number of connections handled at once */
+    size_t concurrency;
+    /** Maximum number of connections waiting to be handled */
+    size_t queue_capacity;
+    /** Number of rows rendered at once, 0 renders the whole image */
+    int band_height;
+    /** Whether the scenes are rendered with anti-aliased edges */
+    bool antialiased;
+    /** Number of samples along each axis of a pixel */
+    int supersampling;
+    /** Maximum number of pixels of the canvas of a scene */
+    size_t max_pixels;
+    int listen_fd = -1;
+    /** Pipe waking up the accepting thread once a worker returns a connection */
+    int wake_fds[2] = {-1, -1};
+    /** Number of connections whose request is either being handled or waiting in the queue */
+    std::atomic<size_t> connection_count = 0;
+    std::atomic<size_t> request_count = 0;
+    std::atomic<bool> is_stopping = false;
+    /** Connections whose request was handled and which wait for the next one */
+    std::vector<int> returned;
+    std::mutex returned_mutex;
+
+    /**
+     * @brief Handle a single request of the connection
+     *
+     * @param fd Socket of the connection
+     * @param queued Time the request spent waiting for a worker in seconds
+     * @return true If the connection should be kept open for the next request
+     */
+    bool handle_request(int fd, double queued);
+
+    /** Hand the connection back to the accepting thread to wait for its next request */
+    void return_connection(int fd);
+
+    /**
+     * @brief Render a single scene
+     *
+     * @throws std::invalid_argument If the scene couldn't be parsed, its canvas
+     * exceeds the pixel limit or the format isn't supported
+     * @throws std::runtime_error If something went wrong while encoding
+     * @param format Format of the image
+     * @param scene Image configuration
+     * @param timing Time spent in each phase of the request
+     * @return std::string Encoded image
+     */
+    std::string render(const std::string &format, const std::string &scene,
+                       RequestTiming &timing) const;
+
+public:
+    /**
+     * @brief Construct a new Render Server object listening on given socket
+     *
+     * @throws std::invalid_argument If concurrency isn't positive, or the path is too long
+     * @throws std::runtime_error If the socket couldn't be created
+     * @param objects_ Supported objects, must outlive the server
+     * @param encoders_ Supported encoders, must outlive the server
+     * @param socket_path_ Path of the socket, an existing socket file is replaced
+     * @param concurrency_ Maximum number of connections handled at once
+     * @param queue_capacity_ Maximum number of connections waiting to be handled
+     * @param band_height_ Number of rows rendered at once, 0 renders the whole image
+     * @param antialiased_ Whether the scenes are rendered with anti-aliased edges
+     * @param supersampling_ Number of samples along each axis of a pixel
+     * @param max_pixels_ Maximum number of pixels of the canvas of a scene
+     */
+    RenderServer(const ObjectRegistry &objects_, const EncoderRegistry &encoders_,
+                 const std::string &socket_path_, size_t concurrency_,
+                 size_t queue_capacity_, int band_height_ = 0,
+                 bool antialiased_ = false, int supersampling_ = 1,
+                 size_t max_pixels_ = 64'000'000);
+
+    RenderServer(const RenderServer &) = delete;
+
+    RenderServer &operator=(const RenderServer &) = delete;
+
+    /** Close the socket and the wake-up pipe, and remove the socket file */
+    ~RenderServer();
+
+    /**
+     * @brief Accept connections until stop() is called, then finish the requests
+     * which were already received and close all the connections
+     */
+    void run();
+
+    /** Make run() return, it's safe to call from a signal handler */
+    void stop();
+
+    /** Get number of requests handled so far */
+    size_t get_request_count() const;
+};
@@ -5,21 +5,46 @@
  */
 
 #include "bmp_encoder.hpp"
-#include "../utils.hpp"
 
 #include <array>
-#include <fstream>
 
 using namespace std;
-using namespace utils;
 
-void BMPEncoder::encode_to_file(const filesystem::path &file, const Image &image) const
+BMPEncoder::BMPRowWriter::BMPRowWriter(ostream &out_, int width_)
+    : out(out_), data(width_ * sizeof(Pixel) + get_padding_size(width_), 0), width(width_) {}
+
+void BMPEncoder::BMPRowWriter::write_row(const Pixel *row)
+{
+    size_t data_index = 0;
+
+    // The padding at the end of the row stays zeroed
+    for (int x = 0; x < width; x++)
+    {
+        const Pixel &pixel = row[x];
+        data[data_index++] = pixel.b;
+        data[data_index++] = pixel.g;
+        data[data_index++] = pixel.r;
+    }
+
+    out.write(reinterpret_cast<const char *>(data.data()), data.size());
+}
+
+void BMPEncoder::BMPRowWriter::finish()
+{
+    out.flush();
+}
+
+int BMPEncoder::get_padding_size(int width)
+{
+    return (4 - (width * sizeof(Pixel)) % 4) % 4;
+}
+
+unique_ptr<Encoder::RowWriter> BMPEncoder::open(ostream &out, int width, int height) const
 {
-    fstream out = try_open_file(file, ios_base::binary | ios_base::out);
-    int width = image.get_width(), height = image.get_height();
     array<unsigned char, BMP_FILE_HEADER_SIZE> file_header;
     array<unsigned char, BMP_INFO_HEADER_SIZE> info_header;
-    long file_size = image.get_size() + BMP_FILE_HEADER_SIZE + BMP_INFO_HEADER_SIZE;
+    long file_size = (static_cast<long>(width) * sizeof(Pixel) + get_padding_size(width)) * height +
+                     BMP_FILE_HEADER_SIZE + BMP_INFO_HEADER_SIZE;
 
     std::copy(BMP_FILE_HEADER, BMP_FILE_HEADER + BMP_FILE_HEADER_SIZE, file_header.begin());
     std::copy(BMP_INFO_HEADER, BMP_INFO_HEADER + BMP_INFO_HEADER_SIZE, info_header.begin());
@@ -33,27 +58,26 @@ void BMPEncoder::encode_to_file(const filesystem::path &file, const Image &image
     for (size_t i = 0; i < 4; i++)
         info_header[i + 8] = static_cast<unsigned char>(height >> (i * 8));
 
-    // Write both headers into the output file
-    for (const unsigned char &file_header_byte : file_header)
-        out << file_header_byte;
-    for (const unsigned char &info_header_byte : info_header)
-        out << info_header_byte;
+    // Write both headers into the output stream
+    out.write(reinterpret_cast<const char *>(file_header.data()), file_header.size());
+    out.write(reinterpret_cast<const char *>(info_header.data()), info_header.size());
 
-    int padding_size = (4 - (width * sizeof(Pixel)) % 4) % 4;
+    return make_unique<BMPRowWriter>(out, width);
+}
 
-    // Write the image pixel by pixel
-    for (int y = height - 1; y >= 0; y--)
-    {
-        for (int x = 0; x < width; x++)
-        {
-            const Pixel &pixel = image.get_buffer()(x, y);
-            out << pixel.b << pixel.g << pixel.r;
-        }
+bool BMPEncoder::is_bottom_up() const
+{
+    return true;
+}
 
-        out.write(0, padding_size);
-    }
+optional<PixelLayout> BMPEncoder::get_raw_layout(int width) const
+{
+    return PixelLayout{true, true, width * sizeof(Pixel) + get_padding_size(width)};
+}
 
-    check_fstream(out, file.filename());
+string BMPEncoder::get_name() const
+{
+    return "bmp";
 }
 
 shared_ptr<Encoder> BMPEncoder::clone() const
@@ -8,6 +8,8 @@
 
 #include "encoder.hpp"
 
+#include <vector>
+
 /**
  * @brief Encoder for encoding images into the BMP (bitmap) image format.
  * <a href="https://en.wikipedia.org/wiki/BMP_file_format">Format reference</a>
@@ -25,17 +27,43 @@ class BMPEncoder : public Encoder
     static constexpr const unsigned char BMP_INFO_HEADER[BMP_INFO_HEADER_SIZE] =
         {BMP_INFO_HEADER_SIZE, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, sizeof(Pixel) * 8};
 
+    /** Writer converting rows into BGR and padding them to a multiple of 4 bytes */
+    class BMPRowWriter : public RowWriter
+    {
+        std::ostream &out;
+        std::vector<unsigned char> data;
+        int width;
+
+    public:
+        BMPRowWriter(std::ostream &out_, int width_);
+
+        void write_row(const Pixel *row) override;
+
+        void finish() override;
+    };
+
+    /** Get number of bytes padding each row of the image */
+    static int get_padding_size(int width);
+
 public:
     /**
-     * @brief Encode image into BMP format, dynamically creating
-     * neccessary headers and offsetting the image data
+     * @brief Start encoding image into BMP format, dynamically creating
+     * neccessary headers, the rows are then expected starting with the bottom one
      *
-     * @throws std::invalid_argument If the file couldn't be created or opened for writing
-     * @throws std::runtime_exception If something went wrong with the file while writing into it
-     * @param file File into which the image should be saved
-     * @param image Image to be saved
+     * @param out Output stream
+     * @param width Width of the image
+     * @param height Height of the image
+     * @return std::unique_ptr<RowWriter>
      */
-    void encode_to_file(const std::filesystem::path &file, const Image &image) const override;
+    std::unique_ptr<RowWriter> open(std::ostream &out, int width, int height) const override;
+
+    /** BMP stores the rows starting with the bottom one */
+    bool is_bottom_up() const override;
+
+    /** BMP stores raw BGR pixels in rows starting with the bottom one padded to 4 bytes */
+    std::optional<PixelLayout> get_raw_layout(int width) const override;
+
+    std::string get_name() const override;
 
     std::shared_ptr<Encoder> clone() const override;
 };
@@ -5,5 +5,150 @@
  */
 
 #include "encoder.hpp"
+#include "../trace.hpp"
+#include "../utils.hpp"
+
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+using namespace std;
+using namespace utils;
+
+Encoder::RowWriter::~RowWriter() = default;
+
+void Encoder::RowWriter::write_translucent_row(const Pixel *row, const unsigned char *)
+{
+    write_row(row);
+}
 
 Encoder::~Encoder() = default;
+
+bool Encoder::is_bottom_up() const
+{
+    return false;
+}
+
+unique_ptr<Encoder::RowWriter> Encoder::open_translucent(ostream &out, int width,
+                                                        int height) const
+{
+    return open(out, width, height);
+}
+
+unique_ptr<Encoder::RowWriter> Encoder::open_raw(ostream &out, int width, int height) const
+{
+    return open(out, width, height);
+}
+
+optional<PixelLayout> Encoder::get_raw_layout(int) const
+{
+    return nullopt;
+}
+
+optional<Image> Encoder::create_mapped_image(const filesystem::path &file, int width,
+                                             int height, const Pixel &bg_color) const
+{
+    optional<PixelLayout> layout = get_raw_layout(width);
+
+    if (!layout || width < 0 || height < 0)
+        return nullopt;
+
+    // The header doesn't depend on the pixels, so it can be written right away
+    ostringstream header;
+    open_raw(header, width, height);
+    string header_bytes = header.str();
+
+    auto mapping = make_shared<MappedFile>(file, header_bytes.size() + layout->stride * height);
+    memcpy(mapping->get_data(), header_bytes.data(), header_bytes.size());
+
+    return Image(width, height, bg_color, std::move(mapping), header_bytes.size(), *layout);
+}
+
+void Encoder::write_rows(RowWriter &writer, const Image &image, int row_count) const
+{
+    const auto &buffer = image.get_buffer();
+    bool is_supersampled = image.get_supersampling() > 1;
+    // Supersampled rows are averaged into a single row right before they are written,
+    // and rows stored in a different channel order have to be converted first
+    vector<Pixel> converted(buffer.get_layout().bgr || is_supersampled ? image.get_output_width()
+                                                                        : 0);
+    vector<unsigned char> alpha(is_supersampled && buffer.has_alpha() ? converted.size() : 0);
+
+    auto write_row = [&](int y)
+    {
+        if (is_supersampled)
+        {
+            image.resolve_row(y, converted.data(), alpha.data());
+            if (buffer.has_alpha())
+                writer.write_translucent_row(converted.data(), alpha.data());
+            else
+                writer.write_row(converted.data());
+        }
+        else if (buffer.has_alpha())
+            writer.write_translucent_row(buffer.row(y), buffer.alpha_row(y));
+        else if (converted.empty())
+            writer.write_row(buffer.row(y));
+        else
+        {
+            buffer.copy_row(y, converted.data());
+            writer.write_row(converted.data());
+        }
+    };
+
+    if (is_bottom_up())
+        for (int y = row_count - 1; y >= 0; y--)
+            write_row(y);
+    else
+        for (int y = 0; y < row_count; y++)
+            write_row(y);
+}
+
+void Encoder::encode(ostream &out, const Image &image) const
+{
+    int width = image.get_output_width(), height = image.get_output_height();
+    unique_ptr<RowWriter> writer;
+    {
+        trace::Span span("encode", "open");
+        writer = image.get_buffer().has_alpha() ? open_translucent(out, width, height)
+                                                : open(out, width, height);
+    }
+
+    {
+        trace::Span span("encode", "rows");
+        write_rows(*writer, image, height);
+    }
+
+    trace::Span span("encode", "finish");
+    writer->finish();
+}
+
+void Encoder::encode_to_file(const filesystem::path &file, const Image &image) const
+{
+    trace::Span span("encode", [&]()
+                     { return "encode " + get_name() + ' ' + file.string(); });
+    const MappedFile *mapping = image.get_buffer().get_mapping();
+
+    if (mapping != nullptr && filesystem::exists(file) &&
+        filesystem::equivalent(mapping->get_path(), file))
+    {
+        // Opening the file would truncate the pixels which are being encoded
+        if (get_raw_layout(image.get_width()) != image.get_buffer().get_layout())
+            throw invalid_argument("image is mapped into the file in a different format: " +
+                                   file.string());
+
+        ostringstream header;
+        open_raw(header, image.get_width(), image.get_height());
+        memcpy(mapping->get_data(), header.str().data(), header.str().size());
+        mapping->sync();
+
+        return;
+    }
+
+    fstream out = try_open_file(file, ios_base::binary | ios_base::out);
+
+    encode(out, image);
+
+    check_fstream(out, file.filename());
+}
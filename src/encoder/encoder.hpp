@@ -10,6 +10,9 @@
 
 #include <filesystem>
 #include <memory>
+#include <optional>
+#include <ostream>
+#include <string>
 
 /**
  * @brief Base class for any kind of encoder which
@@ -18,16 +21,151 @@
 class Encoder
 {
 public:
+    /**
+     * @brief Incremental writer of a single encoded image, which accepts
+     * the image row by row, so that the whole image doesn't have to be
+     * kept in memory while encoding it
+     */
+    class RowWriter
+    {
+    public:
+        virtual ~RowWriter();
+
+        /**
+         * @brief Encode next row of the image, rows have to be
+         * passed in the order given by Encoder::is_bottom_up()
+         *
+         * @throws std::runtime_error If the row couldn't be encoded
+         * @param row Pointer to the first of width pixels of the row
+         */
+        virtual void write_row(const Pixel *row) = 0;
+
+        /**
+         * @brief Encode next row of a translucent image, which was opened
+         * by Encoder::open_translucent(). Formats which don't store the opacity
+         * encode the pixels as they are, i.e. composited over black
+         *
+         * @throws std::runtime_error If the row couldn't be encoded
+         * @param row Pointer to the first of width pixels of the row,
+         * premultiplied by their opacity
+         * @param alpha Pointer to the opacity of the first of width pixels of the row
+         */
+        virtual void write_translucent_row(const Pixel *row, const unsigned char *alpha);
+
+        /**
+         * @brief Finish encoding the image after all of its rows were written
+         *
+         * @throws std::runtime_error If the image couldn't be finished
+         */
+        virtual void finish() = 0;
+    };
+
     virtual ~Encoder();
 
+    /**
+     * @brief Start encoding an image of given dimensions into the output stream,
+     * the header is written right away, while the rows are written through the
+     * returned writer
+     *
+     * @throws std::runtime_error If the encoder couldn't be initialized
+     * @param out Output stream which must outlive the writer
+     * @param width Width of the image
+     * @param height Height of the image
+     * @return std::unique_ptr<RowWriter>
+     */
+    virtual std::unique_ptr<RowWriter> open(std::ostream &out, int width, int height) const = 0;
+
+    /**
+     * @brief Start encoding a translucent image the same way as open(), its rows have
+     * to be written by RowWriter::write_translucent_row(). Formats which don't store
+     * the opacity are opened the same way as opaque images
+     *
+     * @throws std::runtime_error If the encoder couldn't be initialized
+     * @param out Output stream which must outlive the writer
+     * @param width Width of the image
+     * @param height Height of the image
+     * @return std::unique_ptr<RowWriter>
+     */
+    virtual std::unique_ptr<RowWriter> open_translucent(std::ostream &out, int width,
+                                                        int height) const;
+
+    /** Check whether the format stores rows starting with the bottom one */
+    virtual bool is_bottom_up() const;
+
+    /**
+     * @brief Start encoding an image the same way as open(), but in the variant of
+     * the format whose pixels are laid out as given by get_raw_layout(). It's used
+     * for images mapped into their output file, formats with a single variant
+     * are opened the same way as by open()
+     *
+     * @throws std::runtime_error If the encoder couldn't be initialized
+     * @param out Output stream which must outlive the writer
+     * @param width Width of the image
+     * @param height Height of the image
+     * @return std::unique_ptr<RowWriter>
+     */
+    virtual std::unique_ptr<RowWriter> open_raw(std::ostream &out, int width, int height) const;
+
+    /**
+     * @brief Get layout of the pixel data if the format stores the pixels
+     * uncompressed right after the header written by open_raw()
+     *
+     * @param width Width of the image
+     * @return std::optional<PixelLayout> Empty if the format doesn't store raw pixels
+     */
+    virtual std::optional<PixelLayout> get_raw_layout(int width) const;
+
+    /**
+     * @brief Create an image whose pixels are stored directly in the memory-mapped
+     * output file laid out in this format, so that rendering writes straight
+     * into the file and encoding it with encode_to_file() needs no copy
+     *
+     * @throws std::invalid_argument If the file couldn't be created or opened for writing
+     * @throws std::runtime_error If the file couldn't be mapped
+     * @param file File into which the image is going to be encoded
+     * @param width Width of the image
+     * @param height Height of the image
+     * @param bg_color Background color of the image
+     * @return std::optional<Image> Empty if the format doesn't store raw pixels
+     */
+    std::optional<Image> create_mapped_image(const std::filesystem::path &file, int width,
+                                             int height, const Pixel &bg_color) const;
+
+    /**
+     * @brief Write the first rows of the image in the order given by is_bottom_up(),
+     * rows of supersampled images are averaged from their samples on the way
+     *
+     * @throws std::runtime_error If a row couldn't be encoded
+     * @param writer Writer of the image opened by this encoder
+     * @param image Image whose rows are written
+     * @param row_count Number of rows of the encoded image to be written
+     */
+    void write_rows(RowWriter &writer, const Image &image, int row_count) const;
+
+    /**
+     * @brief Encode the whole image into the output stream
+     *
+     * @throws std::runtime_error If something went wrong while encoding
+     * @param out Output stream
+     * @param image Image to be encoded
+     */
+    void encode(std::ostream &out, const Image &image) const;
+
     /**
      * @brief Main encoder method which encodes image into
-     * the desired format and save it into file
+     * the desired format and save it into file. Images created by
+     * create_mapped_image() for the same file only get their header
+     * written by open_raw() and their pixels synced into the file
      *
+     * @throws std::invalid_argument If the file couldn't be created or opened for writing
+     * @throws std::runtime_error If something went wrong with the file while writing into it
      * @param file File into which the encoded image should be save
      * @param image Image to be encoded
      */
-    virtual void encode_to_file(const std::filesystem::path &file, const Image &image) const = 0;
+    void encode_to_file(const std::filesystem::path &file, const Image &image) const;
+
+    /** Get name of the format, e.g. "png" */
+    virtual std::string get_name() const = 0;
 
     /**
      * @brief Clone the Encoder by creating a deep copy,
@@ -21,16 +21,16 @@ EncoderRegistry &EncoderRegistry::add(const string &key, const Encoder &encoder)
     return *this;
 }
 
-const Encoder &EncoderRegistry::get(const string &key, bool print_err) const
+const Encoder &EncoderRegistry::get(const string &key, ostream *err_out) const
 {
     if (encoders.count(key) == 0)
     {
-        if (print_err)
+        if (err_out != nullptr)
         {
-            cerr << "supported formats are: " << endl;
+            *err_out << "supported formats are: " << endl;
 
             for (const auto &[fmt, _] : encoders)
-                cerr << fmt << endl;
+                *err_out << fmt << endl;
         }
 
         throw invalid_argument("unsupported format: " + key);
@@ -8,6 +8,7 @@
 
 #include "encoder.hpp"
 
+#include <iostream>
 #include <map>
 
 /**
@@ -45,9 +46,9 @@ public:
      * @throws std::invalid_argument If the encoder wasn't registred
      * with given key beforehand
      * @param key Name of the format
-     * @param print_err Indicator whether verbose error message should
-     * be printed to std::cerr
+     * @param err_out Stream the verbose error message is printed to,
+     * nullptr if it shouldn't be printed
      * @return const Encoder&
      */
-    const Encoder &get(const std::string &key, bool print_err = true) const;
+    const Encoder &get(const std::string &key, std::ostream *err_out = &std::cerr) const;
 };
@@ -6,75 +6,126 @@
 
 #include "png_encoder.hpp"
 
-#include <png.h>
+#include <algorithm>
+#include <stdexcept>
 
 using namespace std;
 
-void PNGEncoder::encode_to_file(const filesystem::path &file, const Image &image) const
+void PNGEncoder::PNGRowWriter::write_data(png_structp png_ptr, png_bytep bytes, png_size_t length)
 {
-    int width = image.get_width(), height = image.get_height();
+    ostream &out = *static_cast<ostream *>(png_get_io_ptr(png_ptr));
 
-    // Open file and create neccessary png structs while
-    // checking for failure and destroying objects if one occured
-    FILE *out = fopen(file.c_str(), "wb");
-    if (out == nullptr)
-        throw invalid_argument("error opening file: " + file.string());
+    if (!out.write(reinterpret_cast<const char *>(bytes), length))
+        png_error(png_ptr, "write error");
+}
 
-    png_structp png_ptr = png_create_write_struct(PNG_LIBPNG_VER_STRING, nullptr, nullptr, nullptr);
+void PNGEncoder::PNGRowWriter::flush_data(png_structp png_ptr)
+{
+    static_cast<ostream *>(png_get_io_ptr(png_ptr))->flush();
+}
+
+PNGEncoder::PNGRowWriter::PNGRowWriter(ostream &out_, int width_, int height, bool has_alpha_)
+    : out(out_), data((has_alpha_ ? 4 : 3) * static_cast<size_t>(width_)), width(width_),
+      has_alpha(has_alpha_)
+{
+    // Create neccessary png structs, the destructor takes
+    // care of destroying them if anything fails
+    png_ptr = png_create_write_struct(PNG_LIBPNG_VER_STRING, nullptr, nullptr, nullptr);
     if (png_ptr == nullptr)
-    {
-        fclose(out);
         throw runtime_error("error creating png write struct");
-    }
 
-    png_infop info_ptr = png_create_info_struct(png_ptr);
+    info_ptr = png_create_info_struct(png_ptr);
     if (info_ptr == nullptr)
-    {
-        fclose(out);
-        png_destroy_write_struct(&png_ptr, nullptr);
         throw runtime_error("error creating png info struct");
-    }
+
+    if (setjmp(png_jmpbuf(png_ptr)))
+        throw runtime_error("error writing png header");
 
     // Initialize I/O and write headers
-    png_init_io(png_ptr, out);
+    png_set_write_fn(png_ptr, &out, write_data, flush_data);
     png_set_IHDR(png_ptr, info_ptr, width, height, 8,
-                 PNG_COLOR_TYPE_RGB, PNG_INTERLACE_NONE,
+                 has_alpha ? PNG_COLOR_TYPE_RGBA : PNG_COLOR_TYPE_RGB, PNG_INTERLACE_NONE,
                  PNG_COMPRESSION_TYPE_DEFAULT, PNG_FILTER_TYPE_DEFAULT);
     png_write_info(png_ptr, info_ptr);
+}
+
+PNGEncoder::PNGRowWriter::~PNGRowWriter()
+{
+    png_destroy_write_struct(&png_ptr, &info_ptr);
+}
 
-    // Write the png row by row, copying data from image buffer
-    // into temporary vector *row*
-    vector<unsigned char> row(sizeof(Pixel) * width);
-    size_t row_index = 0;
-    for (int y = 0; y < height; ++y)
+void PNGEncoder::PNGRowWriter::write_row(const Pixel *row)
+{
+    // Copy data from the row into temporary vector *data*
+    size_t data_index = 0;
+    for (int x = 0; x < width; x++)
     {
-        for (int x = 0; x < width; x++)
-        {
-            const Pixel &pixel = image.get_buffer()(x, y);
-            row[row_index++] = pixel.r;
-            row[row_index++] = pixel.g;
-            row[row_index++] = pixel.b;
-        }
+        const Pixel &pixel = row[x];
+        data[data_index++] = pixel.r;
+        data[data_index++] = pixel.g;
+        data[data_index++] = pixel.b;
+    }
+
+    // Check if any error occured
+    if (setjmp(png_jmpbuf(png_ptr)))
+        throw runtime_error("error writing png row");
+
+    png_write_row(png_ptr, data.data());
+}
 
-        png_bytep png_row = &row.front();
-        png_write_row(png_ptr, png_row);
+void PNGEncoder::PNGRowWriter::write_translucent_row(const Pixel *row, const unsigned char *alpha)
+{
+    if (!has_alpha)
+    {
+        write_row(row);
+        return;
+    }
 
-        // Check if any error occured
-        if (setjmp(png_jmpbuf(png_ptr)))
+    // PNG stores the channels which aren't premultiplied
+    size_t data_index = 0;
+    for (int x = 0; x < width; x++)
+    {
+        const Pixel &pixel = row[x];
+        unsigned a = alpha[x];
+        auto unpremultiply = [a](unsigned channel)
         {
-            png_write_end(png_ptr, info_ptr);
-            png_destroy_write_struct(&png_ptr, &info_ptr);
-            fclose(out);
-            throw runtime_error("error writing png: " + file.filename().string());
-        }
+            return a == 0 ? 0 : min(255u, (channel * 255 + a / 2) / a);
+        };
 
-        row_index = 0;
+        data[data_index++] = unpremultiply(pixel.r);
+        data[data_index++] = unpremultiply(pixel.g);
+        data[data_index++] = unpremultiply(pixel.b);
+        data[data_index++] = a;
     }
 
-    // Final cleanup
+    if (setjmp(png_jmpbuf(png_ptr)))
+        throw runtime_error("error writing png row");
+
+    png_write_row(png_ptr, data.data());
+}
+
+void PNGEncoder::PNGRowWriter::finish()
+{
+    if (setjmp(png_jmpbuf(png_ptr)))
+        throw runtime_error("error finishing png");
+
     png_write_end(png_ptr, info_ptr);
-    png_destroy_write_struct(&png_ptr, &info_ptr);
-    fclose(out);
+}
+
+unique_ptr<Encoder::RowWriter> PNGEncoder::open(ostream &out, int width, int height) const
+{
+    return make_unique<PNGRowWriter>(out, width, height);
+}
+
+unique_ptr<Encoder::RowWriter> PNGEncoder::open_translucent(ostream &out, int width,
+                                                           int height) const
+{
+    return make_unique<PNGRowWriter>(out, width, height, true);
+}
+
+string PNGEncoder::get_name() const
+{
+    return "png";
 }
 
 shared_ptr<Encoder> PNGEncoder::clone() const
@@ -8,26 +8,80 @@
 
 #include "encoder.hpp"
 
+#include <png.h>
+#include <vector>
+
 /**
  * @brief Encoder for encoding images into the
  * PNG (Portable Network Graphics) image format, using libpng.
- * So far, this encoder can only handle 3 color channels,
- * meaning that it doesn't support the alpha channel and thus
- * doesn't supoprt transparency and opacity.
+ * Translucent images are encoded with the alpha channel.
  * <a href="https://www.w3.org/TR/2003/REC-PNG-20031110/">Format reference</a>
  */
 class PNGEncoder : public Encoder
 {
+    /**
+     * @brief Writer passing rows to libpng, which compresses them
+     * and writes the result into the output stream
+     */
+    class PNGRowWriter : public RowWriter
+    {
+        std::ostream &out;
+        png_structp png_ptr = nullptr;
+        png_infop info_ptr = nullptr;
+        std::vector<unsigned char> data;
+        int width;
+        /** Whether the rows carry the alpha channel */
+        bool has_alpha;
+
+        /** Callback used by libpng to write compressed data into the stream */
+        static void write_data(png_structp png_ptr, png_bytep bytes, png_size_t length);
+
+        /** Callback used by libpng to flush the stream */
+        static void flush_data(png_structp png_ptr);
+
+    public:
+        /**
+         * @brief Construct a new PNGRowWriter object and write the PNG header
+         *
+         * @throws std::runtime_error If libpng couldn't be initialized
+         * @param out_ Output stream
+         * @param width_ Width of the image
+         * @param height Height of the image
+         * @param has_alpha_ Whether the image is encoded with the alpha channel
+         */
+        PNGRowWriter(std::ostream &out_, int width_, int height, bool has_alpha_ = false);
+
+        PNGRowWriter(const PNGRowWriter &) = delete;
+
+        PNGRowWriter &operator=(const PNGRowWriter &) = delete;
+
+        ~PNGRowWriter() override;
+
+        void write_row(const Pixel *row) override;
+
+        /** Write the row with the alpha channel, reverting the premultiplication */
+        void write_translucent_row(const Pixel *row, const unsigned char *alpha) override;
+
+        void finish() override;
+    };
+
 public:
     /**
-     * @brief Encode image into PNG format using libpng
+     * @brief Start encoding image into PNG format using libpng
      *
-     * @throws std::invalid_argument If the file couldn't be created or opened for writing
-     * @throws std::runtime_exception If something went wrong with the file while writing into it
-     * @param file File into which the image should be saved
-     * @param image Image to be saved
+     * @throws std::runtime_error If libpng couldn't be initialized
+     * @param out Output stream
+     * @param width Width of the image
+     * @param height Height of the image
+     * @return std::unique_ptr<RowWriter>
      */
-    void encode_to_file(const std::filesystem::path &file, const Image &image) const override;
+    std::unique_ptr<RowWriter> open(std::ostream &out, int width, int height) const override;
+
+    /** Start encoding image into PNG format with the alpha channel */
+    std::unique_ptr<RowWriter> open_translucent(std::ostream &out, int width,
+                                                int height) const override;
+
+    std::string get_name() const override;
 
     std::shared_ptr<Encoder> clone() const override;
 };
@@ -5,33 +5,67 @@
  */
 
 #include "ppm_encoder.hpp"
-#include "../utils.hpp"
 
-#include <fstream>
-#include <vector>
+#include <string>
 
 using namespace std;
-using namespace utils;
 
-void PPMEncoder::encode_to_file(const filesystem::path &file, const Image &image) const
+void PPMEncoder::PPMRowWriter::write_row(const Pixel *row)
 {
-    fstream out = try_open_file(file, ios_base::out);
-    int width = image.get_width(), height = image.get_height();
+    string text;
 
+    // Format the whole row first, so that the stream is written only once per row
+    for (int x = 0; x < width; x++)
+    {
+        const Pixel &pixel = row[x];
+        text += to_string(pixel.r) + ' ' + to_string(pixel.g) + ' ' + to_string(pixel.b) + '\n';
+    }
+
+    out.write(text.data(), text.size());
+}
+
+void PPMEncoder::PPMRowWriter::finish()
+{
+    out.flush();
+}
+
+void PPMEncoder::PPMRawRowWriter::write_row(const Pixel *row)
+{
+    out.write(reinterpret_cast<const char *>(row), width * sizeof(Pixel));
+}
+
+void PPMEncoder::PPMRawRowWriter::finish()
+{
+    out.flush();
+}
+
+unique_ptr<Encoder::RowWriter> PPMEncoder::open(ostream &out, int width, int height) const
+{
     // Output PPM header
-    out << "P3" << endl;
-    out << width << ' ' << height << endl;
-    out << 255 << endl;
-
-    // Create the image pixel by pixel
-    for (int y = 0; y < height; y++)
-        for (int x = 0; x < width; x++)
-        {
-            const Pixel &pixel = image.get_buffer()(x, y);
-            out << +pixel.r << ' ' << +pixel.g << ' ' << +pixel.b << endl;
-        }
-
-    check_fstream(out, file.filename());
+    out << "P3" << '\n';
+    out << width << ' ' << height << '\n';
+    out << 255 << '\n';
+
+    return make_unique<PPMRowWriter>(out, width);
+}
+
+unique_ptr<Encoder::RowWriter> PPMEncoder::open_raw(ostream &out, int width, int height) const
+{
+    out << "P6" << '\n';
+    out << width << ' ' << height << '\n';
+    out << 255 << '\n';
+
+    return make_unique<PPMRawRowWriter>(out, width);
+}
+
+optional<PixelLayout> PPMEncoder::get_raw_layout(int width) const
+{
+    return PixelLayout::packed(width);
+}
+
+string PPMEncoder::get_name() const
+{
+    return "ppm";
 }
 
 shared_ptr<Encoder> PPMEncoder::clone() const
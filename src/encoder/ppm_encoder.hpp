@@ -10,21 +10,58 @@
 
 /**
  * @brief Encoder for encoding images into the Netpbm color image format.
+ * Images are encoded as text (P3), only images mapped into their output file
+ * are stored in the binary variant (P6).
  * <a href="https://netpbm.sourceforge.net/doc/ppm.html">Format reference</a>
  */
 class PPMEncoder : public Encoder
 {
+    /** Writer outputting each pixel of the row into the grid as text */
+    class PPMRowWriter : public RowWriter
+    {
+        std::ostream &out;
+        int width;
+
+    public:
+        PPMRowWriter(std::ostream &out_, int width_) : out(out_), width(width_){};
+
+        void write_row(const Pixel *row) override;
+
+        void finish() override;
+    };
+
+    /** Writer outputting the raw pixels of each row */
+    class PPMRawRowWriter : public RowWriter
+    {
+        std::ostream &out;
+        int width;
+
+    public:
+        PPMRawRowWriter(std::ostream &out_, int width_) : out(out_), width(width_){};
+
+        void write_row(const Pixel *row) override;
+
+        void finish() override;
+    };
+
 public:
     /**
-     * @brief Encode image into Netpbm format by simply outputting
-     * each pixel into the grid as text
+     * @brief Start encoding image into Netpbm format by outputting its header
      *
-     * @throws std::invalid_argument If the file couldn't be created or opened for writing
-     * @throws std::runtime_exception If something went wrong with the file while writing into it
-     * @param file File into which the image should be saved
-     * @param image Image to be saved
+     * @param out Output stream
+     * @param width Width of the image
+     * @param height Height of the image
+     * @return std::unique_ptr<RowWriter>
      */
-    void encode_to_file(const std::filesystem::path &file, const Image &image) const override;
+    std::unique_ptr<RowWriter> open(std::ostream &out, int width, int height) const override;
+
+    /** Start encoding image into the binary Netpbm format (P6) */
+    std::unique_ptr<RowWriter> open_raw(std::ostream &out, int width, int height) const override;
+
+    /** Binary PPM stores raw tightly packed RGB pixels starting with the top row */
+    std::optional<PixelLayout> get_raw_layout(int width) const override;
+
+    std::string get_name() const override;
 
     std::shared_ptr<Encoder> clone() const override;
 };
@@ -0,0 +1,59 @@
+/**
+ * @file clip_mask.cpp
+ * @author Adam Berkeš <berkeada@fit.cvut.cz>
+ * @date 2026-10-19
+ */
+
+#include "clip_mask.hpp"
+#include "image.hpp"
+
+#include <stdexcept>
+
+using namespace std;
+
+/** Opacity from which the pixels of the rendered mask belong to it */
+constexpr unsigned char MIN_MASK_OPACITY = 128;
+
+ClipMask ClipMask::from_alpha(const Image &image)
+{
+    ClipMask mask;
+    mask.append_alpha(image, image.get_height());
+
+    return mask;
+}
+
+void ClipMask::append_alpha(const Image &image, int rows)
+{
+    const auto &buffer = image.get_buffer();
+    const Coords &origin = buffer.get_origin();
+    int width = image.get_width(), mask_rows = row_starts.size() - 1;
+
+    if (!buffer.has_alpha())
+        throw invalid_argument("clip mask has to be rendered into an image with an alpha channel");
+    if (mask_rows > 0 && origin.y != top + mask_rows)
+        throw invalid_argument("strip of a clip mask has to follow its last row");
+
+    if (mask_rows == 0)
+        top = origin.y;
+    rows = min(rows, image.get_height());
+    row_starts.reserve(row_starts.size() + rows);
+
+    for (int y = 0; y < rows; y++)
+    {
+        const unsigned char *alpha = buffer.alpha_row(y);
+
+        for (int x = 0; x < width;)
+        {
+            for (; x < width && alpha[x] < MIN_MASK_OPACITY; x++)
+                ;
+            int begin = x;
+            for (; x < width && alpha[x] >= MIN_MASK_OPACITY; x++)
+                ;
+
+            if (begin < x)
+                spans.push_back({origin.x + begin, origin.x + x});
+        }
+
+        row_starts.push_back(spans.size());
+    }
+}
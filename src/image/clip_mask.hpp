@@ -0,0 +1,100 @@
+/**
+ * @file clip_mask.hpp
+ * @author Adam Berkeš <berkeada@fit.cvut.cz>
+ * @date 2026-10-19
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+class Image;
+
+/**
+ * @brief Mask limiting which pixels of an image may be drawn into, stored
+ * as a sorted list of disjoint spans for each row. Large masks thus take
+ * memory proportional to the number of their spans rather than their area,
+ * and clipping a span costs only as much as the spans of the mask it crosses
+ */
+class ClipMask
+{
+public:
+    /** Pixels from begin up to end (exclusive) of a row */
+    struct Span
+    {
+        int begin, end;
+    };
+
+private:
+    /** First row of the mask */
+    int top = 0;
+    /** Index of the first span of each row, followed by the number of all the spans */
+    std::vector<size_t> row_starts{0};
+    std::vector<Span> spans;
+
+public:
+    /** Construct an empty mask, which clips away all the pixels */
+    ClipMask() = default;
+
+    /**
+     * @brief Construct the mask of the pixels of the image which are at least
+     * half opaque, in the canvas coordinates the image is drawn with
+     *
+     * @throws std::invalid_argument If the image has no alpha channel
+     * @param image Image with an alpha channel the mask is rendered into
+     * @return ClipMask
+     */
+    static ClipMask from_alpha(const Image &image);
+
+    /**
+     * @brief Append the rows of the mask rendered into the image, which has to begin
+     * right below the last row of the mask, so that a mask may be rendered strip by strip
+     *
+     * @throws std::invalid_argument If the image has no alpha channel or doesn't follow the mask
+     * @param image Image with an alpha channel the strip of the mask is rendered into
+     * @param rows Number of the rows of the image belonging to the mask
+     */
+    void append_alpha(const Image &image, int rows);
+
+    /**
+     * @brief Call f(begin, end) for each part of the span of the row lying inside of the mask
+     *
+     * @param y Row of the span
+     * @param begin First pixel of the span
+     * @param end Pixel following the span
+     * @param f Function called in order from the left
+     */
+    template <typename F>
+    void for_each_span(int y, int begin, int end, F &&f) const
+    {
+        if (y < top || y >= top + static_cast<int>(row_starts.size()) - 1)
+            return;
+
+        const Span *first = spans.data() + row_starts[y - top],
+                   *last = spans.data() + row_starts[y - top + 1];
+        // Spans are sorted and disjoint, so the first one ending after the begin is the first one inside
+        first = std::upper_bound(first, last, begin, [](int x, const Span &span)
+                                 { return x < span.end; });
+
+        for (; first != last && first->begin < end; first++)
+            f(std::max(begin, first->begin), std::min(end, first->end));
+    }
+
+    /** Check whether the pixel lies inside of the mask */
+    bool contains(int x, int y) const
+    {
+        bool inside = false;
+        for_each_span(y, x, x + 1, [&](int, int)
+                      { inside = true; });
+
+        return inside;
+    }
+
+    /** Get number of the spans of all the rows */
+    size_t get_span_count() const
+    {
+        return spans.size();
+    }
+};
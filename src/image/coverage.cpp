@@ -0,0 +1,305 @@
+/**
+ * @file coverage.cpp
+ * @author Adam Berkeš <berkeada@fit.cvut.cz>
+ * @date 2026-10-19
+ */
+
+#include "coverage.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+using namespace std;
+
+/** Round down to an integer without calling into libm, which floor() does without SSE4.1 */
+static int floor_int(double value)
+{
+    int truncated = static_cast<int>(value);
+
+    return truncated - (truncated > value);
+}
+
+/** Round to the nearest integer, halves are rounded up */
+static int round_int(double value)
+{
+    return floor_int(value + 0.5);
+}
+
+/** Coverage of a whole pixel in the fixed point units of the cells */
+constexpr int FULL_COVERAGE = 1 << 16;
+
+/** Average number of cells in a row above which the cells are sorted by counting their columns */
+constexpr size_t MIN_CELLS_PER_ROW_TO_COUNT = 32;
+
+CoverageAccumulator::CoverageAccumulator(const Rect &clip_) : clip(clip_) {}
+
+CoverageAccumulator &CoverageAccumulator::get(const Rect &clip_)
+{
+    thread_local CoverageAccumulator accumulator(clip_);
+    accumulator.clip = clip_;
+
+    return accumulator;
+}
+
+void CoverageAccumulator::add_edge(const Point &a, const Point &b)
+{
+    if (a.y == b.y || clip.is_empty())
+        return;
+
+    // Edges are always walked downwards, the direction only changes the sign of their area
+    int sign = a.y < b.y ? 1 : -1;
+    double x0 = a.x, y0 = a.y, x1 = b.x, y1 = b.y;
+    if (y0 > y1)
+    {
+        swap(x0, x1);
+        swap(y0, y1);
+    }
+
+    double top = max(y0, static_cast<double>(clip.min.y)),
+           bottom = min(y1, static_cast<double>(clip.max.y));
+
+    if (top < bottom)
+        add_clipped_edge(x0, y0, (x1 - x0) / (y1 - y0), top, bottom, sign);
+}
+
+void CoverageAccumulator::add_clipped_edge(double x0, double y0, double dxdy, double top,
+                                           double bottom, int sign)
+{
+    // Parts of the edge left or right of the clip rectangle still change the coverage
+    // of the rows they go through, so they are moved onto its sides instead of dropped
+    double splits[4] = {top, bottom, bottom, bottom};
+    int split_count = 1;
+
+    if (dxdy != 0)
+        for (int side : {clip.min.x, clip.max.x})
+        {
+            double y = y0 + (side - x0) / dxdy;
+            if (top < y && y < bottom)
+                splits[split_count++] = y;
+        }
+
+    if (split_count == 3 && splits[1] > splits[2])
+        swap(splits[1], splits[2]);
+    splits[split_count] = bottom;
+
+    for (int i = 0; i < split_count; i++)
+        if (splits[i] < splits[i + 1])
+            add_row_clipped_edge(x0, y0, dxdy, splits[i], splits[i + 1], sign);
+}
+
+void CoverageAccumulator::add_row_clipped_edge(double x0, double y0, double dxdy, double top,
+                                               double bottom, int sign)
+{
+    double left = clip.min.x, right = clip.max.x;
+    int row = floor_int(top);
+
+    for (; top < bottom; row++)
+    {
+        double next_top = min(bottom, row + 1.0),
+               xa = clamp(x0 + (top - y0) * dxdy, left, right),
+               xb = clamp(x0 + (next_top - y0) * dxdy, left, right),
+               lo = min(xa, xb), hi = max(xa, xb);
+        int height = sign * round_int((next_top - top) * FULL_COVERAGE);
+
+        // Pixels right of the edge are covered by its height, the pixel it goes through
+        // only by the part right of it, which is given by the mean position of the edge
+        auto add_piece = [&](double from, double to, int piece_height)
+        {
+            int column = floor_int((from + to) / 2),
+                right_delta = round_int(piece_height * ((from + to) / 2 - column));
+
+            // Consecutive pieces of the edge often share a cell, which is then stored only once
+            if (!cells.empty() && cells.back().y == row && cells.back().x == column)
+                cells.back().delta += piece_height - right_delta;
+            else
+                cells.push_back({row, column, piece_height - right_delta});
+            if (right_delta != 0)
+                cells.push_back({row, column + 1, right_delta});
+        };
+
+        if (hi - lo < 1e-9 || floor_int(lo) == -floor_int(-hi) - 1)
+            add_piece(lo, hi, height);
+        else
+        {
+            // The heights of the pieces are rounded cumulatively, so that they add up to the height
+            int added = 0;
+            for (double x = lo; x < hi;)
+            {
+                double next = min(hi, floor_int(x) + 1.0);
+                int total = next < hi ? round_int(height * (next - lo) / (hi - lo)) : height;
+                add_piece(x, next, total - added);
+                added = total;
+                x = next;
+            }
+        }
+
+        top = next_top;
+    }
+}
+
+void CoverageAccumulator::move_to(const Point &point)
+{
+    close();
+    contour_start = contour_end = point;
+}
+
+void CoverageAccumulator::line_to(const Point &point)
+{
+    add_edge(contour_end, point);
+    contour_end = point;
+}
+
+void CoverageAccumulator::close()
+{
+    line_to(contour_start);
+}
+
+void CoverageAccumulator::add_polygon(const vector<Point> &vertices)
+{
+    for (size_t i = 0; i < vertices.size(); i++)
+        add_edge(vertices[i], vertices[(i + 1) % vertices.size()]);
+}
+
+void CoverageAccumulator::add_ellipse(const Point &center, double radius_x, double radius_y,
+                                      bool reversed, double rotation)
+{
+    double radius = max(abs(radius_x), abs(radius_y));
+    if (radius <= 0)
+        return;
+
+    // Each side of the polygon may deviate from the ellipse by at most the tolerance
+    double step = 2 * acos(max(-1.0, 1 - FLATTEN_TOLERANCE / radius));
+    int count = max(8, static_cast<int>(ceil(2 * M_PI / step)));
+    double angle = (reversed ? -2 : 2) * M_PI / count,
+           cos_rotation = cos(rotation), sin_rotation = sin(rotation);
+    auto vertex = [&](int i)
+    {
+        double x = radius_x * cos(i * angle), y = radius_y * sin(i * angle);
+        return Point(center.x + x * cos_rotation - y * sin_rotation,
+                     center.y + x * sin_rotation + y * cos_rotation);
+    };
+
+    move_to(vertex(0));
+    for (int i = 1; i < count; i++)
+        line_to(vertex(i));
+    close();
+}
+
+void CoverageAccumulator::add_segment(const Point &a, const Point &b, double width)
+{
+    double length = hypot(b.x - a.x, b.y - a.y);
+    if (length == 0)
+        return;
+
+    Point normal(-(b.y - a.y) * width / 2 / length, (b.x - a.x) * width / 2 / length);
+
+    add_polygon({a + normal, b + normal, b - normal, a - normal});
+}
+
+void CoverageAccumulator::fill(Image &image, const Color &color, bool antialiased)
+{
+    if (cells.empty())
+        return;
+
+    // Stable sort of the cells by counting the values of given key, in linear time
+    auto counting_sort = [this](const vector<Cell> &from, vector<Cell> &to, int Cell::*key)
+    {
+        auto [lowest, highest] = minmax_element(from.begin(), from.end(),
+                                                [key](const Cell &a, const Cell &b)
+                                                { return a.*key < b.*key; });
+        int first = (*lowest).*key;
+        bucket_starts.assign((*highest).*key - first + 1, 0);
+        for (const Cell &cell : from)
+            bucket_starts[cell.*key - first]++;
+
+        size_t start = 0;
+        for (size_t &bucket : bucket_starts)
+            start += exchange(bucket, start);
+
+        to.resize(from.size());
+        for (const Cell &cell : from)
+            to[bucket_starts[cell.*key - first]++] = cell;
+    };
+
+    // The cells are bucketed by their rows, then the few cells of each row are sorted
+    // by their columns. Long paths cross each row many times, so their cells are rather
+    // sorted by their columns by counting as well first, which the bucketing keeps in order
+    auto [lowest, highest] = minmax_element(cells.begin(), cells.end(),
+                                            [](const Cell &a, const Cell &b)
+                                            { return a.y < b.y; });
+    size_t rows = highest->y - lowest->y + 1;
+
+    if (cells.size() > MIN_CELLS_PER_ROW_TO_COUNT * rows)
+    {
+        counting_sort(cells, sorted, &Cell::x);
+        counting_sort(sorted, cells, &Cell::y);
+    }
+    else
+    {
+        counting_sort(cells, sorted, &Cell::y);
+        swap(cells, sorted);
+        for (size_t start = 0, end; start < cells.size(); start = end)
+        {
+            for (end = start + 1; end < cells.size() && cells[end].y == cells[start].y; end++)
+                ;
+            sort(cells.begin() + start, cells.begin() + end, [](const Cell &a, const Cell &b)
+                 { return a.x < b.x; });
+        }
+    }
+
+    // Single pixels of the edges are collected into runs, which are blended at once
+    int run_x = 0, run_y = 0;
+    auto flush_run = [&]()
+    {
+        if (!run.empty())
+            image.get_buffer().blend_span(run_x, run_y, run.size(), run.data(),
+                                          color.get_pixel());
+        run.clear();
+    };
+
+    for (size_t i = 0; i < cells.size();)
+    {
+        int y = cells[i].y, coverage = 0;
+
+        while (i < cells.size() && cells[i].y == y)
+        {
+            int x = cells[i].x;
+            for (; i < cells.size() && cells[i].y == y && cells[i].x == x; i++)
+                coverage += cells[i].delta;
+
+            // The coverage stays the same until the next cell of the row
+            int next_x = i < cells.size() && cells[i].y == y ? cells[i].x : clip.max.x;
+            x = max(x, clip.min.x);
+            next_x = min(next_x, clip.max.x);
+
+            int covered = min(FULL_COVERAGE, abs(coverage));
+            auto alpha = static_cast<unsigned char>(
+                antialiased ? (covered * color.a + FULL_COVERAGE / 2) / FULL_COVERAGE
+                            : (covered >= FULL_COVERAGE / 2 ? color.a : 0));
+            if (alpha == 0 || x >= next_x)
+                flush_run();
+            else if (!antialiased)
+                image.get_buffer().fill_span(x, y, next_x - x, color);
+            else if (next_x - x == 1)
+            {
+                if (run.empty())
+                {
+                    run_x = x;
+                    run_y = y;
+                }
+                run.push_back(alpha);
+            }
+            else
+            {
+                flush_run();
+                image.get_buffer().fill_span(x, y, next_x - x,
+                                             Color(color.r, color.g, color.b, alpha));
+            }
+        }
+
+        flush_run();
+    }
+
+    cells.clear();
+}
@@ -0,0 +1,137 @@
+/**
+ * @file coverage.hpp
+ * @author Adam Berkeš <berkeada@fit.cvut.cz>
+ * @date 2026-10-19
+ */
+
+#pragma once
+
+#include "image.hpp"
+#include "pixel.hpp"
+#include "../rect.hpp"
+#include "../vec2.hpp"
+
+#include <vector>
+
+/** Point in continuous canvas coordinates, pixel (x, y) covers the square from (x, y) to (x + 1, y + 1) */
+using Point = Vec2<double>;
+
+/** Maximum distance of flattened curves from the real ones in pixels */
+constexpr double FLATTEN_TOLERANCE = 0.1;
+
+/**
+ * @brief Sparse scanline accumulator of the area covered by closed outlines,
+ * which renders them anti-aliased using the non-zero winding rule.
+ *
+ * Each edge adds the signed area it covers into the cells it crosses, only the
+ * cells touched by an edge are stored. Filling then sorts the cells and sums
+ * them along each row, so the area covered by the outline is known for every
+ * pixel without testing the pixels inside of it one by one. The interior is
+ * thus filled by long spans, while the pixels on the edges get partial opacity
+ */
+class CoverageAccumulator
+{
+    /**
+     * @brief Signed change of coverage starting at the pixel x of the row y. It's kept
+     * in fixed point, so that the sums don't depend on the order the cells are added in
+     */
+    struct Cell
+    {
+        int y, x;
+        int delta;
+    };
+
+    std::vector<Cell> cells;
+    /** Storage reused for sorting the cells by their columns */
+    std::vector<Cell> sorted;
+    /** Index of the first cell of each column or row while sorting */
+    std::vector<size_t> bucket_starts;
+    /** Opacity of the consecutive pixels which are blended at once while filling */
+    std::vector<unsigned char> run;
+    /** Part of the canvas which is rendered, edges outside of it are clipped */
+    Rect clip;
+    /** First point of the current contour and the last point added to it */
+    Point contour_start, contour_end;
+
+    /**
+     * @brief Add area of the part of an edge between the rows top and bottom of the clip
+     * rectangle. The edge lies at x0 + (y - y0) * dxdy at the height y, its positions
+     * are always computed from the whole edge, so that any part of the canvas gets
+     * exactly the same cells as when the whole canvas is rendered
+     */
+    void add_clipped_edge(double x0, double y0, double dxdy, double top, double bottom, int sign);
+
+    /** Add area of the part of an edge between top and bottom lying on one side of the clip rectangle or within it */
+    void add_row_clipped_edge(double x0, double y0, double dxdy, double top, double bottom,
+                              int sign);
+
+public:
+    /**
+     * @brief Construct a new Coverage Accumulator object
+     *
+     * @param clip_ Part of the canvas which is rendered
+     */
+    explicit CoverageAccumulator(const Rect &clip_);
+
+    /**
+     * @brief Get the accumulator of the calling thread, whose memory is reused
+     * by all the objects the thread renders. It must be filled before it's used again
+     *
+     * @param clip_ Part of the canvas which is rendered
+     * @return CoverageAccumulator&
+     */
+    static CoverageAccumulator &get(const Rect &clip_);
+
+    /** Add an edge going from a to b */
+    void add_edge(const Point &a, const Point &b);
+
+    /** Close the current contour and start a new one at the point */
+    void move_to(const Point &point);
+
+    /** Add an edge from the last point of the current contour to the point */
+    void line_to(const Point &point);
+
+    /** Close the current contour by an edge going back to its first point */
+    void close();
+
+    /**
+     * @brief Add a closed polygon
+     *
+     * @param vertices Vertices of the polygon in order
+     */
+    void add_polygon(const std::vector<Point> &vertices);
+
+    /**
+     * @brief Add an ellipse flattened into a polygon whose vertices lie
+     * at most a small fraction of a pixel away from the ellipse
+     *
+     * @param center
+     * @param radius_x
+     * @param radius_y
+     * @param reversed Whether the ellipse goes in the opposite direction,
+     * which cuts a hole into an ellipse going in the default one
+     * @param rotation Rotation of the X-axis radius in radians, clockwise on the image
+     */
+    void add_ellipse(const Point &center, double radius_x, double radius_y, bool reversed = false,
+                     double rotation = 0);
+
+    /**
+     * @brief Add a line segment stroked into a rectangle with butt ends
+     *
+     * @param a First end of the segment
+     * @param b Second end of the segment
+     * @param width Width of the stroke
+     */
+    void add_segment(const Point &a, const Point &b, double width);
+
+    /**
+     * @brief Fill everything added so far into the image, the opacity of each pixel
+     * is given by the area it shares with the outlines. The accumulator is then empty
+     *
+     * @param image
+     * @param color
+     * @param antialiased Whether the pixels are partially covered, otherwise the pixels
+     * at least half covered are filled with the color and the rest are left as they are
+     */
+    void fill(Image &image, const Color &color, bool antialiased = true);
+};
@@ -5,49 +5,481 @@
  */
 
 #include "image.hpp"
+#include "span_fill.hpp"
 
+#include <algorithm>
+#include <cstring>
+#include <new>
 #include <stdexcept>
 
 using namespace std;
 
-Image::ImageBuffer::ImageBuffer(int width, int height, const Pixel &bg_color)
-try : data(height, vector<Pixel>(width, bg_color))
+void Image::ImageBuffer::StorageDeleter::operator()(unsigned char *bytes) const
 {
+    ::operator delete(bytes);
 }
-catch (...)
+
+unsigned char *Image::ImageBuffer::allocate(size_t size)
+{
+    return static_cast<unsigned char *>(::operator new(size));
+}
+
+void Image::ImageBuffer::set_rows(unsigned char *first_byte)
+{
+    if (layout.bottom_up && height > 0)
+    {
+        top_row = first_byte + (height - 1) * layout.stride;
+        row_step = -static_cast<ptrdiff_t>(layout.stride);
+    }
+    else
+    {
+        top_row = first_byte;
+        row_step = layout.stride;
+    }
+}
+
+bool Image::ImageBuffer::is_contiguous() const
+{
+    return static_cast<size_t>(row_step) == width * sizeof(Pixel);
+}
+
+void Image::ImageBuffer::blend_alpha(size_t y, size_t x, size_t count, unsigned char opacity)
 {
-    throw invalid_argument(
+    if (!alpha)
+        return;
+
+    unsigned char *row_alpha = alpha.get() + y * width + x;
+
+    if (opacity == 255)
+        memset(row_alpha, 255, count);
+    else
+        for (size_t i = 0; i < count; i++)
+            row_alpha[i] = opacity + div255(row_alpha[i] * (255 - opacity));
+}
+
+static invalid_argument resolution_error(int width, int height)
+{
+    return invalid_argument(
         "invalid image resolution: " + to_string(width) + 'x' + to_string(height));
 }
 
-bool Image::ImageBuffer::set_pixel(size_t x, size_t y, Pixel pixel)
+Image::ImageBuffer::ImageBuffer(int width_, int height_, const Color &bg_color,
+                                const Coords &origin_)
+    : width(width_), height(height_), origin(origin_)
+{
+    if (width_ < 0 || height_ < 0)
+        throw resolution_error(width_, height_);
+
+    try
+    {
+        data.reset(allocate(width * height * sizeof(Pixel)));
+        if (!bg_color.is_opaque())
+            alpha.reset(allocate(width * height));
+    }
+    catch (const bad_alloc &)
+    {
+        throw resolution_error(width_, height_);
+    }
+
+    layout = PixelLayout::packed(width_);
+    set_rows(data.get());
+
+    reset(origin, bg_color);
+}
+
+Image::ImageBuffer::ImageBuffer(int width_, int height_, const Pixel &bg_color,
+                                shared_ptr<MappedFile> mapping_, size_t offset,
+                                const PixelLayout &layout_)
+    : mapping(std::move(mapping_)), layout(layout_), width(width_), height(height_)
+{
+    if (width_ < 0 || height_ < 0)
+        throw resolution_error(width_, height_);
+    else if (layout.stride < width * sizeof(Pixel) ||
+             offset + layout.stride * height > mapping->get_size())
+        throw invalid_argument("file is too small for the image: " + mapping->get_path().string());
+
+    set_rows(mapping->get_data() + offset);
+
+    reset(origin, bg_color);
+}
+
+Image::ImageBuffer::ImageBuffer(const ImageBuffer &src)
+    : data(allocate(src.width * src.height * sizeof(Pixel))),
+      layout(PixelLayout::packed(src.width)), width(src.width), height(src.height),
+      origin(src.origin), pixels_written(src.pixels_written), pixels_rejected(src.pixels_rejected)
+{
+    set_rows(data.get());
+
+    if (src.alpha)
+    {
+        alpha.reset(allocate(width * height));
+        memcpy(alpha.get(), src.alpha.get(), width * height);
+    }
+
+    if (src.layout == layout)
+        memcpy(data.get(), src.get_row(0), width * height * sizeof(Pixel));
+    else
+        for (size_t y = 0; y < height; y++)
+            src.copy_row(y, get_row(y));
+}
+
+Image::ImageBuffer::ImageBuffer(ImageBuffer &&src) noexcept
+    : data(std::move(src.data)), alpha(std::move(src.alpha)), mapping(std::move(src.mapping)),
+      layout(src.layout),
+      top_row(src.top_row), row_step(src.row_step), width(src.width), height(src.height),
+      origin(src.origin), pixels_written(src.pixels_written), pixels_rejected(src.pixels_rejected),
+      clip(src.clip)
+{
+    src.top_row = nullptr;
+    src.width = src.height = 0;
+}
+
+Image::ImageBuffer &Image::ImageBuffer::operator=(ImageBuffer src) noexcept
+{
+    std::swap(data, src.data);
+    std::swap(alpha, src.alpha);
+    std::swap(mapping, src.mapping);
+    std::swap(layout, src.layout);
+    std::swap(top_row, src.top_row);
+    std::swap(row_step, src.row_step);
+    std::swap(width, src.width);
+    std::swap(height, src.height);
+    std::swap(origin, src.origin);
+    std::swap(pixels_written, src.pixels_written);
+    std::swap(pixels_rejected, src.pixels_rejected);
+    std::swap(clip, src.clip);
+
+    return *this;
+}
+
+void Image::ImageBuffer::reset(const Coords &new_origin, const Color &bg_color)
 {
-    if (x >= data[0].size() || y >= data.size())
+    origin = new_origin;
+    Pixel stored = to_storage(bg_color.get_premultiplied());
+
+    if (is_contiguous())
+        span_fill::fill(get_row(0), width * height, stored);
+    else
+        for (size_t y = 0; y < height; y++)
+            span_fill::fill(get_row(y), width, stored);
+
+    if (alpha)
+        memset(alpha.get(), bg_color.a, width * height);
+}
+
+const Coords &Image::ImageBuffer::get_origin() const
+{
+    return origin;
+}
+
+const PixelLayout &Image::ImageBuffer::get_layout() const
+{
+    return layout;
+}
+
+const MappedFile *Image::ImageBuffer::get_mapping() const
+{
+    return mapping.get();
+}
+
+bool Image::ImageBuffer::has_alpha() const
+{
+    return alpha != nullptr;
+}
+
+size_t Image::ImageBuffer::get_pixels_written() const
+{
+    return pixels_written;
+}
+
+size_t Image::ImageBuffer::get_pixels_rejected() const
+{
+    return pixels_rejected;
+}
+
+void Image::ImageBuffer::set_clip(const ClipMask *clip_)
+{
+    clip = clip_;
+}
+
+const ClipMask *Image::ImageBuffer::get_clip() const
+{
+    return clip;
+}
+
+bool Image::ImageBuffer::set_pixel(size_t x, size_t y, const Color &color)
+{
+    // Coordinates left or above the origin wrap around and get rejected as well
+    x -= origin.x;
+    y -= origin.y;
+
+    if (x >= width || y >= height ||
+        (clip != nullptr && !clip->contains(x + origin.x, y + origin.y)))
+    {
+        pixels_rejected++;
         return false;
+    }
 
-    data[y][x] = pixel;
+    if (color.is_opaque())
+        get_row(y)[x] = to_storage(color.get_pixel());
+    else
+        span_fill::blend(get_row(y) + x, 1, to_storage(color.get_premultiplied()), color.a);
+    blend_alpha(y, x, 1, color.a);
+    pixels_written++;
 
     return true;
 }
 
-Pixel &Image::ImageBuffer::operator()(size_t x, size_t y)
+void Image::ImageBuffer::fill_span(int x, int y, int length, const Color &color)
 {
-    return data[y][x];
+    fill_rect(x, y, length, 1, color);
+}
+
+void Image::ImageBuffer::fill_rect(int x, int y, int rect_width, int rect_height,
+                                   const Color &color)
+{
+    if (clip == nullptr)
+    {
+        fill_rect_unclipped(x, y, rect_width, rect_height, color);
+        return;
+    }
+
+    // Only the parts of the rows inside of the mask are drawn, the rest is rejected
+    size_t requested = static_cast<size_t>(max(0, rect_width)) * max(0, rect_height), inside = 0;
+
+    for (int row_y = y; row_y < y + rect_height; row_y++)
+        clip->for_each_span(row_y, x, x + rect_width, [&](int begin, int end)
+                            {
+                                fill_rect_unclipped(begin, row_y, end - begin, 1, color);
+                                inside += end - begin;
+                            });
+
+    pixels_rejected += requested - inside;
+}
+
+void Image::ImageBuffer::fill_rect_unclipped(int x, int y, int rect_width, int rect_height,
+                                             const Color &color)
+{
+    long local_x = static_cast<long>(x) - origin.x,
+         local_y = static_cast<long>(y) - origin.y,
+         x0 = max(0L, local_x),
+         y0 = max(0L, local_y),
+         x1 = min(static_cast<long>(width), local_x + rect_width),
+         y1 = min(static_cast<long>(height), local_y + rect_height);
+
+    size_t requested = static_cast<size_t>(max(0, rect_width)) * max(0, rect_height),
+           written = x0 < x1 && y0 < y1 ? (x1 - x0) * (y1 - y0) : 0;
+    pixels_written += written;
+    pixels_rejected += requested - written;
+
+    if (written == 0)
+        return;
+
+    Pixel stored = to_storage(color.get_premultiplied());
+
+    // Rows spanning the whole width are contiguous in memory
+    if (x0 == 0 && static_cast<size_t>(x1) == width && is_contiguous())
+        span_fill::blend(get_row(y0), (y1 - y0) * width, stored, color.a);
+    else
+        for (long row_y = y0; row_y < y1; row_y++)
+            span_fill::blend(get_row(row_y) + x0, x1 - x0, stored, color.a);
+
+    if (alpha)
+        for (long row_y = y0; row_y < y1; row_y++)
+            blend_alpha(row_y, x0, x1 - x0, color.a);
+}
+
+void Image::ImageBuffer::blend_span(int x, int y, int length, const unsigned char *opacities,
+                                    const Pixel &color)
+{
+    if (clip == nullptr)
+    {
+        blend_span_unclipped(x, y, length, opacities, color);
+        return;
+    }
+
+    size_t inside = 0;
+    clip->for_each_span(y, x, x + length, [&](int begin, int end)
+                        {
+                            blend_span_unclipped(begin, y, end - begin, opacities + (begin - x),
+                                                 color);
+                            inside += end - begin;
+                        });
+
+    pixels_rejected += max(0, length) - inside;
+}
+
+void Image::ImageBuffer::blend_span_unclipped(int x, int y, int length,
+                                              const unsigned char *opacities, const Pixel &color)
+{
+    long local_x = static_cast<long>(x) - origin.x, local_y = static_cast<long>(y) - origin.y,
+         x0 = max(0L, local_x), x1 = min(static_cast<long>(width), local_x + length);
+    size_t requested = max(0, length);
+
+    if (local_y < 0 || local_y >= static_cast<long>(height) || x0 >= x1)
+    {
+        pixels_rejected += requested;
+        return;
+    }
+
+    pixels_written += x1 - x0;
+    pixels_rejected += requested - (x1 - x0);
+
+    Pixel stored = to_storage(color), *row_pixels = get_row(local_y);
+    unsigned char *row_alpha = alpha ? alpha.get() + local_y * width : nullptr;
+
+    for (long i = x0; i < x1; i++)
+    {
+        unsigned opacity = opacities[i - local_x], inverse = 255 - opacity;
+        Pixel &dst = row_pixels[i];
+
+        dst = Pixel(div255(stored.r * opacity) + div255(dst.r * inverse),
+                    div255(stored.g * opacity) + div255(dst.g * inverse),
+                    div255(stored.b * opacity) + div255(dst.b * inverse));
+        if (row_alpha)
+            row_alpha[i] = opacity + div255(row_alpha[i] * inverse);
+    }
 }
 
 Pixel Image::ImageBuffer::operator()(size_t x, size_t y) const
 {
-    return data[y][x];
+    return to_storage(get_row(y)[x]);
+}
+
+unsigned char Image::ImageBuffer::get_alpha(size_t x, size_t y) const
+{
+    return alpha ? alpha[y * width + x] : 255;
+}
+
+const unsigned char *Image::ImageBuffer::alpha_row(size_t y) const
+{
+    return alpha ? alpha.get() + y * width : nullptr;
+}
+
+const Pixel *Image::ImageBuffer::row(size_t y) const
+{
+    return get_row(y);
+}
+
+void Image::ImageBuffer::copy_row(size_t y, Pixel *dst) const
+{
+    const Pixel *src = get_row(y);
+
+    if (layout.bgr)
+        for (size_t x = 0; x < width; x++)
+            dst[x] = Pixel(src[x].b, src[x].g, src[x].r);
+    else
+        memcpy(dst, src, width * sizeof(Pixel));
+}
+
+void Image::ImageBuffer::copy_from(const ImageBuffer &src)
+{
+    long x0 = max(origin.x, src.origin.x), y0 = max(origin.y, src.origin.y),
+         x1 = min(origin.x + static_cast<long>(width), src.origin.x + static_cast<long>(src.width)),
+         y1 = min(origin.y + static_cast<long>(height), src.origin.y + static_cast<long>(src.height));
+
+    for (long y = y0; y < y1; y++)
+    {
+        const Pixel *src_row = src.get_row(y - src.origin.y) + (x0 - src.origin.x);
+        Pixel *dst_row = get_row(y - origin.y) + (x0 - origin.x);
+
+        if (layout.bgr == src.layout.bgr)
+            memcpy(dst_row, src_row, (x1 - x0) * sizeof(Pixel));
+        else
+            for (long x = 0; x < x1 - x0; x++)
+                dst_row[x] = Pixel(src_row[x].b, src_row[x].g, src_row[x].r);
+
+        if (alpha && src.alpha)
+            memcpy(alpha.get() + (y - origin.y) * width + (x0 - origin.x),
+                   src.alpha_row(y - src.origin.y) + (x0 - src.origin.x), x1 - x0);
+        else if (alpha)
+            memset(alpha.get() + (y - origin.y) * width + (x0 - origin.x), 255, x1 - x0);
+    }
 }
 
-Image::Image(int width_, int height_, const Pixel &bg_color)
-    : buffer(width_, height_, bg_color), width(width_), height(height_) {}
+Image::Image(int width_, int height_, const Color &bg_color, const Coords &origin)
+    : buffer(width_, height_, bg_color, origin), width(width_), height(height_),
+      background(bg_color) {}
+
+Image::Image(int width_, int height_, const Pixel &bg_color, shared_ptr<MappedFile> mapping,
+             size_t offset, const PixelLayout &layout)
+    : buffer(width_, height_, bg_color, std::move(mapping), offset, layout),
+      width(width_), height(height_), background(bg_color) {}
+
+void Image::reset(const Coords &origin)
+{
+    buffer.reset(origin, background);
+}
 
 int Image::get_width() const { return width; }
 
 int Image::get_height() const { return height; }
 
-long Image::get_size() const { return width * height * sizeof(Pixel); }
+Rect Image::get_bounds() const
+{
+    return Rect(buffer.get_origin(), buffer.get_origin() + Coords(width, height));
+}
+
+void Image::set_antialiased(bool antialiased_)
+{
+    antialiased = antialiased_;
+}
+
+bool Image::is_antialiased() const
+{
+    return antialiased;
+}
+
+void Image::set_supersampling(int factor)
+{
+    if (factor < 1 || factor > 16 || (factor & (factor - 1)) != 0)
+        throw invalid_argument("supersampling factor has to be 1, 2, 4, 8 or 16: " +
+                               to_string(factor));
+    else if (width % factor != 0 || height % factor != 0)
+        throw invalid_argument("image dimensions aren't multiples of the supersampling factor");
+
+    supersampling = factor;
+}
+
+int Image::get_supersampling() const
+{
+    return supersampling;
+}
+
+Coords Image::to_samples(const Coords &point) const
+{
+    return Coords(point.x * supersampling + supersampling / 2,
+                  point.y * supersampling + supersampling / 2);
+}
+
+int Image::get_output_width() const
+{
+    return width / supersampling;
+}
+
+int Image::get_output_height() const
+{
+    return height / supersampling;
+}
+
+void Image::resolve_row(int y, Pixel *dst, unsigned char *alpha) const
+{
+    const unsigned char *rows[16];
+
+    for (int i = 0; i < supersampling; i++)
+        rows[i] = reinterpret_cast<const unsigned char *>(buffer.row(y * supersampling + i));
+    span_fill::downsample(rows, supersampling, sizeof(Pixel), get_output_width(),
+                          reinterpret_cast<unsigned char *>(dst));
+
+    if (alpha == nullptr || !buffer.has_alpha())
+        return;
+
+    for (int i = 0; i < supersampling; i++)
+        rows[i] = buffer.alpha_row(y * supersampling + i);
+    span_fill::downsample(rows, supersampling, 1, get_output_width(), alpha);
+}
+
+long Image::get_size() const { return static_cast<long>(width) * height * sizeof(Pixel); }
 
 Image::ImageBuffer &Image::get_buffer()
 {
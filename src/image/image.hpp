@@ -1,14 +1,51 @@
 /**
- * @file image_builder.hpp
+ * @file image.hpp
  * @author Adam Berkeš <berkeada@fit.cvut.cz>
  * @date 2023-05-06
  */
 
 #pragma once
 
+#include "clip_mask.hpp"
+#include "mapped_file.hpp"
 #include "pixel.hpp"
+#include "../rect.hpp"
+#include "../vec2.hpp"
 
-#include <vector>
+#include <cstddef>
+#include <memory>
+
+/**
+ * @brief Description of the way pixels of an image are stored in memory,
+ * which allows rendering straight into the pixel data of uncompressed formats
+ */
+struct PixelLayout
+{
+    /** Channels of each pixel are stored in the order blue, green, red */
+    bool bgr = false;
+    /** Rows are stored starting with the bottom one */
+    bool bottom_up = false;
+    /** Number of bytes between the starts of two consecutive rows */
+    size_t stride = 0;
+
+    /** Get layout of tightly packed RGB rows stored starting with the top one */
+    static PixelLayout packed(int width)
+    {
+        return {false, false, static_cast<size_t>(width) * sizeof(Pixel)};
+    }
+
+    /** Equality comparison operator */
+    bool operator==(const PixelLayout &rhs) const
+    {
+        return bgr == rhs.bgr && bottom_up == rhs.bottom_up && stride == rhs.stride;
+    }
+
+    /** Non-equality comparison operator */
+    bool operator!=(const PixelLayout &rhs) const
+    {
+        return !(*this == rhs);
+    }
+};
 
 /**
  * @brief General Image class representing an image
@@ -18,12 +55,81 @@
 class Image
 {
     /**
-     * @brief Class represneting underlying image data,
-     * which is a two-dimensional vector of pixels
+     * @brief Class represneting underlying image data, which is a block
+     * of pixels stored either in memory or in a memory-mapped file in the
+     * given layout. The buffer may cover only a part of the canvas starting
+     * at its origin, all the drawing methods take canvas coordinates,
+     * while the accessors take coordinates relative to the buffer
      */
     class ImageBuffer
     {
-        std::vector<std::vector<Pixel>> data;
+        /** Deleter for pixel storage allocated by allocate() */
+        struct StorageDeleter
+        {
+            void operator()(unsigned char *bytes) const;
+        };
+
+        /** Storage owned by the buffer, empty if the pixels live in a mapped file */
+        std::unique_ptr<unsigned char[], StorageDeleter> data;
+        /**
+         * Opacity of each pixel, rows of which are stored tightly packed starting with
+         * the top one. It's allocated only for translucent backgrounds, the pixels are
+         * then stored premultiplied by their opacity
+         */
+        std::unique_ptr<unsigned char[], StorageDeleter> alpha;
+        /** File the pixels live in, if any */
+        std::shared_ptr<MappedFile> mapping;
+        PixelLayout layout;
+        /** First byte of the top row */
+        unsigned char *top_row = nullptr;
+        /** Number of bytes between the top row and the row below it */
+        std::ptrdiff_t row_step = 0;
+        size_t width, height;
+        /** Canvas coordinates of the first pixel of the buffer */
+        Coords origin;
+        /** Number of pixels drawn into the buffer and rejected for being out of its bounds */
+        size_t pixels_written = 0, pixels_rejected = 0;
+        /** Mask the drawing is limited to, nullptr if the whole buffer is drawn into */
+        const ClipMask *clip = nullptr;
+
+        /**
+         * @brief Allocate storage for given number of bytes without initializing
+         * them, so that each pixel is written only once by the background fill
+         *
+         * @throws std::bad_alloc If the storage couldn't be allocated
+         * @param size Number of bytes
+         * @return unsigned char*
+         */
+        static unsigned char *allocate(size_t size);
+
+        /** Point top_row and row_step at the rows of the storage starting at first_byte */
+        void set_rows(unsigned char *first_byte);
+
+        /** Convert the pixel between RGB and the channel order of the layout */
+        Pixel to_storage(const Pixel &pixel) const
+        {
+            return layout.bgr ? Pixel(pixel.b, pixel.g, pixel.r) : pixel;
+        }
+
+        /** Get pointer to the first pixel of a row as it is stored */
+        Pixel *get_row(size_t y) const
+        {
+            return reinterpret_cast<Pixel *>(top_row + static_cast<std::ptrdiff_t>(y) * row_step);
+        }
+
+        /** Check whether all the rows are stored contiguously starting with the top one */
+        bool is_contiguous() const;
+
+        /** Composite opacity over a span of the opacity of a row, if it's stored */
+        void blend_alpha(size_t y, size_t x, size_t count, unsigned char opacity);
+
+        /** Fill rectangle of pixels regardless of the clip mask */
+        void fill_rect_unclipped(int x, int y, int rect_width, int rect_height,
+                                 const Color &color);
+
+        /** Composite color over a span of pixels regardless of the clip mask */
+        void blend_span_unclipped(int x, int y, int length, const unsigned char *opacities,
+                                  const Pixel &color);
 
     public:
         /**
@@ -34,43 +140,189 @@ class Image
          * is negative
          * @param width
          * @param height
+         * @param bg_color Background color, the opacity of the pixels
+         * is stored only if it's translucent
+         * @param origin Canvas coordinates of the first pixel
+         */
+        ImageBuffer(int width, int height, const Color &bg_color, const Coords &origin = {});
+
+        /**
+         * @brief Construct a new Image Buffer object whose pixels live in the mapped file
+         * and fill it with the background color, bytes padding the rows are left untouched
+         *
+         * @throws std::invalid_argument If either one of the dimensions is negative,
+         * or if the file is too small to hold the pixels
+         * @param width
+         * @param height
          * @param bg_color
+         * @param mapping_ File the pixels are stored in
+         * @param offset Offset of the pixel data in the file
+         * @param layout_ Layout of the pixel data
+         */
+        ImageBuffer(int width, int height, const Pixel &bg_color,
+                    std::shared_ptr<MappedFile> mapping_, size_t offset,
+                    const PixelLayout &layout_);
+
+        /**
+         * @brief Construct a new Image Buffer object by copying all pixels of src,
+         * the copy is always stored in memory using the packed layout and isn't clipped
          */
-        ImageBuffer(int width, int height, const Pixel &bg_color);
+        ImageBuffer(const ImageBuffer &src);
+
+        ImageBuffer(ImageBuffer &&src) noexcept;
+
+        ImageBuffer &operator=(ImageBuffer src) noexcept;
 
         /**
-         * @brief Try to set the pixel at the specified position
+         * @brief Move the buffer to a different part of the canvas
+         * and fill it with the background color again
+         *
+         * @param new_origin Canvas coordinates of the first pixel
+         * @param bg_color
+         */
+        void reset(const Coords &new_origin, const Color &bg_color);
+
+        /** Origin getter */
+        const Coords &get_origin() const;
+
+        /** Layout getter */
+        const PixelLayout &get_layout() const;
+
+        /** Get the file the pixels are stored in, nullptr if they are stored in memory */
+        const MappedFile *get_mapping() const;
+
+        /** Check whether the opacity of the pixels is stored */
+        bool has_alpha() const;
+
+        /** Get number of pixels drawn into the buffer, the background isn't included */
+        size_t get_pixels_written() const;
+
+        /** Get number of pixels which weren't drawn for being out of bounds of the buffer or the clip mask */
+        size_t get_pixels_rejected() const;
+
+        /**
+         * @brief Limit all the drawing to the pixels inside of the mask,
+         * the pixels outside of it are rejected
+         *
+         * @param clip_ Mask in canvas coordinates, which must outlive its use,
+         * nullptr to draw into the whole buffer again
+         */
+        void set_clip(const ClipMask *clip_);
+
+        /** Get the mask the drawing is limited to, nullptr if it isn't limited */
+        const ClipMask *get_clip() const;
+
+        /**
+         * @brief Try to set the pixel at the specified position, translucent
+         * colors are composited over the pixel
          *
          * @param x X-axis coordinate
          * @param y Y-axis coordinate
-         * @param pixel
+         * @param color
          * @return true If the position was valid, otherwise false
          */
-        bool set_pixel(size_t x, size_t y, Pixel pixel);
+        bool set_pixel(size_t x, size_t y, const Color &color);
 
         /**
-         * @brief Get mutable reference to the pixel
-         * specified by x and y coordinates
+         * @brief Fill horizontal span of pixels with given color, the part
+         * of the span outside of the buffer is ignored
          *
-         * @param x X-axis coordinate
-         * @param y Y-axis coordinate
-         * @return Pixel&
+         * @param x X-axis coordinate of the first pixel
+         * @param y Y-axis coordinate of the span
+         * @param length Number of pixels in the span
+         * @param color
+         */
+        void fill_span(int x, int y, int length, const Color &color);
+
+        /**
+         * @brief Fill rectangle of pixels with given color, the part of the rectangle
+         * outside of the buffer is ignored. Translucent colors are composited over
+         * the pixels, while opaque ones overwrite them without reading them
+         *
+         * @param x X-axis coordinate of the upper left corner
+         * @param y Y-axis coordinate of the upper left corner
+         * @param rect_width Width of the rectangle
+         * @param rect_height Height of the rectangle
+         * @param color
          */
-        Pixel &operator()(size_t x, size_t y);
+        void fill_rect(int x, int y, int rect_width, int rect_height, const Color &color);
+
+        /**
+         * @brief Composite color over a horizontal span of pixels, each of which
+         * has its own opacity, e.g. the edges of anti-aliased objects. The part
+         * of the span outside of the buffer is ignored
+         *
+         * @param x X-axis coordinate of the first pixel
+         * @param y Y-axis coordinate of the span
+         * @param length Number of pixels in the span
+         * @param opacities Opacity of each pixel of the span
+         * @param color
+         */
+        void blend_span(int x, int y, int length, const unsigned char *opacities,
+                        const Pixel &color);
 
         /**
          * @brief Get pixel from the buffer specified
-         * by x and y coordinates
+         * by x and y coordinates, premultiplied by its opacity
          *
          * @param x X-axis coordinate
          * @param y Y-axis coordinate
          * @return Pixel
          */
         Pixel operator()(size_t x, size_t y) const;
+
+        /**
+         * @brief Get opacity of the pixel specified by x and y coordinates
+         *
+         * @param x X-axis coordinate
+         * @param y Y-axis coordinate
+         * @return unsigned char 255 if the opacity isn't stored
+         */
+        unsigned char get_alpha(size_t x, size_t y) const;
+
+        /**
+         * @brief Get pointer to the opacity of the first pixel of a row
+         *
+         * @param y Y-axis coordinate of the row
+         * @return const unsigned char* nullptr if the opacity isn't stored
+         */
+        const unsigned char *alpha_row(size_t y) const;
+
+        /**
+         * @brief Get pointer to the first pixel of a row as it is stored,
+         * pixels of the row are stored contiguously in the channel order
+         * given by the layout
+         *
+         * @param y Y-axis coordinate of the row
+         * @return const Pixel*
+         */
+        const Pixel *row(size_t y) const;
+
+        /**
+         * @brief Copy pixels of a row converting them into RGB
+         *
+         * @param y Y-axis coordinate of the row
+         * @param dst Destination for width pixels
+         */
+        void copy_row(size_t y, Pixel *dst) const;
+
+        /**
+         * @brief Copy pixels of another buffer covering a part of the same canvas,
+         * the pixels outside of this buffer are ignored. Copied pixels aren't counted
+         * as written, since they were already counted by src
+         *
+         * @param src Buffer to be copied
+         */
+        void copy_from(const ImageBuffer &src);
     };
 
     ImageBuffer buffer;
     int width, height;
+    Color background;
+    /** Whether the objects are rendered with anti-aliased edges */
+    bool antialiased = false;
+    /** Number of samples along each axis of a pixel of the encoded image */
+    int supersampling = 1;
 
 public:
     /**
@@ -82,9 +334,35 @@ public:
      * entered is negative
      * @param width Width of the image
      * @param height Height of the image
-     * @param bg_color Optional background color
+     * @param bg_color Optional background color, which may be translucent
+     * @param origin Optional canvas coordinates of the upper left corner,
+     * which allows rendering only a part of a larger canvas into the image
+     */
+    Image(int width, int height, const Color &bg_color = Color(), const Coords &origin = {});
+
+    /**
+     * @brief Construct a new Image object whose pixels are stored
+     * directly in a memory-mapped file
+     *
+     * @throws std::invalid_argument If either one of the dimensions
+     * entered is negative, or if the file is too small to hold the pixels
+     * @param width Width of the image
+     * @param height Height of the image
+     * @param bg_color Background color
+     * @param mapping File the pixels are stored in
+     * @param offset Offset of the pixel data in the file
+     * @param layout Layout of the pixel data
+     */
+    Image(int width, int height, const Pixel &bg_color, std::shared_ptr<MappedFile> mapping,
+          size_t offset, const PixelLayout &layout);
+
+    /**
+     * @brief Move the image to a different part of the canvas,
+     * clearing all the pixels to the background color
+     *
+     * @param origin Canvas coordinates of the upper left corner
      */
-    Image(int width, int height, const Pixel &bg_color = Pixel());
+    void reset(const Coords &origin);
 
     /** Width getter */
     int get_width() const;
@@ -92,6 +370,58 @@ public:
     /** Height getter */
     int get_height() const;
 
+    /** Get the part of the canvas covered by the image */
+    Rect get_bounds() const;
+
+    /**
+     * @brief Set whether the objects are rendered with anti-aliased edges, whose pixels
+     * get opacity by the area covered by the object, instead of being either drawn or not
+     *
+     * @param antialiased_
+     */
+    void set_antialiased(bool antialiased_);
+
+    /** Check whether the objects are rendered with anti-aliased edges */
+    bool is_antialiased() const;
+
+    /**
+     * @brief Render the objects at a multiple of the resolution of the encoded image,
+     * each pixel of which is then the average of factor x factor samples. The pixels
+     * of the buffer are the samples, while the objects keep their canvas coordinates
+     *
+     * @throws std::invalid_argument If the factor isn't a power of two up to 16,
+     * or if the dimensions of the image aren't its multiples
+     * @param factor Number of samples along each axis of a pixel
+     */
+    void set_supersampling(int factor);
+
+    /** Get number of samples along each axis of a pixel of the encoded image */
+    int get_supersampling() const;
+
+    /**
+     * @brief Convert canvas coordinates of a pixel into the coordinates
+     * of the sample in the middle of the samples covering it
+     *
+     * @param point Canvas coordinates
+     * @return Coords Coordinates of the sample
+     */
+    Coords to_samples(const Coords &point) const;
+
+    /** Get width of the encoded image, i.e. the width divided by the supersampling factor */
+    int get_output_width() const;
+
+    /** Get height of the encoded image, i.e. the height divided by the supersampling factor */
+    int get_output_height() const;
+
+    /**
+     * @brief Average the samples covering a row of the encoded image
+     *
+     * @param y Y-axis coordinate of the row of the encoded image relative to the buffer
+     * @param dst Destination for get_output_width() pixels, premultiplied by their opacity
+     * @param alpha Destination for the opacity of the pixels, ignored if it isn't stored
+     */
+    void resolve_row(int y, Pixel *dst, unsigned char *alpha) const;
+
     /** Calculate the raw size of the image in bytes */
     long get_size() const;
 
@@ -5,57 +5,97 @@
  */
 
 #include "image_builder.hpp"
+#include "../trace.hpp"
 #include "../utils.hpp"
 
+#include <algorithm>
+#include <cstdint>
 #include <sstream>
 #include <stdexcept>
 #include <iostream>
+#include <unordered_map>
 
 using namespace std;
 using namespace utils;
 
-ImageBuilder::ImageBuilder(const image_config &img_conf)
-    : ImageBuilder(get<0>(img_conf), get<1>(img_conf), get<2>(img_conf)) {}
+/** Number of lines of the image configuration covered by a single parse span of the trace */
+constexpr size_t TRACE_LINE_BATCH = 256;
+/** Maximum number of opaque interiors the objects below them are tested against */
+constexpr size_t MAX_OCCLUDERS = 16;
 
-ImageBuilder::image_config ImageBuilder::parse_image_config(const string &filename)
+/**
+ * @brief Split the parameter "clip=GROUP" off of a line of an object
+ *
+ * @param line Normalized line
+ * @return std::pair<std::string, std::string> Rest of the line and the name
+ * of the group, which is empty if the object isn't clipped
+ */
+static pair<string, string> split_clip(const string &line)
+{
+    string rest, group_name;
+
+    for (const string &word : split_str(line))
+        if (word.rfind("clip=", 0) == 0 && !rest.empty())
+            group_name = extract_arg(word, "clip");
+        else
+            rest += (rest.empty() ? "" : " ") + word;
+
+    return {rest, group_name};
+}
+
+ImageBuilder::ImageBuilder(const image_config &img_conf, pmr::memory_resource *upstream)
+    : ImageBuilder(get<0>(img_conf), get<1>(img_conf), get<2>(img_conf), upstream)
+{
+    frame_count = get<3>(img_conf);
+}
+
+ImageBuilder::image_config ImageBuilder::parse_image_config(istream &is, const string &source)
 {
     const invalid_argument err("error parsing the image configuration");
     string line, cmd;
-    fstream file_stream = try_open_file(filename);
-    getline(file_stream, line);
-    check_fstream(file_stream, filename);
-    stringstream is(line);
+    getline(is, line);
+    check_fstream(is, source);
+    stringstream line_stream(line);
     int width, height;
-    Pixel bg;
+    Color bg;
+    size_t frames = 1;
 
-    is >> cmd >> width >> height;
+    line_stream >> cmd >> width >> height;
 
     if (cmd != "image")
         throw invalid_argument(
             "image definition needs to start with 'image'\ngiven command: " + cmd);
-    else if (is.fail())
+    else if (line_stream.fail())
         throw err;
 
-    if (is.rdbuf()->in_avail() > 0)
+    string arg;
+
+    if (line_stream >> arg && arg.rfind("background", 0) == 0)
     {
-        string background;
-        is >> background;
-        string bg_val = extract_arg(background, "background");
-        bg = Pixel(bg_val);
+        bg = Color(extract_arg(arg, "background"));
+        arg.clear();
+        line_stream >> arg;
     }
 
-    string rest;
-    is >> rest;
+    if (arg.rfind("frames", 0) == 0)
+    {
+        frames = extract_int_arg(arg, "frames", 1);
+        arg.clear();
+        line_stream >> arg;
+    }
 
-    if (!normalize_str(rest).empty())
+    if (!arg.empty())
         throw err;
 
-    return make_tuple(width, height, bg);
+    return make_tuple(width, height, bg, frames);
 }
 
 void ImageBuilder::parse_group(const ObjectRegistry &supported_objects, istream &is,
-                               const string &group_name)
+                               const string &group_name, size_t &line_number)
 {
+    trace::Span span("parse", [&]()
+                     { return "group " + group_name; });
+
     if (groups.count(group_name) > 0 || supported_objects.is_available(group_name))
         throw invalid_argument("object with name: " + group_name + " already exists");
     else if (group_name.empty() || any_of(group_name.begin(), group_name.end(), [](char c)
@@ -63,11 +103,14 @@ void ImageBuilder::parse_group(const ObjectRegistry &supported_objects, istream
         throw invalid_argument("object name cannot contain whitespace: " + group_name);
 
     string line;
-    Group group;
+    Group group(&arena);
+    group.set_definition_name(group_name);
+    size_t group_hash = hash<string>()(group_name);
     bool ended_properly = false;
 
     while (getline(is, line))
     {
+        line_number++;
         line = normalize_str(line);
 
         if (line.empty())
@@ -78,36 +121,53 @@ void ImageBuilder::parse_group(const ObjectRegistry &supported_objects, istream
         if (cmd == "start_group")
             throw invalid_argument(
                 "definition of a group inside of another group is not allowed");
+        else if (cmd == "animate")
+            throw invalid_argument("objects inside of groups can't be animated, "
+                                   "animate the instances of the group instead");
         else if (cmd == "end_group")
         {
             ended_properly = true;
             break;
         }
-        else if (groups.count(cmd) > 0)
-        {
-            Group inner_group(groups.at(cmd));
-            inner_group.add_params(args);
-            group.add_object(inner_group);
-        }
-        else
-            group.add_object(*supported_objects.parse_from_str(line));
+        else if (!split_clip(line).second.empty())
+            throw invalid_argument("objects inside of groups can't be clipped, "
+                                   "clip the instances of the group instead");
+
+        Object::ptr obj = groups.count(cmd) > 0
+                              ? instantiate_group(cmd, args)
+                              : supported_objects.parse_from_str(line, err_out, &arena);
+        obj->set_source_line(line_number);
+        group.add_object(std::move(obj));
+        group_hash = group_hash * 31 + hash_line(line, cmd);
     }
 
     if (!ended_properly)
         throw invalid_argument("group " + group_name + " was never ended");
 
-    groups.insert({group_name, group});
+    groups.emplace(group_name, std::move(group));
+    group_hashes.emplace(group_name, group_hash);
 }
 
-void ImageBuilder::parse_object_config(const ObjectRegistry &supported_objects,
-                                       const string &filename)
+void ImageBuilder::parse_object_config(const ObjectRegistry &supported_objects, istream &is,
+                                       const string &source)
 {
-    fstream is = try_open_file(filename);
     string line;
-    getline(is, line); // Skip first line which is image config
+    size_t line_number = 1, batch_start = 0;
+    unique_ptr<trace::Span> batch_span;
 
     while (getline(is, line))
     {
+        line_number++;
+
+        if (trace::is_enabled() && (!batch_span || line_number >= batch_start + TRACE_LINE_BATCH))
+        {
+            batch_start = line_number;
+            batch_span.reset();
+            batch_span = make_unique<trace::Span>(
+                "parse", [&]()
+                { return "lines from " + to_string(batch_start); });
+        }
+
         line = normalize_str(line);
 
         if (line.empty())
@@ -116,53 +176,593 @@ void ImageBuilder::parse_object_config(const ObjectRegistry &supported_objects,
         const auto &[cmd, args] = split_str_once(line);
 
         if (cmd == "start_group")
-            parse_group(supported_objects, is, args);
+            parse_group(supported_objects, is, args, line_number);
         else if (cmd == "end_group")
             throw invalid_argument("end_group reached when no group was started");
-        else if (groups.count(cmd) > 0)
+        else if (cmd == "animate")
+        {
+            parse_keyframes(args);
+            // The keyframes are a part of the object, so they change its hash
+            object_hashes.back() = object_hashes.back() * 31 + hash_line(line, cmd);
+        }
+        else
+        {
+            const auto &[object_line, clip_name] = split_clip(line);
+            const auto &[object_cmd, object_args] = split_str_once(object_line);
+            Object::ptr obj = groups.count(object_cmd) > 0
+                                  ? instantiate_group(object_cmd, object_args)
+                                  : supported_objects.parse_from_str(object_line, err_out, &arena);
+            size_t line_hash = hash_line(line, cmd);
+
+            if (!clip_name.empty())
+            {
+                obj = clip_object(std::move(obj), clip_name);
+                line_hash = line_hash * 31 + group_hashes.at(clip_name);
+            }
+
+            obj->set_source_line(line_number);
+            objects.push_back(std::move(obj));
+            object_hashes.push_back(line_hash);
+        }
+    }
+
+    check_fstream(is, source);
+}
+
+void ImageBuilder::parse_keyframes(const string &args)
+{
+    if (objects.empty())
+        throw invalid_argument("keyframes have to follow the object they animate");
+
+    const Object &obj = *objects.back();
+    Keyframes keyframes(args, frame_count);
+    auto animation = animations.find(objects.size() - 1);
+
+    if (!keyframes.is_applicable(obj))
+        throw invalid_argument(obj.get_label() + " has no parameter " +
+                               keyframes.get_parameter_name());
+    else if (animation != animations.end() &&
+             any_of(animation->second.begin(), animation->second.end(),
+                    [&](const Keyframes &k)
+                    { return k.get_parameter() == keyframes.get_parameter(); }))
+        throw invalid_argument("parameter " + keyframes.get_parameter_name() + " of " +
+                               obj.get_label() + " is already animated");
+
+    animations[objects.size() - 1].push_back(std::move(keyframes));
+}
+
+Object::ptr ImageBuilder::instantiate_group(const string &name, const string &params)
+{
+    // Timing every instance would be costly, so it's done only when collecting stats
+    optional<Stopwatch> stopwatch;
+    if (stats != nullptr)
+        stopwatch.emplace();
+
+    auto group = Object::make<Group>(&arena, groups.at(name));
+    group->add_params(params);
+
+    if (stopwatch)
+        group_resolution_time += stopwatch->elapsed();
+
+    return group;
+}
+
+Object::ptr ImageBuilder::clip_object(Object::ptr obj, const string &group_name)
+{
+    auto group = groups.find(group_name);
+    if (group == groups.end())
+        throw invalid_argument("there is no group to clip by with name: " + group_name);
+
+    shared_ptr<const ClipRegion> &region = clip_regions[group_name];
+    if (!region)
+        region = make_shared<ClipRegion>(group->second, Rect(Coords(0, 0), Coords(width, height)));
+
+    return Object::make<ClippedObject>(&arena, std::move(obj), region);
+}
+
+vector<bool> ImageBuilder::find_occluded_objects(size_t first) const
+{
+    Rect canvas(Coords(0, 0), Coords(width, height));
+    vector<bool> is_occluded(objects.size() - first, false);
+    vector<Rect> occluders;
+    auto area = [](const Rect &rect)
+    { return static_cast<long>(rect.get_width()) * rect.get_height(); };
+
+    for (size_t i = objects.size(); i-- > first;)
+    {
+        // Pixels out of the canvas are never drawn, so they needn't be hidden
+        Rect bounds = get_object_bounds(i).intersected(canvas);
+        if (!bounds.is_empty() && any_of(occluders.begin(), occluders.end(), [&](const Rect &occluder)
+                                         { return occluder.contains(bounds); }))
         {
-            Group group(groups.at(cmd));
-            group.add_params(args);
-            objects.push_back(make_unique<Group>(group));
+            is_occluded[i - first] = true;
+            continue;
         }
+
+        Rect interior = objects[i]->get_opaque_interior(Transform()).intersected(canvas);
+        if (interior.is_empty())
+            continue;
+
+        // Only the largest interiors are kept, so that each object is tested against a few of them
+        if (occluders.size() < MAX_OCCLUDERS)
+            occluders.push_back(interior);
         else
-            objects.push_back(supported_objects.parse_from_str(line));
+        {
+            auto smallest = min_element(occluders.begin(), occluders.end(),
+                                        [&](const Rect &a, const Rect &b)
+                                        { return area(a) < area(b); });
+            if (area(interior) > area(*smallest))
+                *smallest = interior;
+        }
     }
 
-    check_fstream(is, filename);
+    return is_occluded;
+}
+
+void ImageBuilder::record_render(const Timing &time, size_t pixels_written,
+                                 size_t pixels_rejected, size_t objects_culled) const
+{
+    if (stats == nullptr)
+        return;
+
+    stats->add_time("render", time);
+    stats->add_pixels(pixels_written, pixels_rejected);
+    stats->add_culled_objects(objects_culled);
 }
 
-ImageBuilder::ImageBuilder(int width, int height, const Pixel &bg_color)
-    : image(width, height, bg_color) {}
+ImageBuilder::ImageBuilder(int width_, int height_, const Color &bg_color,
+                           pmr::memory_resource *upstream)
+    : arena(upstream), edits(upstream), width(width_), height(height_), background(bg_color)
+{
+    if (width < 0 || height < 0)
+        throw invalid_argument(
+            "invalid image resolution: " + to_string(width) + 'x' + to_string(height));
+}
+
+ImageBuilder::ImageBuilder(const ObjectRegistry &supported_objects, istream &&is,
+                           const string &source, Stats *stats_,
+                           pmr::memory_resource *upstream, ostream *err_out_)
+    : ImageBuilder(parse_image_config(is, source), upstream)
+{
+    trace::Span span("parse", [&]()
+                     { return "parse " + source; });
+    Stopwatch stopwatch;
+    stats = stats_;
+    err_out = err_out_;
+
+    parse_object_config(supported_objects, is, source);
+
+    if (stats != nullptr)
+    {
+        stats->add_time("parse", stopwatch.elapsed() - group_resolution_time);
+        stats->add_time("group_resolution", group_resolution_time);
+        // The scene may be rendered into several outputs, but its objects are counted once
+        stats->add_object_counts(count_objects());
+    }
+}
 
 ImageBuilder::ImageBuilder(const ObjectRegistry &supported_objects,
-                           const string &filename)
-    : ImageBuilder(parse_image_config(filename))
+                           const string &filename, Stats *stats_, ostream *err_out_)
+    : ImageBuilder(supported_objects, try_open_file(filename), filename, stats_,
+                   pmr::get_default_resource(), err_out_) {}
+
+ImageBuilder::ImageBuilder(const ObjectRegistry &supported_objects, istream &is, Stats *stats_,
+                           pmr::memory_resource *upstream, ostream *err_out_)
+    : ImageBuilder(supported_objects, std::move(is), "image configuration", stats_, upstream,
+                   err_out_) {}
+
+Image &ImageBuilder::get_or_create_image() const
+{
+    if (!image)
+        image.emplace(create_image(width, height));
+
+    return *image;
+}
+
+Image ImageBuilder::create_image(int part_width, int part_height, const Coords &origin) const
+{
+    Image created(part_width * supersampling, part_height * supersampling, background,
+                  Coords(origin.x * supersampling, origin.y * supersampling));
+    created.set_antialiased(antialiased);
+    created.set_supersampling(supersampling);
+
+    return created;
+}
+
+size_t ImageBuilder::hash_line(const string &line, const string &cmd) const
+{
+    size_t line_hash = hash<string>()(line);
+    auto group_hash = group_hashes.find(cmd);
+
+    // Lines of objects are hashed to 0 only by accident, 0 is reserved for unknown contents
+    if (group_hash != group_hashes.end())
+        line_hash ^= group_hash->second + 0x9e3779b9 + (line_hash << 6) + (line_hash >> 2);
+
+    return line_hash == 0 ? 1 : line_hash;
+}
+
+pair<size_t, size_t> ImageBuilder::render_region(const Rect &region)
+{
+    Rect clipped = region.intersected(Rect(Coords(0, 0), Coords(width, height)));
+
+    if (clipped.is_empty())
+        return {0, 0};
+
+    trace::Span span("render", "render region");
+    ObjectProfile::Activation activation(profile);
+    Image patch = create_image(clipped.get_width(), clipped.get_height(), clipped.min);
+
+    for (const Object::ptr &obj : objects)
+        if (obj->get_bounds(Transform()).intersects(clipped))
+            obj->render_traced(patch, Transform());
+
+    get_or_create_image().get_buffer().copy_from(patch.get_buffer());
+
+    return {patch.get_buffer().get_pixels_written(), patch.get_buffer().get_pixels_rejected()};
+}
+
+bool ImageBuilder::is_up_to_date() const
 {
-    parse_object_config(supported_objects, filename);
+    return rendered_count == objects.size() && dirty.is_empty();
+}
+
+Rect ImageBuilder::get_object_bounds(size_t index) const
+{
+    if (index >= objects.size())
+        throw invalid_argument("there is no object with index: " + to_string(index));
+
+    return objects[index]->get_bounds(Transform());
+}
+
+Rect ImageBuilder::render_incrementally(ImageBuilder &previous)
+{
+    Rect full(Coords(0, 0), Coords(width, height));
+
+    if (!previous.is_up_to_date() || !previous.image || previous.width != width ||
+        previous.height != height || previous.background != background ||
+        previous.antialiased != antialiased || previous.supersampling != supersampling)
+    {
+        render();
+        return full;
+    }
+
+    // Objects are matched by the occurrences of their hashes, i.e. the k-th object
+    // with some hash in the previous builder is matched with the k-th one in this builder
+    unordered_map<size_t, vector<size_t>> previous_indices;
+    for (size_t i = previous.object_hashes.size(); i-- > 0;)
+        if (previous.object_hashes[i] != 0)
+            previous_indices[previous.object_hashes[i]].push_back(i);
+
+    vector<long> matches(objects.size(), -1);
+    for (size_t i = 0; i < objects.size(); i++)
+    {
+        auto it = previous_indices.find(object_hashes[i]);
+
+        if (it != previous_indices.end() && !it->second.empty())
+        {
+            matches[i] = it->second.back();
+            it->second.pop_back();
+        }
+    }
+
+    // Only the matched objects whose order didn't change are kept, which are found
+    // as the longest increasing subsequence of their previous indices
+    vector<size_t> tails, predecessors(objects.size());
+    for (size_t i = 0; i < objects.size(); i++)
+    {
+        if (matches[i] < 0)
+            continue;
+
+        auto it = lower_bound(tails.begin(), tails.end(), matches[i], [&](size_t index, long match)
+                              { return matches[index] < match; });
+        predecessors[i] = it == tails.begin() ? SIZE_MAX : *(it - 1);
+
+        if (it == tails.end())
+            tails.push_back(i);
+        else
+            *it = i;
+    }
+
+    vector<bool> is_kept(objects.size(), false), was_kept(previous.objects.size(), false);
+    for (size_t i = tails.empty() ? SIZE_MAX : tails.back(); i != SIZE_MAX; i = predecessors[i])
+    {
+        is_kept[i] = true;
+        was_kept[matches[i]] = true;
+    }
+
+    // Pixels outside of the bounds of the changed objects are covered by the same
+    // objects in the same order, so they stay the same
+    Rect changed;
+    for (size_t i = 0; i < objects.size(); i++)
+        if (!is_kept[i])
+            changed = changed.united(get_object_bounds(i));
+    for (size_t i = 0; i < previous.objects.size(); i++)
+        if (!was_kept[i])
+            changed = changed.united(previous.get_object_bounds(i));
+
+    image = std::move(previous.image);
+    previous.image.reset();
+    previous.rendered_count = 0;
+
+    changed = changed.intersected(full);
+    render_region(changed);
+    rendered_count = objects.size();
+    dirty = Rect();
+
+    return changed;
 }
 
 const Image &ImageBuilder::get_image() const
 {
-    return image;
+    return get_or_create_image();
+}
+
+bool ImageBuilder::map_image(const Encoder &encoder, const filesystem::path &file)
+{
+    // Formats storing raw pixels have no opacity, and they can't hold the samples
+    if (image || !background.is_opaque() || supersampling > 1)
+        return false;
+
+    image = encoder.create_mapped_image(file, width, height, background.get_pixel());
+    if (image)
+        image->set_antialiased(antialiased);
+
+    return image.has_value();
+}
+
+void ImageBuilder::set_profile(ObjectProfile *profile_)
+{
+    profile = profile_;
+}
+
+void ImageBuilder::set_antialiased(bool antialiased_)
+{
+    antialiased = antialiased_;
+}
+
+void ImageBuilder::set_supersampling(int factor)
+{
+    if (factor != 1 && factor != 2 && factor != 4)
+        throw invalid_argument("supersampling factor has to be 1, 2 or 4: " + to_string(factor));
+
+    supersampling = factor;
 }
 
 ImageBuilder &ImageBuilder::add_object(const Object &obj)
 {
-    is_rendered = false;
+    objects.push_back(obj.clone(&edits));
+    object_hashes.push_back(0);
+    base_layer.reset();
+
+    return *this;
+}
+
+ImageBuilder &ImageBuilder::remove_object(size_t index)
+{
+    Rect bounds = get_object_bounds(index);
+
+    if (index < rendered_count)
+    {
+        dirty = dirty.united(bounds);
+        rendered_count--;
+    }
+
+    objects.erase(objects.begin() + index);
+    object_hashes.erase(object_hashes.begin() + index);
+    base_layer.reset();
+
+    // Keyframes of the objects above the removed one move along with them
+    map<size_t, vector<Keyframes>> shifted;
+    for (auto &[i, keyframes] : animations)
+        if (i != index)
+            shifted.emplace(i > index ? i - 1 : i, std::move(keyframes));
+    animations = std::move(shifted);
+
+    return *this;
+}
+
+ImageBuilder &ImageBuilder::replace_object(size_t index, const Object &obj)
+{
+    Rect bounds = get_object_bounds(index);
+    Object::ptr replacement = obj.clone(&edits);
 
-    objects.push_back(obj.clone());
+    if (index < rendered_count)
+        dirty = dirty.united(bounds).united(
+            replacement->get_bounds(Transform()));
+
+    objects[index] = std::move(replacement);
+    object_hashes[index] = 0;
+    animations.erase(index);
+    base_layer.reset();
 
     return *this;
 }
 
+size_t ImageBuilder::get_object_count() const
+{
+    return objects.size();
+}
+
 void ImageBuilder::render()
 {
-    if (is_rendered)
+    if (is_up_to_date() && image)
         return;
 
-    for (const unique_ptr<Object> &obj : objects)
-        obj->render(image, Coords(0, 0), ScaleFactor(1, 1));
+    trace::Span span("render", "render");
+    ObjectProfile::Activation activation(profile);
+    Stopwatch stopwatch;
+    Image &target = get_or_create_image();
+    size_t pixels_written = target.get_buffer().get_pixels_written(),
+           pixels_rejected = target.get_buffer().get_pixels_rejected(), objects_culled = 0;
+
+    if (dirty.is_empty())
+    {
+        vector<bool> is_occluded = find_occluded_objects(rendered_count);
+
+        for (size_t i = rendered_count; i < objects.size(); i++)
+            if (is_occluded[i - rendered_count])
+                objects_culled++;
+            else
+                objects[i]->render_traced(target, Transform());
+    }
+    else
+    {
+        // New objects are rendered along with the region, so that none of them is drawn twice
+        for (size_t i = rendered_count; i < objects.size(); i++)
+            dirty = dirty.united(get_object_bounds(i));
+
+        const auto &[region_written, region_rejected] = render_region(dirty);
+        pixels_written -= region_written;
+        pixels_rejected -= region_rejected;
+    }
+
+    record_render(stopwatch.elapsed(), target.get_buffer().get_pixels_written() - pixels_written,
+                  target.get_buffer().get_pixels_rejected() - pixels_rejected, objects_culled);
+
+    rendered_count = objects.size();
+    dirty = Rect();
+}
+
+map<string, size_t> ImageBuilder::count_objects() const
+{
+    map<string, size_t> counts;
+
+    for (const Object::ptr &obj : objects)
+        obj->count_objects(counts);
+
+    return counts;
+}
+
+size_t ImageBuilder::get_frame_count() const
+{
+    return frame_count;
+}
+
+const Image &ImageBuilder::get_base_layer() const
+{
+    lock_guard<mutex> lock(base_layer_mutex);
+
+    if (!base_layer)
+    {
+        trace::Span span("render", "base layer");
+        size_t static_count = animations.empty() ? objects.size() : animations.begin()->first;
+        base_layer.emplace(create_image(width, height));
+
+        ObjectProfile recorded;
+        {
+            ObjectProfile::Activation activation(profile ? &recorded : nullptr);
+            for (size_t i = 0; i < static_count; i++)
+                objects[i]->render_traced(*base_layer, Transform());
+        }
+        merge_profile(recorded);
+    }
+
+    return *base_layer;
+}
+
+void ImageBuilder::merge_profile(const ObjectProfile &recorded) const
+{
+    if (!profile)
+        return;
+
+    lock_guard<mutex> lock(profile_mutex);
+    profile->merge(recorded);
+}
+
+Image ImageBuilder::render_frame(size_t frame) const
+{
+    if (frame >= frame_count)
+        throw invalid_argument("there is no frame with number: " + to_string(frame));
+
+    trace::Span span("render", [&]()
+                     { return "frame " + to_string(frame); });
+    Image frame_image(get_base_layer());
+    // Only the animated objects whose own parameters change are copied for the frame
+    pmr::unsynchronized_pool_resource scratch;
+    size_t i = animations.empty() ? objects.size() : animations.begin()->first;
+    // Frames may be rendered in parallel, so each records its own profile first
+    ObjectProfile recorded;
+    ObjectProfile::Activation activation(profile ? &recorded : nullptr);
+
+    for (auto animation = animations.begin(); i < objects.size(); i++)
+    {
+        if (animation == animations.end() || animation->first != i)
+        {
+            objects[i]->render_traced(frame_image, Transform());
+            continue;
+        }
+
+        Object::ptr copy;
+        Transform transform;
+
+        for (const Keyframes &keyframes : animation->second)
+        {
+            if (!copy && keyframes.changes_object())
+                copy = objects[i]->clone(&scratch);
+
+            keyframes.apply(frame, copy.get(), transform);
+        }
+
+        (copy ? *copy : *objects[i]).render_traced(frame_image, transform);
+        ++animation;
+    }
+
+    merge_profile(recorded);
+    return frame_image;
+}
+
+void ImageBuilder::render_streamed(const Encoder &encoder, ostream &out, int band_height) const
+{
+    if (band_height <= 0)
+        throw invalid_argument("band height has to be a positive integer");
+
+    band_height = min(band_height, max(height, 1));
+
+    vector<Rect> bounds;
+    bounds.reserve(objects.size());
+    for (const Object::ptr &obj : objects)
+        bounds.push_back(obj->get_bounds(Transform()));
+
+    ObjectProfile::Activation activation(profile);
+    Stopwatch stopwatch;
+    Timing encode_time;
+    Image band = create_image(width, band_height);
+    unique_ptr<Encoder::RowWriter> writer =
+        band.get_buffer().has_alpha() ? encoder.open_translucent(out, width, height)
+                                      : encoder.open(out, width, height);
+    int band_count = (height + band_height - 1) / band_height;
+
+    for (int i = 0; i < band_count; i++)
+    {
+        int band_index = encoder.is_bottom_up() ? band_count - 1 - i : i,
+            band_y = band_index * band_height,
+            rows = min(band_height, height - band_y);
+
+        trace::Span band_span("render", [&]()
+                              { return "band " + to_string(band_index); });
+        band.reset(Coords(0, band_y * supersampling));
+
+        // Objects have to be rendered in their original order,
+        // so that the overlapping ones are drawn in the same way
+        Rect band_bounds(Coords(0, band_y), Coords(width, band_y + band_height));
+        for (size_t j = 0; j < objects.size(); j++)
+            if (bounds[j].intersects(band_bounds))
+                objects[j]->render_traced(band, Transform());
+
+        trace::Span encode_span("encode", "rows");
+        Stopwatch encode_stopwatch;
+        encoder.write_rows(*writer, band, rows);
+        encode_time += encode_stopwatch.elapsed();
+    }
+
+    trace::Span finish_span("encode", "finish");
+    Stopwatch encode_stopwatch;
+    writer->finish();
+    encode_time += encode_stopwatch.elapsed();
 
-    is_rendered = true;
+    // Pixels outside of each band are counted as rejected as well
+    record_render(stopwatch.elapsed() - encode_time, band.get_buffer().get_pixels_written(),
+                  band.get_buffer().get_pixels_rejected());
+    if (stats != nullptr)
+        stats->add_time("encode:" + encoder.get_name(), encode_time);
 }
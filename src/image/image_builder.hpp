@@ -7,13 +7,23 @@
 #pragma once
 
 #include "image.hpp"
+#include "keyframes.hpp"
+#include "../encoder/encoder.hpp"
+#include "../object/clipped_object.hpp"
 #include "../object/group.hpp"
 #include "../object/object.hpp"
 #include "../object/object_registry.hpp"
+#include "../profile.hpp"
+#include "../stats.hpp"
 
+#include <filesystem>
 #include <iostream>
 #include <map>
 #include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <optional>
+#include <ostream>
 #include <string>
 #include <vector>
 
@@ -23,30 +33,100 @@
  */
 class ImageBuilder
 {
-    /** Parameters for constructing an Image */
-    using image_config = std::tuple<int, int, Pixel>;
+public:
+    /** Parameters for constructing an Image and the number of frames of the animation */
+    using image_config = std::tuple<int, int, Color, size_t>;
 
-    Image image;
+    /**
+     * @brief Parse the first line of image configuration
+     *
+     * @throws std::invalid_argument If the line couldn't be parsed
+     * @param is Stream the image configuration is read from
+     * @param source Name of the source of the configuration for error messages
+     * @return image_config
+     */
+    static image_config parse_image_config(std::istream &is, const std::string &source);
+
+private:
+    /**
+     * Arena which all the parsed objects (including the contents of groups)
+     * are allocated from, it is released at once along with the builder
+     */
+    std::pmr::monotonic_buffer_resource arena;
+    /**
+     * Pool the objects added or replaced after parsing are allocated from,
+     * so that the memory of the removed and replaced ones is reused while editing
+     */
+    std::pmr::unsynchronized_pool_resource edits;
+    int width, height;
+    Color background;
+    /** Number of frames of the animation, 1 if the image isn't animated */
+    size_t frame_count = 1;
+    /** Whether the images are rendered with anti-aliased edges */
+    bool antialiased = false;
+    /** Number of samples along each axis of a pixel the images are rendered with */
+    int supersampling = 1;
+    /**
+     * The whole image, which is allocated only once it's needed,
+     * so that streamed rendering never holds the full framebuffer
+     */
+    mutable std::optional<Image> image;
     std::map<std::string, Group> groups;
-    std::vector<std::unique_ptr<Object>> objects;
-    /** Control variable to prevent re-rendering already rendered objects */
-    bool is_rendered = false;
+    /** Hashes of the contents of group definitions, including the groups they instantiate */
+    std::map<std::string, size_t> group_hashes;
+    /** Regions of the groups which clip some objects by the names of the groups */
+    std::map<std::string, std::shared_ptr<const ClipRegion>> clip_regions;
+    std::pmr::vector<Object::ptr> objects{&arena};
+    /**
+     * Hashes of the lines each object was parsed from, including the definitions of groups
+     * they instantiate, 0 for objects which weren't parsed
+     */
+    std::pmr::vector<size_t> object_hashes{&arena};
+    /** Keyframes of the animated objects by their index */
+    std::map<size_t, std::vector<Keyframes>> animations;
+    /**
+     * Objects below the first animated one rendered once and shared by all the frames,
+     * it's created by the first rendered frame
+     */
+    mutable std::optional<Image> base_layer;
+    mutable std::mutex base_layer_mutex;
+    /** Number of objects at the beginning of the list which are already rendered into the image */
+    size_t rendered_count = 0;
+    /** Region of the image which has to be rendered again from the background up */
+    Rect dirty;
+    /** Statistics to be collected, nullptr if they aren't collected */
+    Stats *stats = nullptr;
+    /** Time spent instantiating groups while parsing */
+    Timing group_resolution_time;
+    /** Profile the rendered objects are recorded into, nullptr if they aren't profiled */
+    ObjectProfile *profile = nullptr;
+    /** Stream verbose parsing errors are printed to, nullptr if they aren't printed */
+    std::ostream *err_out = &std::cerr;
+    /** Guards the profile while frames rendered in parallel add to it */
+    mutable std::mutex profile_mutex;
 
     /**
      * @brief Construct a new ImageBuilder object given the image constructor
      * parameters
      *
      * @param img_conf
+     * @param upstream Memory resource the arena allocates its blocks from
      */
-    ImageBuilder(const image_config &img_conf);
+    ImageBuilder(const image_config &img_conf, std::pmr::memory_resource *upstream);
 
     /**
-     * @brief Parse the first line of image configuration file
+     * @brief Construct a new Image Builder object by parsing the image configuration
      *
-     * @param filename File where the image config is located
-     * @return image_config
+     * @param supported_objects Registry of objects that are parseable from string
+     * @param is Stream the image configuration is read from
+     * @param source Name of the source of the configuration for error messages
+     * @param stats_ Optional statistics to collect while parsing and rendering
+     * @param upstream Memory resource the arena allocates its blocks from
+     * @param err_out_ Stream verbose parsing errors are printed to, nullptr if they aren't printed
      */
-    static image_config parse_image_config(const std::string &filename);
+    ImageBuilder(const ObjectRegistry &supported_objects, std::istream &&is,
+                 const std::string &source, Stats *stats_, std::pmr::memory_resource *upstream,
+                 std::ostream *err_out_);
 
     /**
      * @brief Parse Group object, reading multiple lines from image config
@@ -57,50 +137,290 @@ class ImageBuilder
      * @param supported_objects Registry of objects that are parseable from string
      * @param is Input stream
      * @param group_name Name of the group
+     * @param line_number Number of the last line read, incremented by each line of the group
      */
     void parse_group(const ObjectRegistry &supported_objects, std::istream &is,
-                     const std::string &group_name);
+                     const std::string &group_name, size_t &line_number);
 
     /**
      * @brief Parse all the objects from image config
      *
      * @throws std::invalid_argument If the objects couldn't be parsed
      * @param supoprted_objects Registry of objects that are parseable from string
-     * @param filename File where the image config is located
+     * @param is Stream the image configuration is read from, following its first line
+     * @param source Name of the source of the configuration for error messages
+     */
+    void parse_object_config(const ObjectRegistry &supoprted_objects, std::istream &is,
+                             const std::string &source);
+
+    /**
+     * @brief Add keyframes to the last parsed object
+     *
+     * @throws std::invalid_argument If there is no object yet, the keyframes couldn't
+     * be parsed, or the object doesn't have the parameter or it's already animated
+     * @param args Keyframes in the form "radius 0:10 30:40 59:10"
+     */
+    void parse_keyframes(const std::string &args);
+
+    /** Get the base layer shared by all the frames, rendering it first if it doesn't exist yet */
+    const Image &get_base_layer() const;
+
+    /**
+     * @brief Add a profile recorded by one of the const render paths to the builder's profile
+     *
+     * @param recorded Profile recorded on the rendering thread
+     */
+    void merge_profile(const ObjectProfile &recorded) const;
+
+    /**
+     * @brief Create a new instance of an already parsed group
+     *
+     * @throws std::invalid_argument If the instance parameters couldn't be parsed
+     * @param name Name of the group
+     * @param params Offset and scale of the instance
+     * @return Object::ptr
+     */
+    Object::ptr instantiate_group(const std::string &name, const std::string &params);
+
+    /**
+     * @brief Clip an object to the region covered by a group, the regions are shared
+     * by all the objects clipped by the same group
+     *
+     * @throws std::invalid_argument If there is no group with given name
+     * @param obj Object to be clipped
+     * @param group_name Name of the group
+     * @return Object::ptr
      */
-    void parse_object_config(const ObjectRegistry &supoprted_objects, const std::string &filename);
+    Object::ptr clip_object(Object::ptr obj, const std::string &group_name);
+
+    /**
+     * @brief Find the objects completely hidden by the opaque interiors of the objects
+     * drawn over them. The objects are walked from the top one down, collecting
+     * the largest interiors, which have to contain the bounds of a hidden object
+     *
+     * @param first Index of the first object which may be hidden
+     * @return std::vector<bool> Whether each of the objects from the first one on is hidden
+     */
+    std::vector<bool> find_occluded_objects(size_t first) const;
+
+    /** Record time, pixels and culled objects of a finished render into the statistics, if collected */
+    void record_render(const Timing &time, size_t pixels_written, size_t pixels_rejected,
+                       size_t objects_culled = 0) const;
+
+    /** Get the whole image, allocating it first if it doesn't exist yet */
+    Image &get_or_create_image() const;
+
+    /**
+     * @brief Create an image covering a part of the canvas, which is rendered
+     * anti-aliased and supersampled the same way as the whole image
+     *
+     * @param part_width Width of the part of the canvas
+     * @param part_height Height of the part of the canvas
+     * @param origin Canvas coordinates of the upper left corner of the part
+     * @return Image
+     */
+    Image create_image(int part_width, int part_height, const Coords &origin = {}) const;
+
+    /**
+     * @brief Get hash of a parsed line, combined with the hash of the definition
+     * of the group it instantiates, if it instantiates one
+     *
+     * @param line Normalized line
+     * @param cmd First word of the line
+     * @return size_t
+     */
+    size_t hash_line(const std::string &line, const std::string &cmd) const;
+
+    /**
+     * @brief Render the region of the image again from the background up,
+     * only the objects intersecting the region are rendered
+     *
+     * @param region Region of the canvas, the part outside of the image is ignored
+     * @return std::pair<size_t, size_t> Number of pixels written and rejected
+     */
+    std::pair<size_t, size_t> render_region(const Rect &region);
+
+    /** Check whether all the objects are rendered and no region has to be rendered again */
+    bool is_up_to_date() const;
+
+    /**
+     * @brief Get bounds of an object of the builder
+     *
+     * @throws std::invalid_argument If there is no object with given index
+     * @param index Index of the object
+     * @return Rect
+     */
+    Rect get_object_bounds(size_t index) const;
 
 public:
     /**
      * @brief Construct a new Image Builder object with given image configuration
      *
+     * @throws std::invalid_argument If either one of the dimensions is negative
      * @param width Width of the image
      * @param height Height of the image
-     * @param bg_color Optional background color of the image
+     * @param bg_color Optional background color of the image, which may be translucent
+     * @param upstream Memory resource the arena allocates its blocks from, which allows
+     * reusing memory of previously destroyed builders
      */
-    ImageBuilder(int width, int height, const Pixel &bg_color = {});
+    ImageBuilder(int width, int height, const Color &bg_color = {},
+                 std::pmr::memory_resource *upstream = std::pmr::get_default_resource());
 
     /**
      * @brief Construct a new Image Builder object
      *
      * @param supported_objects Registry of objects that are parseable from string
      * @param filename File where the image config is located
+     * @param stats_ Optional statistics to collect while parsing and rendering,
+     * which must outlive the builder
+     * @param err_out_ Stream verbose parsing errors are printed to, nullptr if they aren't printed
      */
-    ImageBuilder(const ObjectRegistry &supported_objects, const std::string &filename);
+    ImageBuilder(const ObjectRegistry &supported_objects, const std::string &filename,
+                 Stats *stats_ = nullptr, std::ostream *err_out_ = &std::cerr);
+
+    /**
+     * @brief Construct a new Image Builder object from image configuration read from a stream
+     *
+     * @param supported_objects Registry of objects that are parseable from string
+     * @param is Stream the image configuration is read from
+     * @param stats_ Optional statistics to collect while parsing and rendering,
+     * which must outlive the builder
+     * @param upstream Memory resource the arena allocates its blocks from, which allows
+     * reusing memory of previously destroyed builders
+     * @param err_out_ Stream verbose parsing errors are printed to, nullptr if they aren't printed
+     */
+    ImageBuilder(const ObjectRegistry &supported_objects, std::istream &is, Stats *stats_ = nullptr,
+                 std::pmr::memory_resource *upstream = std::pmr::get_default_resource(),
+                 std::ostream *err_out_ = &std::cerr);
 
     /** Image getter */
     const Image &get_image() const;
 
     /**
-     * @brief
+     * @brief Store the image directly in the memory-mapped output file, so that
+     * the objects are rendered straight into the file. It has to be called before
+     * the image is rendered
      *
-     * @param obj
+     * @throws std::invalid_argument If the file couldn't be created or opened for writing
+     * @throws std::runtime_error If the file couldn't be mapped
+     * @param encoder Encoder which will later encode the image into the file
+     * @param file Output file
+     * @return true If the image is now stored in the file, false if the image
+     * already exists, its background is translucent, it's supersampled or the format
+     * doesn't store raw pixels
+     */
+    bool map_image(const Encoder &encoder, const std::filesystem::path &file);
+
+    /**
+     * @brief Record time and pixels of each object rendered by render()
+     * or render_streamed() into the profile
+     *
+     * @param profile_ Profile which must outlive the builder, nullptr to stop profiling
+     */
+    void set_profile(ObjectProfile *profile_);
+
+    /**
+     * @brief Render the objects with anti-aliased edges, which must be set
+     * before anything is rendered. The objects are still composited one by one,
+     * so the edges shared by two objects may let the ones below show through
+     *
+     * @param antialiased_
+     */
+    void set_antialiased(bool antialiased_);
+
+    /**
+     * @brief Render the objects at a multiple of the resolution, each pixel of the encoded
+     * image is then the average of factor x factor samples. The samples are averaged while
+     * encoding the rows, so rendering in bands keeps the memory bounded. It must be set
+     * before anything is rendered
+     *
+     * @throws std::invalid_argument If the factor isn't 1, 2 or 4
+     * @param factor Number of samples along each axis of a pixel
+     */
+    void set_supersampling(int factor);
+
+    /**
+     * @brief Add a copy of the object on top of all the other objects, only the objects
+     * added since the last render are rendered by the next one
+     *
+     * @param obj Object to be added
      * @return ImageBuilder&
      */
     ImageBuilder &add_object(const Object &obj);
 
     /**
-     * @brief Render all the objects into the image
+     * @brief Remove an object, if it was already rendered, the next render renders
+     * its bounds again from the background up
+     *
+     * @throws std::invalid_argument If there is no object with given index
+     * @param index Index of the object in the order of rendering
+     * @return ImageBuilder&
+     */
+    ImageBuilder &remove_object(size_t index);
+
+    /**
+     * @brief Replace an object with a copy of another one, keeping its place in the order
+     * of rendering. If it was already rendered, the next render renders the bounds of both
+     * objects again from the background up
+     *
+     * @throws std::invalid_argument If there is no object with given index
+     * @param index Index of the object in the order of rendering
+     * @param obj Object replacing it
+     * @return ImageBuilder&
+     */
+    ImageBuilder &replace_object(size_t index, const Object &obj);
+
+    /** Get number of objects, not including the contents of groups */
+    size_t get_object_count() const;
+
+    /**
+     * @brief Bring the image up to date with the objects. Only the objects added
+     * since the last render are rendered, while the regions of removed or replaced
+     * objects are rendered again from the background up. Keyframes are ignored,
+     * the objects are rendered as they were entered
      */
     void render();
+
+    /** Get number of frames of the animation, 1 if the image isn't animated */
+    size_t get_frame_count() const;
+
+    /**
+     * @brief Render a frame of the animation into a new image. The objects below
+     * the first animated one are rendered only once into a base layer shared
+     * by all the frames, and the frames may be rendered concurrently
+     * as long as the objects aren't modified in the meantime
+     *
+     * @throws std::invalid_argument If there is no frame with given number
+     * @param frame Number of the frame
+     * @return Image
+     */
+    Image render_frame(size_t frame) const;
+
+    /**
+     * @brief Render the image by taking over the rendered image of a previous builder
+     * of the same scene, rendering again only the regions where the objects of the builders
+     * differ. Objects are matched by hashes of the lines they were parsed from, the image
+     * is rendered fully if the images differ in size or background
+     *
+     * @param previous Rendered builder, which is left without an image
+     * @return Rect Region of the canvas which was rendered again
+     */
+    Rect render_incrementally(ImageBuilder &previous);
+
+    /** Count all the objects, including the contents of groups, by their type */
+    std::map<std::string, size_t> count_objects() const;
+
+    /**
+     * @brief Render the image band by band and pass each band to the encoder
+     * as soon as it's rendered, so only a single band of pixels is kept
+     * in memory. Only objects whose bounds intersect a band are rendered into it,
+     * the encoded output is identical to encoding the fully rendered image
+     *
+     * @throws std::invalid_argument If band_height isn't positive
+     * @throws std::runtime_error If something went wrong while encoding
+     * @param encoder Encoder of the desired format
+     * @param out Output stream
+     * @param band_height Number of rows rendered at once
+     */
+    void render_streamed(const Encoder &encoder, std::ostream &out, int band_height) const;
 };
@@ -0,0 +1,173 @@
+/**
+ * @file keyframes.cpp
+ * @author Adam Berkeš <berkeada@fit.cvut.cz>
+ * @date 2026-10-19
+ */
+
+#include "keyframes.hpp"
+#include "../object/circle.hpp"
+#include "../object/clipped_object.hpp"
+#include "../object/stylable_object.hpp"
+#include "../utils.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <stdexcept>
+
+using namespace std;
+using namespace utils;
+
+Keyframes::Keyframes(const string &src, size_t frame_count)
+{
+    vector<string> args = split_str(src);
+
+    if (args.size() < 2)
+        throw invalid_argument("keyframes need a parameter and at least one keyframe: " + src);
+
+    if (args[0] == "offset")
+        parameter = Parameter::Offset;
+    else if (args[0] == "scale")
+        parameter = Parameter::Scale;
+    else if (args[0] == "color")
+        parameter = Parameter::Color;
+    else if (args[0] == "radius")
+        parameter = Parameter::Radius;
+    else
+        throw invalid_argument("parameter can't be animated: " + args[0]);
+
+    for (size_t i = 1; i < args.size(); i++)
+    {
+        const auto &[frame_str, value_str] = split_str_once(args[i], ':');
+        size_t frame;
+
+        try
+        {
+            size_t length;
+            frame = stoul(frame_str, &length);
+            if (length != frame_str.size() || frame_str[0] == '-')
+                throw invalid_argument(frame_str);
+        }
+        catch (const exception &)
+        {
+            throw invalid_argument("invalid keyframe: " + args[i]);
+        }
+
+        if (frame >= frame_count)
+            throw invalid_argument("keyframe " + args[i] + " is out of the " +
+                                   to_string(frame_count) + " frames of the animation");
+        else if (!keyframes.empty() && frame <= keyframes.back().first)
+            throw invalid_argument("keyframes have to be in increasing order: " + src);
+
+        keyframes.emplace_back(frame, parse_value(value_str));
+    }
+}
+
+Keyframes::Value Keyframes::parse_value(const string &src) const
+{
+    switch (parameter)
+    {
+    case Parameter::Offset:
+    {
+        Coords offset(src);
+        return {static_cast<double>(offset.x), static_cast<double>(offset.y), 0, 0};
+    }
+    case Parameter::Scale:
+    {
+        ScaleFactor scale(src);
+        return {scale.x, scale.y, 0, 0};
+    }
+    case Parameter::Color:
+    {
+        Color color(src);
+        return {static_cast<double>(color.r), static_cast<double>(color.g),
+                static_cast<double>(color.b), static_cast<double>(color.a)};
+    }
+    default:
+        return {static_cast<double>(extract_int_arg("radius=" + src, "radius")), 0, 0, 0};
+    }
+}
+
+Keyframes::Parameter Keyframes::get_parameter() const
+{
+    return parameter;
+}
+
+string Keyframes::get_parameter_name() const
+{
+    switch (parameter)
+    {
+    case Parameter::Offset:
+        return "offset";
+    case Parameter::Scale:
+        return "scale";
+    case Parameter::Color:
+        return "color";
+    default:
+        return "radius";
+    }
+}
+
+bool Keyframes::is_applicable(const Object &obj) const
+{
+    // Clipped objects are animated inside of their clip region, which stays in place
+    if (const auto *clipped = dynamic_cast<const ClippedObject *>(&obj))
+        return is_applicable(clipped->get_content());
+    else if (parameter == Parameter::Color)
+        return dynamic_cast<const StylableObject *>(&obj) != nullptr;
+    else if (parameter == Parameter::Radius)
+        return dynamic_cast<const Circle *>(&obj) != nullptr;
+
+    return true;
+}
+
+Keyframes::Value Keyframes::value_at(size_t frame) const
+{
+    if (frame <= keyframes.front().first)
+        return keyframes.front().second;
+    else if (frame >= keyframes.back().first)
+        return keyframes.back().second;
+
+    // Keyframes are sorted, so the first one after the frame ends the interpolated interval
+    auto next = upper_bound(keyframes.begin(), keyframes.end(), frame,
+                            [](size_t f, const pair<size_t, Value> &keyframe)
+                            { return f < keyframe.first; });
+    auto previous = prev(next);
+    double t = static_cast<double>(frame - previous->first) / (next->first - previous->first);
+    Value value;
+
+    for (size_t i = 0; i < value.size(); i++)
+        value[i] = previous->second[i] + (next->second[i] - previous->second[i]) * t;
+
+    return value;
+}
+
+bool Keyframes::changes_object() const
+{
+    return parameter == Parameter::Color || parameter == Parameter::Radius;
+}
+
+void Keyframes::apply(size_t frame, Object *obj, Transform &transform) const
+{
+    Value value = value_at(frame);
+
+    if (auto *clipped = dynamic_cast<ClippedObject *>(obj))
+        obj = &clipped->get_content();
+
+    switch (parameter)
+    {
+    case Parameter::Offset:
+        transform = transform.translated(Coords(lround(value[0]), lround(value[1])));
+        break;
+    case Parameter::Scale:
+        transform = transform * Transform::scaling(ScaleFactor(value[0], value[1]));
+        break;
+    case Parameter::Color:
+        dynamic_cast<StylableObject &>(*obj).style.color =
+            Color(lround(value[0]), lround(value[1]), lround(value[2]), lround(value[3]));
+        break;
+    case Parameter::Radius:
+        dynamic_cast<Circle &>(*obj).set_radius(lround(value[0]));
+        break;
+    }
+}
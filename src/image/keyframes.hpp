@@ -0,0 +1,103 @@
+/**
+ * @file keyframes.hpp
+ * @author Adam Berkeš <berkeada@fit.cvut.cz>
+ * @date 2026-10-19
+ */
+
+#pragma once
+
+#include "../object/object.hpp"
+
+#include <array>
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Values of a single parameter of an object at some frames of an animation.
+ * The values between two keyframes are interpolated linearly, the first value
+ * is held before the first keyframe and the last one after the last keyframe
+ */
+class Keyframes
+{
+public:
+    /** Parameter of an object which can change from frame to frame */
+    enum class Parameter
+    {
+        /** Offset added to the position of the object */
+        Offset,
+        /** Scale of the object, group instances are scaled around their offset */
+        Scale,
+        /** Color of the outline of a stylable object */
+        Color,
+        /** Radius of a circle */
+        Radius
+    };
+
+    /** Components of a value, only the first few are used by each parameter */
+    using Value = std::array<double, 4>;
+
+private:
+    Parameter parameter;
+    /** Frames in increasing order along with the values at them */
+    std::vector<std::pair<size_t, Value>> keyframes;
+
+    /**
+     * @brief Parse value of the parameter
+     *
+     * @throws std::invalid_argument If the value couldn't be parsed
+     * @param src String in the form "(x,y)" for offset and scale,
+     * a hexadecimal color, which may be translucent, for color and an integer for radius
+     * @return Value
+     */
+    Value parse_value(const std::string &src) const;
+
+public:
+    /**
+     * @brief Parse keyframes from given string
+     *
+     * @throws std::invalid_argument If the string couldn't be parsed, the frames aren't
+     * in increasing order or some of them don't belong to the animation
+     * @param src String in the form "radius 0:10 30:40 59:10", each keyframe
+     * being the number of the frame and the value at it
+     * @param frame_count Number of frames of the animation
+     */
+    Keyframes(const std::string &src, size_t frame_count);
+
+    /** Parameter getter */
+    Parameter get_parameter() const;
+
+    /** Get name of the parameter as used in image configuration, e.g. "radius" */
+    std::string get_parameter_name() const;
+
+    /**
+     * @brief Check whether the parameter can be changed for the object
+     *
+     * @param obj Object the keyframes should be applied to
+     * @return true If the object has the parameter
+     */
+    bool is_applicable(const Object &obj) const;
+
+    /**
+     * @brief Get the value at given frame
+     *
+     * @param frame Number of the frame
+     * @return Value
+     */
+    Value value_at(size_t frame) const;
+
+    /** Check whether the parameter is stored in the object, rather than applied when rendering it */
+    bool changes_object() const;
+
+    /**
+     * @brief Apply the value at given frame, offset and scale are applied to the transformation
+     * the object is rendered with, color and radius are applied to the object itself
+     *
+     * @param frame Number of the frame
+     * @param obj Copy of the object, which has to be applicable, it may be nullptr
+     * unless the keyframes change the object
+     * @param transform Transformation the object is rendered with
+     */
+    void apply(size_t frame, Object *obj, Transform &transform) const;
+};
@@ -0,0 +1,73 @@
+/**
+ * @file mapped_file.cpp
+ * @author Adam Berkeš <berkeada@fit.cvut.cz>
+ * @date 2026-10-19
+ */
+
+#include "mapped_file.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <unistd.h>
+
+using namespace std;
+
+MappedFile::MappedFile(const filesystem::path &path_, size_t size_)
+    : path(path_), size(size_)
+{
+    fd = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd == -1)
+        throw invalid_argument("failed to open file: " + path.string());
+
+    if (ftruncate(fd, size) == -1)
+    {
+        close(fd);
+        throw runtime_error("failed to resize file: " + path.string() + ": " + strerror(errno));
+    }
+
+    // Mapping zero bytes isn't allowed, an empty file has nothing to write into anyway
+    if (size == 0)
+        return;
+
+    void *mapping = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (mapping == MAP_FAILED)
+    {
+        close(fd);
+        throw runtime_error("failed to map file: " + path.string() + ": " + strerror(errno));
+    }
+
+    data = static_cast<unsigned char *>(mapping);
+}
+
+MappedFile::~MappedFile()
+{
+    if (data != nullptr)
+        munmap(data, size);
+
+    close(fd);
+}
+
+void MappedFile::sync() const
+{
+    if (data != nullptr && msync(data, size, MS_SYNC) == -1)
+        throw runtime_error("error writing file: " + path.filename().string() + ": " +
+                            strerror(errno));
+}
+
+unsigned char *MappedFile::get_data() const
+{
+    return data;
+}
+
+size_t MappedFile::get_size() const
+{
+    return size;
+}
+
+const filesystem::path &MappedFile::get_path() const
+{
+    return path;
+}
@@ -0,0 +1,57 @@
+/**
+ * @file mapped_file.hpp
+ * @author Adam Berkeš <berkeada@fit.cvut.cz>
+ * @date 2026-10-19
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+
+/**
+ * @brief Output file of fixed size mapped into memory, so that
+ * it can be written without any write system calls
+ */
+class MappedFile
+{
+    std::filesystem::path path;
+    int fd = -1;
+    unsigned char *data = nullptr;
+    size_t size;
+
+public:
+    /**
+     * @brief Create (or truncate) the file, resize it to given size
+     * and map it into memory, the contents of the file are zeroed
+     *
+     * @throws std::invalid_argument If the file couldn't be created or opened for writing
+     * @throws std::runtime_error If the file couldn't be resized or mapped
+     * @param path_ Path to the file
+     * @param size_ Size of the file in bytes
+     */
+    MappedFile(const std::filesystem::path &path_, size_t size_);
+
+    MappedFile(const MappedFile &) = delete;
+
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    /** Unmap and close the file, changes not yet synced are written back by the kernel */
+    ~MappedFile();
+
+    /**
+     * @brief Synchronously write all the changes back to the file
+     *
+     * @throws std::runtime_error If the changes couldn't be written
+     */
+    void sync() const;
+
+    /** Get pointer to the first byte of the mapped file */
+    unsigned char *get_data() const;
+
+    /** Size getter */
+    size_t get_size() const;
+
+    /** Path getter */
+    const std::filesystem::path &get_path() const;
+};
@@ -43,3 +43,41 @@ Pixel::Pixel(const string &hex_color)
     : r(get_color_from_hex(hex_color, 0)),
       g(get_color_from_hex(hex_color, 1)),
       b(get_color_from_hex(hex_color, 2)) {}
+
+Color::Color() : Color(0, 0, 0) {}
+
+Color::Color(bit8 red, bit8 green, bit8 blue, bit8 alpha) : r(red), g(green), b(blue), a(alpha) {}
+
+Color::Color(const Pixel &pixel, bit8 alpha) : Color(pixel.r, pixel.g, pixel.b, alpha) {}
+
+Color::Color(const string &hex_color) : a(255)
+{
+    // The opacity is split off, so that the rest is parsed the same way as a pixel
+    size_t length = hex_color.length(), alpha_length = length == 9 ? 2 : length == 5 ? 1 : 0;
+    string alpha = hex_color.substr(length - alpha_length);
+
+    if (!all_of(alpha.begin(), alpha.end(), [](char c)
+                { return isxdigit(c); }))
+        throw invalid_argument("invalid hex color entered: " + hex_color);
+
+    Pixel pixel;
+    try
+    {
+        pixel = Pixel(hex_color.substr(0, length - alpha_length));
+    }
+    catch (const invalid_argument &)
+    {
+        throw invalid_argument("invalid hex color entered: " + hex_color);
+    }
+
+    r = pixel.r;
+    g = pixel.g;
+    b = pixel.b;
+    if (alpha_length > 0)
+        a = stoul(alpha_length == 1 ? alpha + alpha : alpha, nullptr, 16);
+}
+
+Pixel Color::get_premultiplied() const
+{
+    return Pixel(div255(r * a), div255(g * a), div255(b * a));
+}
@@ -51,4 +51,99 @@ public:
      * @param hex_color Hexadecimal color value, valid forms are: #rrggbb or #rgb
      */
     Pixel(const std::string &hex_color);
-};
\ No newline at end of file
+
+    /** Equality comparison operator */
+    bool operator==(const Pixel &rhs) const
+    {
+        return r == rhs.r && g == rhs.g && b == rhs.b;
+    }
+
+    /** Non-equality comparison operator */
+    bool operator!=(const Pixel &rhs) const
+    {
+        return !(*this == rhs);
+    }
+};
+
+/**
+ * @brief Color of an object, which is a pixel along with its opacity ranging
+ * from 0 (fully transparent) to 255 (fully opaque). The channels are stored
+ * as they were entered, i.e. not premultiplied by the opacity
+ */
+class Color
+{
+    using bit8 = unsigned char;
+
+public:
+    bit8 r, g, b, a;
+
+    /** Construct a new Color object with default color opaque black */
+    Color();
+
+    /**
+     * @brief Construct a new Color object with the specified channels
+     *
+     * @param red
+     * @param green
+     * @param blue
+     * @param alpha
+     */
+    Color(bit8 red, bit8 green, bit8 blue, bit8 alpha = 255);
+
+    /**
+     * @brief Construct a new Color object from a pixel
+     *
+     * @param pixel Color channels
+     * @param alpha Opacity of the color
+     */
+    Color(const Pixel &pixel, bit8 alpha = 255);
+
+    /**
+     * @brief Construct a new Color object from hexadecimal value
+     *
+     * @throws std::invalid_argument invalid hexadecimal value was entered
+     * @param hex_color Hexadecimal color value, valid forms are: #rrggbbaa, #rgba,
+     * #rrggbb or #rgb, the last two of which are opaque
+     */
+    Color(const std::string &hex_color);
+
+    /** Check whether the color covers whatever is below it completely */
+    bool is_opaque() const
+    {
+        return a == 255;
+    }
+
+    /** Get the color channels without the opacity */
+    Pixel get_pixel() const
+    {
+        return Pixel(r, g, b);
+    }
+
+    /** Get the color channels premultiplied by the opacity */
+    Pixel get_premultiplied() const;
+
+    /** Equality comparison operator */
+    bool operator==(const Color &rhs) const
+    {
+        return r == rhs.r && g == rhs.g && b == rhs.b && a == rhs.a;
+    }
+
+    /** Non-equality comparison operator */
+    bool operator!=(const Color &rhs) const
+    {
+        return !(*this == rhs);
+    }
+};
+
+/**
+ * @brief Divide a product of two channels by 255, rounding it to the nearest integer
+ *
+ * @param product Value from 0 to 255 * 255
+ * @return unsigned
+ */
+inline unsigned div255(unsigned product)
+{
+    product += 128;
+
+    return (product + (product >> 8)) >> 8;
+}
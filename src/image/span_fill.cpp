@@ -0,0 +1,378 @@
+/**
+ * @file span_fill.cpp
+ * @author Adam Berkeš <berkeada@fit.cvut.cz>
+ * @date 2026-10-19
+ */
+
+#include "span_fill.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SPAN_FILL_X86
+#include <immintrin.h>
+#endif
+
+static_assert(sizeof(Pixel) == 3 && alignof(Pixel) == 1,
+              "span kernels expect tightly packed 3-byte pixels");
+
+namespace
+{
+    /**
+     * Spans at least this long (in bytes) are written with non-temporal stores,
+     * since they would only evict useful data from the cache
+     */
+    const size_t STREAMING_THRESHOLD = 4 * 1024 * 1024;
+
+    void fill_scalar(Pixel *dst, size_t count, const Pixel &color)
+    {
+        for (size_t i = 0; i < count; i++)
+            dst[i] = color;
+    }
+
+    void blend_scalar(Pixel *dst, size_t count, const Pixel &color, unsigned char alpha)
+    {
+        unsigned inverse = 255 - alpha;
+
+        for (size_t i = 0; i < count; i++)
+            dst[i] = Pixel(color.r + div255(dst[i].r * inverse),
+                           color.g + div255(dst[i].g * inverse),
+                           color.b + div255(dst[i].b * inverse));
+    }
+
+    /** Add up the bytes at the same positions of all the rows */
+    void sum_rows_scalar(const unsigned char *const *rows, size_t row_count, size_t length,
+                         uint16_t *sums)
+    {
+        for (size_t i = 0; i < length; i++)
+            sums[i] = rows[0][i];
+
+        for (size_t r = 1; r < row_count; r++)
+            for (size_t i = 0; i < length; i++)
+                sums[i] += rows[r][i];
+    }
+
+#ifdef SPAN_FILL_X86
+    /**
+     * @brief Write whole pixels until dst is aligned to given boundary, which
+     * is always reachable in less than `alignment` pixels, since 3 is coprime
+     * with any power of two
+     *
+     * @return Number of pixels written
+     */
+    size_t fill_until_aligned(Pixel *dst, size_t count, const Pixel &color, uintptr_t alignment)
+    {
+        size_t written = 0;
+
+        while (written < count && reinterpret_cast<uintptr_t>(dst + written) % alignment != 0)
+            dst[written++] = color;
+
+        return written;
+    }
+
+    /**
+     * @brief Build the 48-byte pattern of 16 pixels, split into three registers,
+     * each of which holds the color rotated by one more byte than the previous one
+     */
+    __attribute__((target("sse2"))) void fill_sse2(Pixel *dst, size_t count, const Pixel &color)
+    {
+        alignas(16) unsigned char pattern[48];
+        for (size_t i = 0; i < sizeof(pattern); i += 3)
+            memcpy(pattern + i, &color, 3);
+
+        size_t head = fill_until_aligned(dst, count, color, 16);
+        unsigned char *out = reinterpret_cast<unsigned char *>(dst + head);
+        size_t blocks = (count - head) / 16;
+        const __m128i p0 = _mm_load_si128(reinterpret_cast<const __m128i *>(pattern)),
+                      p1 = _mm_load_si128(reinterpret_cast<const __m128i *>(pattern + 16)),
+                      p2 = _mm_load_si128(reinterpret_cast<const __m128i *>(pattern + 32));
+
+        if (blocks * sizeof(pattern) >= STREAMING_THRESHOLD)
+        {
+            for (size_t i = 0; i < blocks; i++, out += sizeof(pattern))
+            {
+                _mm_stream_si128(reinterpret_cast<__m128i *>(out), p0);
+                _mm_stream_si128(reinterpret_cast<__m128i *>(out + 16), p1);
+                _mm_stream_si128(reinterpret_cast<__m128i *>(out + 32), p2);
+            }
+
+            _mm_sfence();
+        }
+        else
+            for (size_t i = 0; i < blocks; i++, out += sizeof(pattern))
+            {
+                _mm_store_si128(reinterpret_cast<__m128i *>(out), p0);
+                _mm_store_si128(reinterpret_cast<__m128i *>(out + 16), p1);
+                _mm_store_si128(reinterpret_cast<__m128i *>(out + 32), p2);
+            }
+
+        fill_scalar(reinterpret_cast<Pixel *>(out), count - head - blocks * 16, color);
+    }
+
+    /** Divide each of the 16-bit products by 255 the same way as div255() */
+    __attribute__((target("sse2"))) __m128i div255_epi16(__m128i product)
+    {
+        product = _mm_add_epi16(product, _mm_set1_epi16(128));
+
+        return _mm_srli_epi16(_mm_add_epi16(product, _mm_srli_epi16(product, 8)), 8);
+    }
+
+    /**
+     * @brief Blend 16 pixels at a time, the channels are blended independently,
+     * so the span is processed as bytes and the color as the same 48-byte pattern
+     * as in fill_sse2
+     */
+    __attribute__((target("sse2"))) void blend_sse2(Pixel *dst, size_t count, const Pixel &color,
+                                                    unsigned char alpha)
+    {
+        alignas(16) unsigned char pattern[48];
+        for (size_t i = 0; i < sizeof(pattern); i += 3)
+            memcpy(pattern + i, &color, 3);
+
+        unsigned char *out = reinterpret_cast<unsigned char *>(dst);
+        size_t blocks = count / 16;
+        const __m128i zero = _mm_setzero_si128(), inverse = _mm_set1_epi16(255 - alpha);
+        const __m128i p[3] = {_mm_load_si128(reinterpret_cast<const __m128i *>(pattern)),
+                              _mm_load_si128(reinterpret_cast<const __m128i *>(pattern + 16)),
+                              _mm_load_si128(reinterpret_cast<const __m128i *>(pattern + 32))};
+
+        for (size_t i = 0; i < blocks; i++, out += sizeof(pattern))
+            for (int k = 0; k < 3; k++)
+            {
+                __m128i *bytes = reinterpret_cast<__m128i *>(out + 16 * k);
+                __m128i d = _mm_loadu_si128(bytes),
+                        lo = div255_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(d, zero), inverse)),
+                        hi = div255_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(d, zero), inverse));
+
+                _mm_storeu_si128(bytes, _mm_adds_epu8(_mm_packus_epi16(lo, hi), p[k]));
+            }
+
+        blend_scalar(reinterpret_cast<Pixel *>(out), count - blocks * 16, color, alpha);
+    }
+
+    /** Add up 16 bytes of all the rows at a time, widened to 16 bits */
+    __attribute__((target("sse2"))) void sum_rows_sse2(const unsigned char *const *rows,
+                                                       size_t row_count, size_t length,
+                                                       uint16_t *sums)
+    {
+        const __m128i zero = _mm_setzero_si128();
+        size_t blocks = length / 16;
+
+        for (size_t i = 0; i < blocks * 16; i += 16)
+        {
+            __m128i lo = zero, hi = zero;
+
+            for (size_t r = 0; r < row_count; r++)
+            {
+                __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i *>(rows[r] + i));
+                lo = _mm_add_epi16(lo, _mm_unpacklo_epi8(d, zero));
+                hi = _mm_add_epi16(hi, _mm_unpackhi_epi8(d, zero));
+            }
+
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(sums + i), lo);
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(sums + i + 8), hi);
+        }
+
+        for (size_t i = blocks * 16; i < length; i++)
+        {
+            sums[i] = 0;
+            for (size_t r = 0; r < row_count; r++)
+                sums[i] += rows[r][i];
+        }
+    }
+
+    /** Same as fill_sse2, but with the 96-byte pattern of 32 pixels */
+    __attribute__((target("avx2"))) void fill_avx2(Pixel *dst, size_t count, const Pixel &color)
+    {
+        alignas(32) unsigned char pattern[96];
+        for (size_t i = 0; i < sizeof(pattern); i += 3)
+            memcpy(pattern + i, &color, 3);
+
+        size_t head = fill_until_aligned(dst, count, color, 32);
+        unsigned char *out = reinterpret_cast<unsigned char *>(dst + head);
+        size_t blocks = (count - head) / 32;
+        const __m256i p0 = _mm256_load_si256(reinterpret_cast<const __m256i *>(pattern)),
+                      p1 = _mm256_load_si256(reinterpret_cast<const __m256i *>(pattern + 32)),
+                      p2 = _mm256_load_si256(reinterpret_cast<const __m256i *>(pattern + 64));
+
+        if (blocks * sizeof(pattern) >= STREAMING_THRESHOLD)
+        {
+            for (size_t i = 0; i < blocks; i++, out += sizeof(pattern))
+            {
+                _mm256_stream_si256(reinterpret_cast<__m256i *>(out), p0);
+                _mm256_stream_si256(reinterpret_cast<__m256i *>(out + 32), p1);
+                _mm256_stream_si256(reinterpret_cast<__m256i *>(out + 64), p2);
+            }
+
+            _mm_sfence();
+        }
+        else
+            for (size_t i = 0; i < blocks; i++, out += sizeof(pattern))
+            {
+                _mm256_store_si256(reinterpret_cast<__m256i *>(out), p0);
+                _mm256_store_si256(reinterpret_cast<__m256i *>(out + 32), p1);
+                _mm256_store_si256(reinterpret_cast<__m256i *>(out + 64), p2);
+            }
+
+        fill_scalar(reinterpret_cast<Pixel *>(out), count - head - blocks * 32, color);
+    }
+
+    /** Same as div255_epi16, but with 16 products at a time */
+    __attribute__((target("avx2"))) __m256i div255_epi16(__m256i product)
+    {
+        product = _mm256_add_epi16(product, _mm256_set1_epi16(128));
+
+        return _mm256_srli_epi16(_mm256_add_epi16(product, _mm256_srli_epi16(product, 8)), 8);
+    }
+
+    /**
+     * @brief Same as blend_sse2, but with the 96-byte pattern of 32 pixels. Unpacking
+     * and packing both work within 128-bit lanes, so the order of the bytes is kept
+     */
+    __attribute__((target("avx2"))) void blend_avx2(Pixel *dst, size_t count, const Pixel &color,
+                                                    unsigned char alpha)
+    {
+        alignas(32) unsigned char pattern[96];
+        for (size_t i = 0; i < sizeof(pattern); i += 3)
+            memcpy(pattern + i, &color, 3);
+
+        unsigned char *out = reinterpret_cast<unsigned char *>(dst);
+        size_t blocks = count / 32;
+        const __m256i zero = _mm256_setzero_si256(), inverse = _mm256_set1_epi16(255 - alpha);
+        const __m256i p[3] = {_mm256_load_si256(reinterpret_cast<const __m256i *>(pattern)),
+                              _mm256_load_si256(reinterpret_cast<const __m256i *>(pattern + 32)),
+                              _mm256_load_si256(reinterpret_cast<const __m256i *>(pattern + 64))};
+
+        for (size_t i = 0; i < blocks; i++, out += sizeof(pattern))
+            for (int k = 0; k < 3; k++)
+            {
+                __m256i *bytes = reinterpret_cast<__m256i *>(out + 32 * k);
+                __m256i d = _mm256_loadu_si256(bytes),
+                        lo = div255_epi16(_mm256_mullo_epi16(_mm256_unpacklo_epi8(d, zero), inverse)),
+                        hi = div255_epi16(_mm256_mullo_epi16(_mm256_unpackhi_epi8(d, zero), inverse));
+
+                _mm256_storeu_si256(bytes, _mm256_adds_epu8(_mm256_packus_epi16(lo, hi), p[k]));
+            }
+
+        blend_scalar(reinterpret_cast<Pixel *>(out), count - blocks * 32, color, alpha);
+    }
+
+    /** Same as sum_rows_sse2, but with 32 bytes at a time */
+    __attribute__((target("avx2"))) void sum_rows_avx2(const unsigned char *const *rows,
+                                                       size_t row_count, size_t length,
+                                                       uint16_t *sums)
+    {
+        size_t blocks = length / 32;
+
+        for (size_t i = 0; i < blocks * 32; i += 32)
+        {
+            __m256i lo = _mm256_setzero_si256(), hi = _mm256_setzero_si256();
+
+            for (size_t r = 0; r < row_count; r++)
+            {
+                lo = _mm256_add_epi16(lo, _mm256_cvtepu8_epi16(_mm_loadu_si128(
+                                              reinterpret_cast<const __m128i *>(rows[r] + i))));
+                hi = _mm256_add_epi16(hi, _mm256_cvtepu8_epi16(_mm_loadu_si128(
+                                              reinterpret_cast<const __m128i *>(rows[r] + i + 16))));
+            }
+
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(sums + i), lo);
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(sums + i + 16), hi);
+        }
+
+        for (size_t i = blocks * 32; i < length; i++)
+        {
+            sums[i] = 0;
+            for (size_t r = 0; r < row_count; r++)
+                sums[i] += rows[r][i];
+        }
+    }
+#endif
+
+    using fill_kernel = void (*)(Pixel *, size_t, const Pixel &);
+    using blend_kernel = void (*)(Pixel *, size_t, const Pixel &, unsigned char);
+    using sum_rows_kernel = void (*)(const unsigned char *const *, size_t, size_t, uint16_t *);
+
+    struct Kernel
+    {
+        fill_kernel fill;
+        blend_kernel blend;
+        sum_rows_kernel sum_rows;
+        const char *name;
+    };
+
+    Kernel select_kernel()
+    {
+#ifdef SPAN_FILL_X86
+        __builtin_cpu_init();
+
+        if (__builtin_cpu_supports("avx2"))
+            return {fill_avx2, blend_avx2, sum_rows_avx2, "avx2"};
+        if (__builtin_cpu_supports("sse2"))
+            return {fill_sse2, blend_sse2, sum_rows_sse2, "sse2"};
+#endif
+        return {fill_scalar, blend_scalar, sum_rows_scalar, "scalar"};
+    }
+
+    const Kernel &get_kernel()
+    {
+        static const Kernel kernel = select_kernel();
+
+        return kernel;
+    }
+}
+
+void span_fill::fill(Pixel *dst, size_t count, const Pixel &color)
+{
+    // Short spans are not worth the alignment prologue
+    if (count < 64)
+        fill_scalar(dst, count, color);
+    else
+        get_kernel().fill(dst, count, color);
+}
+
+void span_fill::blend(Pixel *dst, size_t count, const Pixel &premultiplied, unsigned char alpha)
+{
+    if (alpha == 255)
+        fill(dst, count, premultiplied);
+    else if (alpha == 0)
+        return;
+    else if (count < 16)
+        blend_scalar(dst, count, premultiplied, alpha);
+    else
+        get_kernel().blend(dst, count, premultiplied, alpha);
+}
+
+void span_fill::downsample(const unsigned char *const *rows, size_t factor, size_t channels,
+                           size_t count, unsigned char *dst)
+{
+    // Memory of the sums is reused by the following rows
+    thread_local std::vector<uint16_t> sums;
+    size_t length = count * factor * channels, shift = 0;
+    sums.resize(length);
+
+    // The rows are added up by the kernel, the neighbouring samples are then added
+    // up channel by channel and divided by the size of the block, a power of two
+    get_kernel().sum_rows(rows, factor, length, sums.data());
+    while ((size_t(1) << shift) < factor * factor)
+        shift++;
+
+    for (size_t i = 0; i < count; i++)
+        for (size_t c = 0; c < channels; c++)
+        {
+            const uint16_t *block = sums.data() + i * factor * channels + c;
+            unsigned sum = 0;
+
+            for (size_t j = 0; j < factor; j++)
+                sum += block[j * channels];
+
+            dst[i * channels + c] = (sum + (1u << shift >> 1)) >> shift;
+        }
+}
+
+const char *span_fill::get_kernel_name()
+{
+    return get_kernel().name;
+}
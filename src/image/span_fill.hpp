@@ -0,0 +1,53 @@
+/**
+ * @file span_fill.hpp
+ * @author Adam Berkeš <berkeada@fit.cvut.cz>
+ * @date 2026-10-19
+ */
+
+#pragma once
+
+#include "pixel.hpp"
+
+#include <cstddef>
+
+namespace span_fill
+{
+    /**
+     * @brief Fill a contiguous span of pixels with a solid color. The kernel
+     * (AVX2, SSE2 or scalar) is chosen once at runtime based on what the CPU supports
+     *
+     * @param dst First pixel of the span
+     * @param count Number of pixels in the span
+     * @param color Color to fill the span with
+     */
+    void fill(Pixel *dst, size_t count, const Pixel &color);
+
+    /**
+     * @brief Composite a translucent color over a contiguous span of pixels using
+     * the source-over operator, i.e. each channel becomes color + dst * (255 - alpha) / 255.
+     * Opaque colors are filled right away without reading the span
+     *
+     * @param dst First pixel of the span
+     * @param count Number of pixels in the span
+     * @param premultiplied Color premultiplied by its opacity
+     * @param alpha Opacity of the color
+     */
+    void blend(Pixel *dst, size_t count, const Pixel &premultiplied, unsigned char alpha);
+
+    /**
+     * @brief Average blocks of factor x factor samples into single samples, e.g. to scale
+     * down a supersampled image. Each sample consists of given number of byte channels,
+     * which are averaged independently. The rows are added up by the kernel
+     *
+     * @param rows Pointers to factor rows of count * factor samples each
+     * @param factor Number of samples along each axis of a block, a power of two up to 16
+     * @param channels Number of bytes of each sample, e.g. 3 for pixels and 1 for opacity
+     * @param count Number of blocks
+     * @param dst Destination for count samples
+     */
+    void downsample(const unsigned char *const *rows, size_t factor, size_t channels,
+                    size_t count, unsigned char *dst);
+
+    /** Get name of the kernel selected for this CPU, e.g. "avx2" */
+    const char *get_kernel_name();
+}
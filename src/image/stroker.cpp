@@ -0,0 +1,193 @@
+/**
+ * @file stroker.cpp
+ * @author Adam Berkeš <berkeada@fit.cvut.cz>
+ * @date 2026-10-19
+ */
+
+#include "stroker.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+/** Segments shorter than this are skipped, as they have no direction */
+constexpr double MIN_SEGMENT_LENGTH = 1e-9;
+
+Stroker::Stroker(CoverageAccumulator &coverage_, double width, LineJoin join_, LineCap cap_)
+    : coverage(coverage_), half_width(width / 2), join(join_), cap(cap_) {}
+
+void Stroker::add_piece(const Point *vertices, size_t count)
+{
+    const Point *first = vertices, *last = vertices + count - 1;
+    double area = 0;
+
+    for (const Point *vertex = first; vertex != last; vertex++)
+        area += vertex->x * (vertex + 1)->y - (vertex + 1)->x * vertex->y;
+    area += last->x * first->y - first->x * last->y;
+
+    if (area >= 0)
+    {
+        for (const Point *vertex = first; vertex != last; vertex++)
+            coverage.add_edge(*vertex, *(vertex + 1));
+        coverage.add_edge(*last, *first);
+    }
+    else
+    {
+        for (const Point *vertex = last; vertex != first; vertex--)
+            coverage.add_edge(*vertex, *(vertex - 1));
+        coverage.add_edge(*first, *last);
+    }
+}
+
+void Stroker::add_piece(initializer_list<Point> vertices)
+{
+    add_piece(vertices.begin(), vertices.size());
+}
+
+void Stroker::segment_to(const Point &point, LineJoin segment_join)
+{
+    double length = hypot(point.x - current.x, point.y - current.y);
+    if (length < MIN_SEGMENT_LENGTH)
+        return;
+
+    Point unit((point.x - current.x) / length, (point.y - current.y) / length),
+        normal(-unit.y * half_width, unit.x * half_width);
+
+    if (has_segment)
+        add_join(current, direction, unit, segment_join);
+    else
+        start_direction = unit;
+
+    add_piece({current + normal, point + normal, point - normal, current - normal});
+    current = point;
+    direction = unit;
+    has_segment = true;
+}
+
+void Stroker::add_join(const Point &vertex, const Point &from, const Point &to,
+                       LineJoin corner_join)
+{
+    double cross = from.x * to.y - from.y * to.x, dot = from.x * to.x + from.y * to.y;
+
+    // Segments going straight on need no corner
+    if (abs(cross) < MIN_SEGMENT_LENGTH && dot > 0)
+        return;
+
+    if (corner_join == LineJoin::Round)
+    {
+        coverage.add_ellipse(vertex, half_width, half_width);
+        return;
+    }
+
+    // The corner sticks out on the side the path turns away from
+    double side = cross > 0 ? -half_width : half_width;
+    Point outer_from = vertex + Point(-from.y * side, from.x * side),
+          outer_to = vertex + Point(-to.y * side, to.x * side);
+
+    // Ratio of the length of the miter to the width is 1 / sin(angle / 2),
+    // where the angle is the one between the segments
+    if (corner_join == LineJoin::Miter && dot > -1 && sqrt(2 / (1 + dot)) <= MITER_LIMIT)
+    {
+        Point tip = vertex + Point((-from.y - to.y) * side / (1 + dot),
+                                   (from.x + to.x) * side / (1 + dot));
+        add_piece({vertex, outer_from, tip, outer_to});
+    }
+    else
+        add_piece({vertex, outer_from, outer_to});
+}
+
+void Stroker::add_cap(const Point &end, const Point &outwards)
+{
+    if (cap == LineCap::Round)
+        coverage.add_ellipse(end, half_width, half_width);
+    else if (cap == LineCap::Square)
+    {
+        Point normal(-outwards.y * half_width, outwards.x * half_width),
+            extension(outwards.x * half_width, outwards.y * half_width);
+        add_piece({end + normal, end + normal + extension, end - normal + extension,
+                   end - normal});
+    }
+}
+
+void Stroker::move_to(const Point &point)
+{
+    finish();
+    start = current = point;
+}
+
+void Stroker::line_to(const Point &point)
+{
+    segment_to(point, join);
+}
+
+void Stroker::quad_to(const Point &control, const Point &end)
+{
+    // Chords of n equal steps deviate from the curve by at most |P0 - 2 * P1 + P2| / (4 * n^2)
+    Point start_point = current, chord = end - start_point,
+          from = control - start_point, to = end - control;
+    double deviation = hypot(start_point.x - 2 * control.x + end.x,
+                             start_point.y - 2 * control.y + end.y);
+    int steps = max(1, static_cast<int>(ceil(sqrt(deviation / (4 * FLATTEN_TOLERANCE)))));
+
+    if (hypot(chord.x, chord.y) < MIN_SEGMENT_LENGTH && hypot(from.x, from.y) < MIN_SEGMENT_LENGTH)
+        return;
+
+    // The left side of the outline goes forward and the right side back
+    outline.resize(2 * (steps + 1));
+    for (int i = 0; i <= steps; i++)
+    {
+        double t = static_cast<double>(i) / steps, u = 1 - t;
+        Point point(u * u * start_point.x + 2 * u * t * control.x + t * t * end.x,
+                    u * u * start_point.y + 2 * u * t * control.y + t * t * end.y),
+            tangent(u * from.x + t * to.x, u * from.y + t * to.y);
+
+        // Control points coinciding with an end make the tangent vanish there,
+        // curves turning back on themselves make it vanish at their tip
+        double length = hypot(tangent.x, tangent.y);
+        if (length < MIN_SEGMENT_LENGTH)
+        {
+            tangent = hypot(chord.x, chord.y) < MIN_SEGMENT_LENGTH ? direction : chord;
+            length = hypot(tangent.x, tangent.y);
+        }
+
+        Point unit(tangent.x / length, tangent.y / length),
+            normal(-unit.y * half_width, unit.x * half_width);
+
+        if (i == 0 && has_segment)
+            add_join(current, direction, unit, join);
+        else if (i == 0)
+            start_direction = unit;
+
+        outline[i] = point + normal;
+        outline[outline.size() - 1 - i] = point - normal;
+        direction = unit;
+    }
+
+    add_piece(outline.data(), outline.size());
+    current = end;
+    has_segment = true;
+}
+
+void Stroker::close()
+{
+    if (has_segment)
+    {
+        segment_to(start, join);
+        add_join(start, direction, start_direction, join);
+    }
+
+    has_segment = false;
+    current = start;
+}
+
+void Stroker::finish()
+{
+    if (has_segment)
+    {
+        add_cap(start, Point(-start_direction.x, -start_direction.y));
+        add_cap(current, direction);
+    }
+
+    has_segment = false;
+}
@@ -0,0 +1,122 @@
+/**
+ * @file stroker.hpp
+ * @author Adam Berkeš <berkeada@fit.cvut.cz>
+ * @date 2026-10-19
+ */
+
+#pragma once
+
+#include "coverage.hpp"
+
+#include <initializer_list>
+#include <vector>
+
+/** Shape of the corners where two segments of a stroked path meet */
+enum class LineJoin
+{
+    /** Outer edges extended until they meet, beveled if the corner is too sharp */
+    Miter,
+    Round,
+    /** Corner cut off by a straight edge */
+    Bevel
+};
+
+/** Shape of the ends of an open stroked path */
+enum class LineCap
+{
+    /** Stroke ends exactly at the end of the path */
+    Butt,
+    Round,
+    /** Stroke extends by half of its width beyond the end of the path */
+    Square
+};
+
+/** Maximum ratio of the length of a miter to the width of the stroke, sharper corners are beveled */
+constexpr double MITER_LIMIT = 4;
+
+/**
+ * @brief Stroker turning paths into outlines added into a coverage accumulator,
+ * which then fills the whole stroke at once.
+ *
+ * Each segment is added as a rectangle and each corner as a small piece
+ * given by the join, all of them going in the same direction. The overlapping
+ * pieces are thus merged into a single outline by the non-zero winding rule,
+ * so the joins neither leave gaps nor cover any pixel twice
+ */
+class Stroker
+{
+    CoverageAccumulator &coverage;
+    double half_width;
+    LineJoin join;
+    LineCap cap;
+    /** First point of the current subpath and direction of its first segment */
+    Point start, start_direction;
+    /** Last point of the current subpath and direction of its last segment */
+    Point current, direction;
+    /** Whether the current subpath has at least one segment */
+    bool has_segment = false;
+    /** Storage reused for the outlines of the curves */
+    std::vector<Point> outline;
+
+    /** Add a polygon, reversed if needed so that all the pieces go in the same direction */
+    void add_piece(const Point *vertices, size_t count);
+
+    /** Add a convex polygon, reversed if needed so that all the pieces go in the same direction */
+    void add_piece(std::initializer_list<Point> vertices);
+
+    /** Add a segment going from the current point to the point, joined by given join */
+    void segment_to(const Point &point, LineJoin segment_join);
+
+    /**
+     * @brief Add the corner between two segments
+     *
+     * @param vertex Point where the segments meet
+     * @param from Unit direction of the first segment
+     * @param to Unit direction of the second segment
+     * @param corner_join Shape of the corner
+     */
+    void add_join(const Point &vertex, const Point &from, const Point &to, LineJoin corner_join);
+
+    /**
+     * @brief Add the cap at an end of an open subpath
+     *
+     * @param end End of the subpath
+     * @param outwards Unit direction pointing away from the subpath
+     */
+    void add_cap(const Point &end, const Point &outwards);
+
+public:
+    /**
+     * @brief Construct a new Stroker object
+     *
+     * @param coverage_ Accumulator the outlines of the strokes are added into
+     * @param width Width of the stroke
+     * @param join_ Shape of the corners
+     * @param cap_ Shape of the ends of open subpaths
+     */
+    Stroker(CoverageAccumulator &coverage_, double width, LineJoin join_ = LineJoin::Miter,
+            LineCap cap_ = LineCap::Butt);
+
+    /** Finish the current subpath and start a new one at the point */
+    void move_to(const Point &point);
+
+    /** Add a straight segment from the current point to the point */
+    void line_to(const Point &point);
+
+    /**
+     * @brief Add a quadratic Bézier curve from the current point, flattened into
+     * straight segments lying at most a small fraction of a pixel away from the curve.
+     * The curve is added as a single outline offset along its normals on both sides,
+     * so its cost follows the length of the curve rather than the number of segments
+     *
+     * @param control Control point of the curve
+     * @param end End of the curve
+     */
+    void quad_to(const Point &control, const Point &end);
+
+    /** Close the current subpath by a segment going back to its first point */
+    void close();
+
+    /** Finish the current subpath, adding the caps to its ends unless it's closed */
+    void finish();
+};
@@ -18,6 +18,8 @@
 #include "object/curve.hpp"
 #include "object/spiral.hpp"
 #include "object/regular_polygon.hpp"
+#include "object/path.hpp"
+#include "object/polyline.hpp"
 
 #include <iostream>
 #include <stdexcept>
@@ -41,7 +43,9 @@ int main(int argc, char *argv[])
         .add("polygon", Polygon::parse_from_str)
         .add("curve", Curve::parse_from_str)
         .add("spiral", Spiral::parse_from_str)
-        .add("regular_polygon", RegularPolygon::parse_from_str);
+        .add("regular_polygon", RegularPolygon::parse_from_str)
+        .add("path", Path::parse_from_str)
+        .add("polyline", Polyline::parse_from_str);
 
     try
     {
@@ -5,8 +5,12 @@
  */
 
 #include "circle.hpp"
+#include "ellipse.hpp"
+#include "../image/coverage.hpp"
 #include "../utils.hpp"
 
+#include <cmath>
+
 using namespace std;
 using namespace utils;
 
@@ -14,9 +18,8 @@ Circle::Circle(const StylableObject::Style &style_, Coords center_, int radius_)
     : StylableObject(style_), center(center_), radius(radius_) {}
 
 void Circle::draw_octants(Image &image, const Coords &c, const Coords &d,
-                          int x_shit, int y_shift) const
+                          const Color &color, int x_shit, int y_shift)
 {
-    const Pixel &color = style.color;
     int x0 = c.x, y0 = c.y,
         x = d.x, y = d.y;
 
@@ -30,7 +33,7 @@ void Circle::draw_octants(Image &image, const Coords &c, const Coords &d,
     image.get_buffer().set_pixel((y + x_shit) + x0, -(x + y_shift) + y0, color);
 }
 
-void Circle::draw_circle(Image &image, int x0, int y0, int r) const
+void Circle::draw_circle(Image &image, int x0, int y0, int r, const Color &color)
 {
     int x = 0,
         y = r,
@@ -38,11 +41,11 @@ void Circle::draw_circle(Image &image, int x0, int y0, int r) const
 
     while (x <= y)
     {
-        draw_octants(image, Coords(x0, y0), Coords(x, y));
+        draw_octants(image, Coords(x0, y0), Coords(x, y), color);
 
         // Fix for dead pixels in thicc circles
         if (x - y < 1)
-            draw_octants(image, Coords(x0, y0), Coords(x, y), 1, 0);
+            draw_octants(image, Coords(x0, y0), Coords(x, y), color, 1, 0);
 
         if (d < 0)
             d += 4 * x + 6;
@@ -56,28 +59,109 @@ void Circle::draw_circle(Image &image, int x0, int y0, int r) const
     }
 }
 
-unique_ptr<Object>
-Circle::clone() const
+Object::ptr Circle::clone(pmr::memory_resource *resource) const
+{
+    return Object::make<Circle>(resource, *this);
+}
+
+void Circle::render(Image &image, const Transform &transform) const
+{
+    // Circles scaled non-uniformly or skewed become ellipses
+    if (!transform.is_conformal())
+    {
+        EllipseAxes axes = transform.transform_ellipse(radius, radius);
+        Ellipse::rasterize(image, transform.map(center), axes.radius_x, axes.radius_y,
+                           style.width, style.color, axes.rotation);
+        return;
+    }
+
+    ScaleFactor scale = transform.get_scale();
+
+    rasterize(image, transform.map(center), radius * ((abs(scale.x) + abs(scale.y)) / 2),
+              style.width, style.color);
+}
+
+string Circle::get_name() const
 {
-    return make_unique<Circle>(*this);
+    return "circle";
 }
 
-void Circle::render(Image &image, const Coords &offset,
-                    const ScaleFactor &scale) const
+Rect Circle::get_bounds(const Transform &transform) const
 {
-    int x0 = (scale.x * center.x) + offset.x,
-        y0 = (scale.y * center.y) + offset.y,
-        r = radius * ((abs(scale.x) + abs(scale.y)) / 2);
+    Coords c = transform.map(center);
+
+    if (!transform.is_conformal())
+    {
+        Vec2<double> extent = transform.transform_ellipse(radius, radius).get_extent();
+        Coords r(ceil(extent.x) + style.width + 2, ceil(extent.y) + style.width + 2);
+
+        return Rect(c - r, c + r + Coords(1, 1));
+    }
+
+    ScaleFactor scale = transform.get_scale();
+    int r = radius * ((abs(scale.x) + abs(scale.y)) / 2);
+
+    return Rect::around(c, c, abs(r) + style.width / 2 + 2);
+}
 
-    for (int i = -(style.width / 2); i <= style.width / 2; i++)
-        draw_circle(image, x0, y0, r + i);
+Rect Circle::get_opaque_interior(const Transform &transform) const
+{
+    if (!style.color.is_opaque() || !transform.is_conformal())
+        return Rect();
+
+    // Only the circles whose ring reaches their center are filled discs
+    ScaleFactor scale = transform.get_scale();
+    int r = radius * ((abs(scale.x) + abs(scale.y)) / 2);
+    if (r < 0 || r - style.width / 2 > 0)
+        return Rect();
+
+    // Largest square inside of the disc, whose outermost pixels may be covered only partially
+    int half_side = floor((r + style.width / 2 - 1) / M_SQRT2) - 1;
+    if (half_side < 0)
+        return Rect();
+
+    Coords c = transform.map(center);
+
+    return Rect::around(c, c, half_side);
+}
+
+void Circle::rasterize(Image &image, const Coords &canvas_center, int radius,
+                       int width, const Color &color)
+{
+    // Supersampled images are drawn in the coordinates of their samples
+    Coords center = image.to_samples(canvas_center);
+    radius *= image.get_supersampling();
+    width *= image.get_supersampling();
+
+    if (image.is_antialiased())
+    {
+        // The ring covers the same radii as the aliased circles drawn for each pixel of width
+        Point c(center.x + 0.5, center.y + 0.5);
+        double outer = radius + width / 2 + 0.5, inner = radius - width / 2 - 0.5;
+        CoverageAccumulator &coverage = CoverageAccumulator::get(image.get_bounds());
+
+        coverage.add_ellipse(c, outer, outer);
+        if (inner > 0)
+            coverage.add_ellipse(c, inner, inner, true);
+        coverage.fill(image, color);
+
+        return;
+    }
+
+    for (int i = -(width / 2); i <= width / 2; i++)
+        draw_circle(image, center.x, center.y, radius + i, color);
+}
+
+void Circle::set_radius(int radius_)
+{
+    radius = radius_;
 }
 
-unique_ptr<Object> Circle::parse_from_str(const string &src)
+Object::ptr Circle::parse_from_str(const string &src, pmr::memory_resource *resource)
 {
     const auto &[center_str, params_str] = split_str_once(src);
     const auto &[radius_str, style_str] = split_str_once(params_str);
 
-    return make_unique<Circle>(Circle(StylableObject::Style(style_str),
-                                      Coords(center_str), extract_int_arg(radius_str, "radius")));
+    return Object::make<Circle>(resource, StylableObject::Style(style_str),
+                                Coords(center_str), extract_int_arg(radius_str, "radius"));
 }
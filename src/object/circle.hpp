@@ -22,11 +22,12 @@ class Circle : public StylableObject
      * @param image Image where the octants should be drawn
      * @param c Center
      * @param d Displacement
+     * @param color Color of the circle
      * @param x_shift X-axis shift
      * @param y_shit Y-axis shift
      */
-    void draw_octants(Image &image, const Coords &c, const Coords &d,
-                      int x_shift = 0, int y_shit = 0) const;
+    static void draw_octants(Image &image, const Coords &c, const Coords &d,
+                             const Color &color, int x_shift = 0, int y_shit = 0);
 
     /**
      * @brief Draw a circle using modified Bresenham's circle drawing algorithm
@@ -35,8 +36,9 @@ class Circle : public StylableObject
      * @param x0 X-coordinate of the center
      * @param y0 Y-coordinate of the center
      * @param r Radius
+     * @param color Color of the circle
      */
-    void draw_circle(Image &image, int x0, int y0, int r) const;
+    static void draw_circle(Image &image, int x0, int y0, int r, const Color &color);
 
 public:
     /**
@@ -48,27 +50,53 @@ public:
      */
     Circle(const StylableObject::Style &style_, Coords center_, int radius_);
 
-    std::unique_ptr<Object> clone() const override;
+    Object::ptr clone(std::pmr::memory_resource *resource) const override;
 
     /**
-     * @brief Render circle with given offset and scale into image
+     * @brief Render circle with given transformation into image
      * using modified Bresenham's circle drawing algorithm. Thicker circles are
-     * rendered using concentric circles where the radii get incrementally smaller
+     * rendered using concentric circles where the radii get incrementally smaller.
+     * Transformations which don't keep the shape, e.g. non-uniform scales, turn
+     * the circle into an ellipse, which is rendered the same way as Ellipse
      *
      * <a href="https://en.wikipedia.org/wiki/Midpoint_circle_algorithm">Alogrithm reference</a>
      * <a href="https://www.javatpoint.com/computer-graphics-bresenhams-circle-algorithm">Another reference</a>
      * @param image Image the circle should be rendered into
-     * @param offset Offset from the origin (0,0)
-     * @param scale Scale of the circle
+     * @param transform Transformation of the circle into the image
      */
-    void render(Image &image, const Coords &offset, const ScaleFactor &scale) const override;
+    void render(Image &image, const Transform &transform) const override;
+
+    Rect get_bounds(const Transform &transform) const override;
+
+    Rect get_opaque_interior(const Transform &transform) const override;
+
+    std::string get_name() const override;
+
+    /** Radius setter */
+    void set_radius(int radius_);
+
+    /**
+     * @brief Rasterize a circle whose center and radius are already in image coordinates,
+     * as a ring filled with anti-aliased edges if the image is anti-aliased
+     *
+     * @param image Image the circle should be rendered into
+     * @param center Center of the circle
+     * @param radius Radius of the circle
+     * @param width Thickness of the outline
+     * @param color Color of the outline
+     */
+    static void rasterize(Image &image, const Coords &center, int radius,
+                          int width, const Color &color);
 
     /**
      * @brief Parse circle from given string
      *
      * @throws std::invalid_argument If the string couldn't be parsed
      * @param src String in the form "(100,100) radius=50 width=5 color=#fff"
-     * @return std::unique_ptr<Object>
+     * @param resource Memory resource the object should be allocated from
+     * @return Object::ptr
      */
-    static std::unique_ptr<Object> parse_from_str(const std::string &src);
+    static Object::ptr parse_from_str(const std::string &src,
+                                      std::pmr::memory_resource *resource =
+                                          std::pmr::get_default_resource());
 };
@@ -0,0 +1,108 @@
+/**
+ * @file clipped_object.cpp
+ * @author Adam Berkeš <berkeada@fit.cvut.cz>
+ * @date 2026-10-19
+ */
+
+#include "clipped_object.hpp"
+
+#include <algorithm>
+
+using namespace std;
+
+/** Number of the rows of the canvas a clip mask is rendered in at once */
+constexpr int MASK_STRIP_HEIGHT = 32;
+
+ClipRegion::ClipRegion(const Object &mask_object_, const Rect &canvas)
+    : mask_object(mask_object_.clone(pmr::get_default_resource())),
+      bounds(mask_object->get_bounds(Transform()).intersected(canvas)) {}
+
+const ClipMask &ClipRegion::get_mask(const Image &image) const
+{
+    int samples = image.get_supersampling();
+    lock_guard<mutex> lock(masks_mutex);
+    auto [mask, inserted] = masks.try_emplace(make_pair(samples, image.is_antialiased()));
+
+    if (inserted && !bounds.is_empty())
+    {
+        // The mask is rendered over a transparent background, so that its pixels are
+        // told apart by their opacity whatever their color is. It's rendered strip
+        // by strip, so that only its spans are kept rather than the whole bitmap
+        int strip_height = min(bounds.get_height(), MASK_STRIP_HEIGHT) * samples,
+            bottom = bounds.max.y * samples;
+        Image strip(bounds.get_width() * samples, strip_height, Color(0, 0, 0, 0),
+                    Coords(bounds.min.x * samples, bounds.min.y * samples));
+        strip.set_antialiased(image.is_antialiased());
+        strip.set_supersampling(samples);
+
+        for (int y = bounds.min.y * samples; y < bottom; y += strip_height)
+        {
+            strip.reset(Coords(bounds.min.x * samples, y));
+            mask_object->render(strip, Transform());
+            mask->second.append_alpha(strip, min(strip_height, bottom - y));
+        }
+    }
+
+    return mask->second;
+}
+
+const Rect &ClipRegion::get_bounds() const
+{
+    return bounds;
+}
+
+ClippedObject::ClippedObject(Object::ptr content_, shared_ptr<const ClipRegion> region_)
+    : content(std::move(content_)), region(std::move(region_)) {}
+
+ClippedObject::ClippedObject(const ClippedObject &src, pmr::memory_resource *resource)
+    : Object(src), content(src.content->clone(resource)), region(src.region) {}
+
+Object::ptr ClippedObject::clone(pmr::memory_resource *resource) const
+{
+    return Object::make<ClippedObject>(resource, *this, resource);
+}
+
+const Object &ClippedObject::get_content() const
+{
+    return *content;
+}
+
+Object &ClippedObject::get_content()
+{
+    return *content;
+}
+
+void ClippedObject::render(Image &image, const Transform &transform) const
+{
+    auto &buffer = image.get_buffer();
+    const ClipMask *previous = buffer.get_clip();
+
+    buffer.set_clip(&region->get_mask(image));
+    content->render(image, transform);
+    buffer.set_clip(previous);
+}
+
+Rect ClippedObject::get_bounds(const Transform &transform) const
+{
+    return content->get_bounds(transform).intersected(region->get_bounds());
+}
+
+string ClippedObject::get_name() const
+{
+    return content->get_name();
+}
+
+string ClippedObject::get_label() const
+{
+    return content->get_label();
+}
+
+string ClippedObject::get_definition_name() const
+{
+    return content->get_definition_name();
+}
+
+void ClippedObject::count_objects(map<string, size_t> &counts) const
+{
+    content->count_objects(counts);
+}
@@ -0,0 +1,105 @@
+/**
+ * @file clipped_object.hpp
+ * @author Adam Berkeš <berkeada@fit.cvut.cz>
+ * @date 2026-10-19
+ */
+
+#pragma once
+
+#include "object.hpp"
+#include "../image/clip_mask.hpp"
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+/**
+ * @brief Region of the canvas covered by an object, usually a group, which clips
+ * other objects. Its mask is rendered only once for each resolution the clipped
+ * objects are rendered in and shared by all of them. The mask is rendered in strips
+ * of a few rows, so that no bitmap of the whole region is ever allocated
+ */
+class ClipRegion
+{
+    Object::ptr mask_object;
+    /** Part of the canvas the mask is rendered in */
+    Rect bounds;
+    mutable std::mutex masks_mutex;
+    /** Masks by the supersampling factor and anti-aliasing of the images they were rendered for */
+    mutable std::map<std::pair<int, bool>, ClipMask> masks;
+
+public:
+    /**
+     * @brief Construct a new Clip Region object
+     *
+     * @param mask_object_ Object whose pixels form the region, it's copied
+     * @param canvas Part of the canvas the region is limited to
+     */
+    ClipRegion(const Object &mask_object_, const Rect &canvas);
+
+    /**
+     * @brief Get the mask for the resolution of the image, rendering it first if it
+     * doesn't exist yet. It may be called by multiple threads at once
+     *
+     * @param image Image the clipped objects are rendered into
+     * @return const ClipMask&
+     */
+    const ClipMask &get_mask(const Image &image) const;
+
+    /** Get the part of the canvas the region may cover */
+    const Rect &get_bounds() const;
+};
+
+/**
+ * @brief Object rendered only inside of a clip region, the rest of its pixels is rejected
+ */
+class ClippedObject : public Object
+{
+    Object::ptr content;
+    std::shared_ptr<const ClipRegion> region;
+
+public:
+    /**
+     * @brief Construct a new Clipped Object object
+     *
+     * @param content_ Object which is clipped
+     * @param region_ Region the object is clipped to
+     */
+    ClippedObject(Object::ptr content_, std::shared_ptr<const ClipRegion> region_);
+
+    /**
+     * @brief Construct a new Clipped Object object by copying src, allocating
+     * the copy of the clipped object from given memory resource
+     *
+     * @param src Object to be copied
+     * @param resource Memory resource the clipped object should be allocated from
+     */
+    ClippedObject(const ClippedObject &src, std::pmr::memory_resource *resource);
+
+    Object::ptr clone(std::pmr::memory_resource *resource) const override;
+
+    /** Get the object which is clipped */
+    const Object &get_content() const;
+
+    /** Get the object which is clipped */
+    Object &get_content();
+
+    /**
+     * @brief Render the object into image, limiting the drawing to the mask of the region
+     *
+     * @param image Image the object should be rendered into
+     * @param transform Transformation of the object into the image, the region isn't transformed
+     */
+    void render(Image &image, const Transform &transform) const override;
+
+    Rect get_bounds(const Transform &transform) const override;
+
+    std::string get_name() const override;
+
+    std::string get_label() const override;
+
+    std::string get_definition_name() const override;
+
+    void count_objects(std::map<std::string, size_t> &counts) const override;
+};
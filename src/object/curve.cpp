@@ -5,9 +5,11 @@
  */
 
 #include "curve.hpp"
+#include "../image/coverage.hpp"
 #include "../utils.hpp"
 
 #include <cmath>
+#include <vector>
 
 using namespace std;
 using namespace utils;
@@ -15,16 +17,58 @@ using namespace utils;
 Curve::Curve(const StylableObject::Style &style_, const array<Coords, 3> &control_points_)
     : StylableObject(style_), control_points(control_points_) {}
 
-unique_ptr<Object> Curve::clone() const
+Object::ptr Curve::clone(pmr::memory_resource *resource) const
 {
-    return make_unique<Curve>(*this);
+    return Object::make<Curve>(resource, *this);
 }
 
-void Curve::render(Image &image, const Coords &offset, const ScaleFactor &scale) const
+void Curve::render(Image &image, const Transform &transform) const
 {
+    array<Coords, 3> points;
+
+    for (size_t i = 0; i < points.size(); i++)
+        points[i] = transform.map(control_points[i]);
+
+    rasterize(image, points, style.width, style.color);
+}
+
+string Curve::get_name() const
+{
+    return "curve";
+}
+
+Rect Curve::get_bounds(const Transform &transform) const
+{
+    Rect bounds;
+
+    // The curve always lies inside of the convex hull of its control points
+    for (const Coords &point : control_points)
+    {
+        Coords p = transform.map(point);
+        bounds = bounds.united(Rect::around(p, p, style.width + 1));
+    }
+
+    return bounds;
+}
+
+void Curve::rasterize(Image &image, const array<Coords, 3> &canvas_points,
+                      int width, const Color &color)
+{
+    // Supersampled images are drawn in the coordinates of their samples
+    array<Coords, 3> points;
+    for (size_t i = 0; i < points.size(); i++)
+        points[i] = image.to_samples(canvas_points[i]);
+    width *= image.get_supersampling();
+
+    if (image.is_antialiased())
+    {
+        rasterize_antialiased(image, points, width, color);
+        return;
+    }
+
     const double T_INC = 0.001;
-    int width_half = style.width / 2,
-        width_end = width_half - 1 + (style.width % 2);
+    int width_half = width / 2,
+        width_end = width_half - 1 + (width % 2);
     // Standard quadratic Bezier curve equation
     auto curve_fn = [&](double t, int x0, int x1, int x2)
     {
@@ -34,13 +78,8 @@ void Curve::render(Image &image, const Coords &offset, const ScaleFactor &scale)
     // Draw separate curve for each pixel of width
     for (int i = -width_half; i <= width_end; i++)
     {
-
-        int x0 = (scale.x * control_points[0].x) + offset.x,
-            x1 = (scale.x * control_points[1].x) + offset.x,
-            x2 = (scale.x * control_points[2].x) + offset.x,
-            y0 = (scale.y * control_points[0].y) + offset.y,
-            y1 = (scale.y * control_points[1].y) + offset.y,
-            y2 = (scale.y * control_points[2].y) + offset.y;
+        int x0 = points[0].x, x1 = points[1].x, x2 = points[2].x,
+            y0 = points[0].y, y1 = points[1].y, y2 = points[2].y;
 
         if (abs(x2 - x0) < abs(y2 - y0))
         {
@@ -67,7 +106,7 @@ void Curve::render(Image &image, const Coords &offset, const ScaleFactor &scale)
 
         while (t < 1)
         {
-            image.get_buffer().set_pixel(x, y, style.color);
+            image.get_buffer().set_pixel(x, y, color);
             t += T_INC;
             x = curve_fn(t, x0, x1, x2);
             y = curve_fn(t, y0, y1, y2);
@@ -75,12 +114,57 @@ void Curve::render(Image &image, const Coords &offset, const ScaleFactor &scale)
     }
 }
 
-unique_ptr<Object> Curve::parse_from_str(const string &src)
+void Curve::rasterize_antialiased(Image &image, const array<Coords, 3> &points,
+                                  int width, const Color &color)
+{
+    const double TOLERANCE = 0.1;
+    Point p0(points[0].x + 0.5, points[0].y + 0.5), p1(points[1].x + 0.5, points[1].y + 0.5),
+        p2(points[2].x + 0.5, points[2].y + 0.5);
+    // Chords of n equal steps of t deviate from the curve by at most |p0 - 2p1 + p2| / 4n^2
+    double bend = hypot(p0.x - 2 * p1.x + p2.x, p0.y - 2 * p1.y + p2.y);
+    int count = max(1, static_cast<int>(ceil(sqrt(bend / (4 * TOLERANCE)))));
+    vector<Point> left, right;
+    left.reserve(count + 1);
+    right.reserve(count + 1);
+
+    // The curve is flattened and stroked into a single outline, the left side
+    // goes forward and the right side back, so that the segments leave no gaps
+    for (int i = 0; i <= count; i++)
+    {
+        double t = static_cast<double>(i) / count;
+        Point point = Point((1 - t) * (1 - t), (1 - t) * (1 - t)) * p0 +
+                      Point(2 * (1 - t) * t, 2 * (1 - t) * t) * p1 + Point(t * t, t * t) * p2,
+              tangent = Point(1 - t, 1 - t) * (p1 - p0) + Point(t, t) * (p2 - p1);
+
+        // Control points coinciding with an endpoint make the tangent vanish there
+        if (tangent == Point())
+            tangent = p2 - p0;
+
+        double length = hypot(tangent.x, tangent.y);
+        if (length == 0)
+            return;
+
+        Point normal(-tangent.y * width / 2 / length, tangent.x * width / 2 / length);
+        left.push_back(point + normal);
+        right.push_back(point - normal);
+    }
+
+    CoverageAccumulator &coverage = CoverageAccumulator::get(image.get_bounds());
+    coverage.move_to(left.front());
+    for (size_t i = 1; i < left.size(); i++)
+        coverage.line_to(left[i]);
+    for (size_t i = right.size(); i-- > 0;)
+        coverage.line_to(right[i]);
+    coverage.close();
+    coverage.fill(image, color);
+}
+
+Object::ptr Curve::parse_from_str(const string &src, pmr::memory_resource *resource)
 {
     const auto &[position_str, style_str] = split_str_once(src);
     vector<Coords> control_points = parse_vertices(position_str, 3, 3);
 
-    return make_unique<Curve>(
-        Curve(StylableObject::Style(style_str),
-              array{control_points[0], control_points[1], control_points[2]}));
+    return Object::make<Curve>(
+        resource, StylableObject::Style(style_str),
+        array{control_points[0], control_points[1], control_points[2]});
 }
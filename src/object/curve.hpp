@@ -19,6 +19,13 @@ class Curve : public StylableObject
     /** Array of 3 control points P0 through P2 */
     std::array<Coords, 3> control_points;
 
+    /**
+     * @brief Rasterize the curve flattened into a polyline
+     * and stroked into a single anti-aliased outline
+     */
+    static void rasterize_antialiased(Image &image, const std::array<Coords, 3> &points,
+                                      int width, const Color &color);
+
 public:
     /**
      * @brief Construct a new Curve object given its style and control points
@@ -28,25 +35,43 @@ public:
      */
     Curve(const StylableObject::Style &style_, const std::array<Coords, 3> &control_points_);
 
-    std::unique_ptr<Object> clone() const override;
+    Object::ptr clone(std::pmr::memory_resource *resource) const override;
 
     /**
-     * @brief Render the curve into image with given offset and scale
+     * @brief Render the curve into image with given transformation
      * using standard equation for quadratic Bézier curve:
      * B(t) = (1 - t)^2 * [(1 - t) * P0 + t * P1] + t * [(1 - t) * P1 + t * P2], t ∈ <0,1>
      *
      * @param image Image the curve should be rendered into
-     * @param offset Offset from the origin (0,0)
-     * @param scale Scale of the curve
+     * @param transform Transformation of the curve into the image
+     */
+    void render(Image &image, const Transform &transform) const override;
+
+    Rect get_bounds(const Transform &transform) const override;
+
+    std::string get_name() const override;
+
+    /**
+     * @brief Rasterize a curve whose control points are already in image coordinates,
+     * with anti-aliased edges if the image is anti-aliased
+     *
+     * @param image Image the curve should be rendered into
+     * @param points Control points P0 through P2
+     * @param width Thickness of the curve
+     * @param color Color of the curve
      */
-    void render(Image &image, const Coords &offset, const ScaleFactor &scale) const override;
+    static void rasterize(Image &image, const std::array<Coords, 3> &points,
+                          int width, const Color &color);
 
     /**
      * @brief Parse the curve form given string
      *
      * @throws std::invalid_argument If the string couldn't be parsed
      * @param src String in the form "((100,100);(150,50);(200,100)) width=5 color=#edc"
-     * @return std::unique_ptr<Object>
+     * @param resource Memory resource the object should be allocated from
+     * @return Object::ptr
      */
-    static std::unique_ptr<Object> parse_from_str(const std::string &src);
+    static Object::ptr parse_from_str(const std::string &src,
+                                      std::pmr::memory_resource *resource =
+                                          std::pmr::get_default_resource());
 };
@@ -4,8 +4,8 @@
  * @date 2023-05-31
  */
 
-#include "curve.hpp"
 #include "ellipse.hpp"
+#include "../image/coverage.hpp"
 #include "../utils.hpp"
 
 #include <cmath>
@@ -17,31 +17,155 @@ Ellipse::Ellipse(const StylableObject::Style &style_, const Coords &center_,
                  int radius_x_, int radius_y_)
     : StylableObject(style_), center(center_), radius_x(radius_x_), radius_y(radius_y_) {}
 
-unique_ptr<Object> Ellipse::clone() const
+Object::ptr Ellipse::clone(pmr::memory_resource *resource) const
 {
-    return make_unique<Ellipse>(*this);
+    return Object::make<Ellipse>(resource, *this);
 }
 
-void Ellipse::render(Image &image, const Coords &offset, const ScaleFactor &scale) const
+void Ellipse::render(Image &image, const Transform &transform) const
 {
-    int width_half = style.width / 2,
-        width_end = width_half - 1 + (style.width % 2);
-    auto draw_points = [&](const double &x, const double &y)
+    EllipseAxes axes = transform.transform_ellipse(radius_x, radius_y);
+
+    rasterize(image, transform.map(center), axes.radius_x, axes.radius_y, style.width,
+              style.color, axes.rotation);
+}
+
+string Ellipse::get_name() const
+{
+    return "ellipse";
+}
+
+Rect Ellipse::get_bounds(const Transform &transform) const
+{
+    Vec2<double> extent = transform.transform_ellipse(radius_x, radius_y).get_extent();
+    Coords c = transform.map(center),
+        r(ceil(extent.x) + style.width + 2, ceil(extent.y) + style.width + 2);
+
+    return Rect(c - r, c + r + Coords(1, 1));
+}
+
+void Ellipse::fill_rotated(Image &image, const Coords &center, const EllipseAxes &axes,
+                           int width, const Color &color)
+{
+    int width_half = width / 2,
+        width_end = width_half - 1 + (width % 2);
+    double cos_rotation = cos(axes.rotation), sin_rotation = sin(axes.rotation);
+
+    // Pixels whose centers lie between the same radii as the aliased ellipses drawn
+    // for each pixel of width. Both boundaries are conics a * x^2 + b * x * y + c * y^2 = 1
+    struct Conic
+    {
+        double a, b, c;
+    };
+    auto conic = [&](double r_x, double r_y)
+    {
+        double r_x_2 = r_x * r_x, r_y_2 = r_y * r_y;
+
+        return Conic{cos_rotation * cos_rotation / r_x_2 + sin_rotation * sin_rotation / r_y_2,
+                     2 * cos_rotation * sin_rotation * (1 / r_x_2 - 1 / r_y_2),
+                     sin_rotation * sin_rotation / r_x_2 + cos_rotation * cos_rotation / r_y_2};
+    };
+    // Get the interval of X coordinates of the conic in the row, relative to its center
+    auto roots = [](const Conic &boundary, double y, double &from, double &to)
+    {
+        double discriminant = boundary.b * boundary.b * y * y -
+                              4 * boundary.a * (boundary.c * y * y - 1);
+
+        if (discriminant < 0)
+            return false;
+
+        from = (-boundary.b * y - sqrt(discriminant)) / (2 * boundary.a);
+        to = (-boundary.b * y + sqrt(discriminant)) / (2 * boundary.a);
+
+        return true;
+    };
+
+    EllipseAxes outer_axes{abs(axes.radius_x) + width_end + 0.5,
+                           abs(axes.radius_y) + width_end + 0.5, axes.rotation};
+    double inner_x = abs(axes.radius_x) - width_half - 0.5,
+           inner_y = abs(axes.radius_y) - width_half - 0.5;
+    bool has_inner = inner_x > 0 && inner_y > 0;
+    Conic outer = conic(outer_axes.radius_x, outer_axes.radius_y),
+          inner = has_inner ? conic(inner_x, inner_y) : Conic{0, 0, 0};
+
+    auto fill = [&](int from, int to, int y)
+    {
+        if (from <= to)
+            image.get_buffer().fill_span(center.x + from, y, to - from + 1, color);
+    };
+
+    Rect bounds = image.get_bounds();
+    int extent = ceil(outer_axes.get_extent().y),
+        top = max(center.y - extent, bounds.min.y),
+        bottom = min(center.y + extent + 1, bounds.max.y);
+
+    for (int y = top; y < bottom; y++)
     {
-        int x_scaled = (scale.x * center.x) + offset.x,
-            y_scaled = (scale.y * center.y) + offset.y;
+        double outer_from, outer_to, inner_from, inner_to;
 
-        image.get_buffer().set_pixel(x_scaled + x, y_scaled + y, style.color);
-        image.get_buffer().set_pixel(x_scaled - x, y_scaled + y, style.color);
-        image.get_buffer().set_pixel(x_scaled - x, y_scaled - y, style.color);
-        image.get_buffer().set_pixel(x_scaled + x, y_scaled - y, style.color);
+        if (!roots(outer, y - center.y, outer_from, outer_to))
+            continue;
+
+        int left = ceil(outer_from), right = floor(outer_to);
+
+        // Pixels strictly inside of the inner boundary form the hole of the outline
+        if (has_inner && roots(inner, y - center.y, inner_from, inner_to) &&
+            floor(inner_from) + 1 <= ceil(inner_to) - 1)
+        {
+            fill(left, min(right, static_cast<int>(floor(inner_from))), y);
+            fill(max(left, static_cast<int>(ceil(inner_to))), right, y);
+        }
+        else
+            fill(left, right, y);
+    }
+}
+
+void Ellipse::rasterize(Image &image, const Coords &canvas_center, double radius_x,
+                        double radius_y, int width, const Color &color, double rotation)
+{
+    // Supersampled images are drawn in the coordinates of their samples
+    Coords center = image.to_samples(canvas_center);
+    radius_x *= image.get_supersampling();
+    radius_y *= image.get_supersampling();
+    width *= image.get_supersampling();
+
+    int width_half = width / 2,
+        width_end = width_half - 1 + (width % 2);
+
+    if (image.is_antialiased())
+    {
+        // The ring covers the same radii as the aliased ellipses drawn for each pixel of width
+        Point c(center.x + 0.5, center.y + 0.5);
+        double r_x = abs(radius_x), r_y = abs(radius_y);
+        CoverageAccumulator &coverage = CoverageAccumulator::get(image.get_bounds());
+
+        coverage.add_ellipse(c, r_x + width_end + 0.5, r_y + width_end + 0.5, false, rotation);
+        if (r_x - width_half - 0.5 > 0 && r_y - width_half - 0.5 > 0)
+            coverage.add_ellipse(c, r_x - width_half - 0.5, r_y - width_half - 0.5, true,
+                                 rotation);
+        coverage.fill(image, color);
+
+        return;
+    }
+    else if (rotation != 0)
+    {
+        fill_rotated(image, center, {radius_x, radius_y, rotation}, width, color);
+        return;
+    }
+
+    auto draw_points = [&](const double &x, const double &y)
+    {
+        image.get_buffer().set_pixel(center.x + x, center.y + y, color);
+        image.get_buffer().set_pixel(center.x - x, center.y + y, color);
+        image.get_buffer().set_pixel(center.x - x, center.y - y, color);
+        image.get_buffer().set_pixel(center.x + x, center.y - y, color);
     };
 
     // For each pixel of width, one ellipse is rendered
     for (int i = -width_half; i <= width_end; i++)
     {
-        double r_x = (radius_x * scale.x) + i, r_x_2 = r_x * r_x,
-               r_y = (radius_y * scale.y) + i, r_y_2 = r_y * r_y,
+        double r_x = radius_x + i, r_x_2 = r_x * r_x,
+               r_y = radius_y + i, r_y_2 = r_y * r_y,
                x = 0, y = r_y,
                d1 = r_y_2 - r_x_2 * (r_y + 0.25), d2;
 
@@ -91,14 +215,14 @@ void Ellipse::render(Image &image, const Coords &offset, const ScaleFactor &scal
     }
 }
 
-unique_ptr<Object> Ellipse::parse_from_str(const string &src)
+Object::ptr Ellipse::parse_from_str(const string &src, pmr::memory_resource *resource)
 {
     const auto &[center_str, params_str] = split_str_once(src);
     const auto &[radius_x_str, params_rest] = split_str_once(params_str);
     const auto &[radius_y_str, style_str] = split_str_once(params_rest);
 
-    return make_unique<Ellipse>(
-        Ellipse(StylableObject::Style(style_str), Coords(center_str),
-                extract_int_arg(radius_x_str, "radius_x"),
-                extract_int_arg(radius_y_str, "radius_y")));
+    return Object::make<Ellipse>(
+        resource, StylableObject::Style(style_str), Coords(center_str),
+        extract_int_arg(radius_x_str, "radius_x"),
+        extract_int_arg(radius_y_str, "radius_y"));
 }
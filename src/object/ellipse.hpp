@@ -16,6 +16,20 @@ class Ellipse : public StylableObject
     Coords center;
     int radius_x, radius_y;
 
+    /**
+     * @brief Fill a rotated ellipse row by row. Each row of the outline consists
+     * of at most two spans, given by the roots of the quadratic equations
+     * of the outer and the inner boundary of the outline in that row
+     *
+     * @param image Image the ellipse should be rendered into
+     * @param center Center of the ellipse
+     * @param axes Radii and rotation of the ellipse
+     * @param width Thickness of the outline
+     * @param color Color of the outline
+     */
+    static void fill_rotated(Image &image, const Coords &center, const EllipseAxes &axes,
+                             int width, const Color &color);
+
 public:
     /**
      * @brief Construct a new Ellipse object with given parameters
@@ -28,26 +42,48 @@ public:
     Ellipse(const StylableObject::Style &style_, const Coords &center_,
             int radius_x_, int radius_y_);
 
-    std::unique_ptr<Object> clone() const override;
+    Object::ptr clone(std::pmr::memory_resource *resource) const override;
 
     /**
      * @brief Render ellipse using modified midpoint ellipse drawing algorithm. Thicker ellipses
-     * are rendered using concentric ellipses where the radii get incrementally smaller
+     * are rendered using concentric ellipses where the radii get incrementally smaller.
+     * Ellipses which are rotated or skewed by the transformation are filled span by span
      *
      * <a href="https://en.wikipedia.org/wiki/Midpoint_circle_algorithm">Algorithm reference</a>
      * <a href="https://www.javatpoint.com/computer-graphics-midpoint-ellipse-algorithm">Another Reference</a>
      * @param image Image the ellipse should be rendered into
-     * @param offset Offset from the origin (0,0)
-     * @param scale Scale of the ellipse
+     * @param transform Transformation of the ellipse into the image
+     */
+    void render(Image &image, const Transform &transform) const override;
+
+    Rect get_bounds(const Transform &transform) const override;
+
+    std::string get_name() const override;
+
+    /**
+     * @brief Rasterize an ellipse whose center and radii are already in image coordinates,
+     * as a ring filled with anti-aliased edges if the image is anti-aliased
+     *
+     * @param image Image the ellipse should be rendered into
+     * @param center Center of the ellipse
+     * @param radius_x X-axis radius
+     * @param radius_y Y-axis radius
+     * @param width Thickness of the outline
+     * @param color Color of the outline
+     * @param rotation Rotation of the X-axis radius in radians, clockwise on the image
      */
-    void render(Image &image, const Coords &offset, const ScaleFactor &scale) const override;
+    static void rasterize(Image &image, const Coords &center, double radius_x,
+                          double radius_y, int width, const Color &color, double rotation = 0);
 
     /**
      * @brief Parse the ellipse from given string
      *
      * @throws std::invalid_argument If the string couldn't be parsed
      * @param src String in the form "(100,100) radius_x=100 radius_y=50 width=3 color=#dddddd"
-     * @return std::unique_ptr<Object>
+     * @param resource Memory resource the object should be allocated from
+     * @return Object::ptr
      */
-    static std::unique_ptr<Object> parse_from_str(const std::string &src);
+    static Object::ptr parse_from_str(const std::string &src,
+                                      std::pmr::memory_resource *resource =
+                                          std::pmr::get_default_resource());
 };
@@ -7,64 +7,153 @@
 #include "group.hpp"
 #include "../utils.hpp"
 
+#include <cmath>
+#include <sstream>
+
 using namespace std;
 using namespace utils;
 
-Group::Group() = default;
-
-Group::Group(const Coords &offset_, const ScaleFactor &scale_,
-             const list<unique_ptr<Object>> &objects_)
-    : offset(offset_), scale(scale_)
+/**
+ * @brief Parse an angle in degrees
+ *
+ * @throws std::invalid_argument If the string isn't a finite number
+ */
+static double parse_angle(const string &src)
 {
-    for (const unique_ptr<Object> &obj : objects_)
-        objects.push_back(obj->clone());
+    stringstream is(src);
+    double degrees;
+
+    if (!(is >> degrees) || is.rdbuf()->in_avail() || !isfinite(degrees))
+        throw invalid_argument("error parsing angle: " + src);
+
+    return degrees;
 }
 
-Group::Group(const Group &src)
+Group::Group(pmr::memory_resource *resource) : objects(resource), name(resource) {}
+
+Group::Group(const Coords &offset_, const Transform &transform_,
+             const pmr::list<Object::ptr> &objects_, pmr::memory_resource *resource)
+    : offset(offset_), transform(transform_), objects(resource), name(resource)
 {
-    offset = src.offset;
-    scale = src.scale;
+    for (const Object::ptr &obj : objects_)
+        objects.push_back(obj->clone(resource));
+}
 
-    for (const unique_ptr<Object> &obj : src.objects)
-        objects.push_back(obj->clone());
+Group::Group(const Group &src) : Group(src, src.objects.get_allocator().resource()) {}
+
+Group::Group(const Group &src, pmr::memory_resource *resource)
+    : Object(src), offset(src.offset), transform(src.transform), objects(resource),
+      name(src.name, resource)
+{
+    for (const Object::ptr &obj : src.objects)
+        objects.push_back(obj->clone(resource));
 }
 
+Group::Group(Group &&src) noexcept = default;
+
 Group::~Group() = default;
 
-unique_ptr<Object> Group::clone() const
+Object::ptr Group::clone(pmr::memory_resource *resource) const
+{
+    return Object::make<Group>(resource, *this, resource);
+}
+
+void Group::render(Image &image, const Transform &parent_transform) const
+{
+    Transform composed = (parent_transform * transform).translated(offset);
+
+    for (const Object::ptr &obj : objects)
+        obj->render_traced(image, composed);
+}
+
+string Group::get_name() const
 {
-    return make_unique<Group>(*this);
+    return "group";
 }
 
-void Group::render(Image &image, const Coords &parent_offset,
-                   const ScaleFactor &parent_scale) const
+string Group::get_label() const
 {
-    for (const unique_ptr<Object> &obj : objects)
-        obj->render(image, offset + parent_offset, scale * parent_scale);
+    return name.empty() ? get_name() : get_name() + ' ' + string(name);
+}
+
+string Group::get_definition_name() const
+{
+    return string(name);
+}
+
+void Group::set_definition_name(const string &name_)
+{
+    name = name_;
+}
+
+void Group::count_objects(map<string, size_t> &counts) const
+{
+    counts[get_name()]++;
+
+    for (const Object::ptr &obj : objects)
+        obj->count_objects(counts);
+}
+
+Rect Group::get_bounds(const Transform &parent_transform) const
+{
+    Transform composed = (parent_transform * transform).translated(offset);
+    Rect bounds;
+
+    for (const Object::ptr &obj : objects)
+        bounds = bounds.united(obj->get_bounds(composed));
+
+    return bounds;
 }
 
 Group &Group::add_object(const Object &obj)
 {
-    objects.push_back(obj.clone());
+    objects.push_back(obj.clone(objects.get_allocator().resource()));
 
     return *this;
 }
 
-void Group::add_params(const string &params)
+Group &Group::add_object(Object::ptr obj)
 {
-    const auto &[offset_str, scale_str] = split_str_once(params);
+    objects.push_back(std::move(obj));
 
-    if (!scale_str.empty())
-        scale = ScaleFactor(extract_arg(scale_str, "scale"));
+    return *this;
+}
+
+void Group::add_params(const string &params)
+{
+    const auto &[offset_str, transform_str] = split_str_once(params);
+    Transform parsed;
+
+    for (const string &param : split_str(transform_str))
+    {
+        const string &param_name = split_str_once(param, '=').first;
+
+        if (param_name == "scale")
+            parsed = parsed * Transform::scaling(ScaleFactor(extract_arg(param, "scale")));
+        else if (param_name == "rotate")
+            parsed = parsed * Transform::rotation(parse_angle(extract_arg(param, "rotate")));
+        else if (param_name == "skew")
+            parsed = parsed * Transform::skewing(Vec2<double>(extract_arg(param, "skew")));
+        else if (param_name == "translate")
+        {
+            Vec2<double> translation(extract_arg(param, "translate"));
+            parsed = parsed * Transform::translation(translation.x, translation.y);
+        }
+        else
+            throw invalid_argument("unsupported group parameter: " + param_name);
+    }
 
     offset = Vec2(offset_str);
+    transform = parsed;
 }
 
 Group &Group::operator=(Group src)
 {
+    Object::operator=(src);
     std::swap(offset, src.offset);
-    std::swap(scale, src.scale);
+    std::swap(transform, src.transform);
     std::swap(objects, src.objects);
+    std::swap(name, src.name);
 
     return *this;
 }
@@ -12,53 +12,94 @@
 #include <list>
 
 /**
- * @brief Group of objects given by it's offset from the origin, scale
+ * @brief Group of objects given by it's offset from the origin, transformation
  * of the objects it contains and finally object themselves, which can be
- * any class derived from Object
+ * any class derived from Object.
+ *
+ * The offset is added in the coordinates of the image, so offsets of nested groups
+ * simply add up, while their transformations are composed into a single matrix
  */
 class Group : public Object
 {
     Coords offset;
-    ScaleFactor scale = ScaleFactor(1, 1);
-    std::list<std::unique_ptr<Object>> objects;
+    /** Transformation of the contained objects, applied before the offset */
+    Transform transform;
+    std::pmr::list<Object::ptr> objects;
+    /** Name of the definition the group was instantiated from, empty if it has none */
+    std::pmr::string name;
 
 public:
-    /** Construct a new Group object with default values */
-    Group();
+    /**
+     * @brief Construct a new Group object with default values
+     *
+     * @param resource Memory resource the contained objects should be allocated from
+     */
+    explicit Group(std::pmr::memory_resource *resource = std::pmr::get_default_resource());
 
     /**
      * @brief Construct a new Group object with given values
      *
      * @param offset_ Offset from the origin (0,0)
-     * @param scale_ Scale in either axis (e.g. (-1,2.5))
+     * @param transform_ Transformation of the contained objects,
+     * e.g. Transform::scaling(ScaleFactor(-1, 2.5))
      * @param objects_ List of objects the group contains
+     * @param resource Memory resource the contained objects should be allocated from
      */
-    Group(const Coords &offset_, const ScaleFactor &scale_,
-          const std::list<std::unique_ptr<Object>> &objects_);
+    Group(const Coords &offset_, const Transform &transform_,
+          const std::pmr::list<Object::ptr> &objects_,
+          std::pmr::memory_resource *resource = std::pmr::get_default_resource());
 
-    /** Construct a new Group object by creating a deep-copy of src */
+    /**
+     * @brief Construct a new Group object by creating a deep-copy of src,
+     * allocated from the same memory resource as src
+     */
     Group(const Group &src);
 
+    /**
+     * @brief Construct a new Group object by creating a deep-copy of src
+     *
+     * @param src Group to be copied
+     * @param resource Memory resource the copied objects should be allocated from
+     */
+    Group(const Group &src, std::pmr::memory_resource *resource);
+
+    /** Construct a new Group object by taking over the objects of src */
+    Group(Group &&src) noexcept;
+
     ~Group() override;
 
     /** Clone the Group along with all of its objects */
-    std::unique_ptr<Object> clone() const override;
+    Object::ptr clone(std::pmr::memory_resource *resource) const override;
 
     /**
      * @brief Render all objects this group contains into the given
      * image
      *
      * @param image
-     * @param parent_offset Offset of the parent group or (0,0) if this group
-     * is a top-level object
-     * @param parent_scale Scale of the parent group or (1,1) if this group
-     * is a top-level object
+     * @param parent_transform Transformation of the parent group or the identity
+     * if this group is a top-level object
      */
-    void render(Image &image, const Coords &parent_offset,
-                const ScaleFactor &parent_scale) const override;
+    void render(Image &image, const Transform &parent_transform) const override;
+
+    /** Get the union of bounds of all objects this group contains */
+    Rect get_bounds(const Transform &parent_transform) const override;
+
+    std::string get_name() const override;
+
+    /** Get label of the group including the name of its definition, e.g. "group tree" */
+    std::string get_label() const override;
+
+    /** Get name of the definition the group is an instance of, empty if it has none */
+    std::string get_definition_name() const override;
+
+    /** Set name of the definition the group and all of its copies are instances of */
+    void set_definition_name(const std::string &name_);
+
+    /** Count the group instance itself and all the objects it contains */
+    void count_objects(std::map<std::string, size_t> &counts) const override;
 
     /**
-     * @brief Add an object into the group
+     * @brief Add an object into the group by copying it
      *
      * @param obj Object to be added
      * @return Group&
@@ -66,7 +107,18 @@ public:
     Group &add_object(const Object &obj);
 
     /**
-     * @brief Add parameters (Offset and Scale) parsed from a source string
+     * @brief Add an object into the group, taking ownership of it
+     *
+     * @param obj Object to be added
+     * @return Group&
+     */
+    Group &add_object(Object::ptr obj);
+
+    /**
+     * @brief Add parameters (Offset and transformation) parsed from a source string.
+     * The transformation may consist of any number of scale=(x,y), rotate=DEGREES,
+     * skew=(x,y) in degrees and translate=(x,y), which are composed in the order
+     * they are written, so the last one is applied to the objects first
      *
      * @throws std::invalid_argument If unknown parameter is in the source sttring
      * @param params Source string to be parsed into parameters
@@ -5,8 +5,10 @@
  */
 
 #include "line.hpp"
+#include "../image/coverage.hpp"
 #include "../utils.hpp"
 
+#include <cmath>
 #include <sstream>
 
 using namespace std;
@@ -15,7 +17,7 @@ using namespace utils;
 Line::Line(const StylableObject::Style &style_, const Coords &start_, const Coords &end_)
     : StylableObject(style_), start(start_), end(end_) {}
 
-void Line::draw_line(Image &image, const Coords &v1, const Coords &v2) const
+void Line::draw_line(Image &image, const Coords &v1, const Coords &v2, const Color &color)
 {
     int x0 = v1.x, x1 = v2.x, y0 = v1.y, y1 = v2.y,
         dx = abs(x1 - x0), sx = x0 < x1 ? 1 : -1,
@@ -24,7 +26,7 @@ void Line::draw_line(Image &image, const Coords &v1, const Coords &v2) const
 
     while (x0 != x1 || y0 != y1)
     {
-        image.get_buffer().set_pixel(x0, y0, style.color);
+        image.get_buffer().set_pixel(x0, y0, color);
 
         int e2 = 2 * err;
 
@@ -41,37 +43,112 @@ void Line::draw_line(Image &image, const Coords &v1, const Coords &v2) const
     }
 }
 
-unique_ptr<Object> Line::clone() const
+Object::ptr Line::clone(pmr::memory_resource *resource) const
 {
-    return make_unique<Line>(*this);
+    return Object::make<Line>(resource, *this);
 }
 
-void Line::render(Image &image, const Coords &offset, const ScaleFactor &scale) const
+void Line::render(Image &image, const Transform &transform) const
 {
-    int x0 = (scale.x * start.x) + offset.x,
-        x1 = (scale.x * end.x) + offset.x,
-        y0 = (scale.y * start.y) + offset.y,
-        y1 = (scale.y * end.y) + offset.y;
+    Coords v1 = transform.map(start), v2 = transform.map(end);
 
-    double slope = calc_slope();
-    int width_half = style.width / 2;
-    int width_end = width_half - 1 + (style.width % 2);
+    rasterize(image, v1, v2, is_steep(transform), style.width, style.color);
+}
+
+string Line::get_name() const
+{
+    return "line";
+}
+
+Rect Line::get_bounds(const Transform &transform) const
+{
+    Coords v1 = transform.map(start), v2 = transform.map(end);
+
+    return Rect::around(v1, v2, style.width / 2 + 1);
+}
+
+void Line::rasterize(Image &image, const Coords &canvas_v1, const Coords &canvas_v2,
+                     bool is_steep, int width, const Color &color)
+{
+    // Supersampled images are drawn in the coordinates of their samples
+    Coords v1 = image.to_samples(canvas_v1), v2 = image.to_samples(canvas_v2);
+    width *= image.get_supersampling();
+
+    int width_half = width / 2;
+    int width_end = width_half - 1 + (width % 2);
+
+    if (image.is_antialiased())
+    {
+        if (v1 == v2)
+            return;
+
+        // Pixel centers lie half a pixel off the coordinates. The stroke is shifted back
+        // by half a pixel and even widths off the center the same way as the aliased
+        // line, so that axis-aligned lines cover exactly the same pixels
+        double length = hypot(v2.x - v1.x, v2.y - v1.y),
+               shift = (width_end - width_half) / 2.0;
+        Point back(0.5 - (v2.x - v1.x) / length / 2 + (is_steep ? shift : 0),
+                   0.5 - (v2.y - v1.y) / length / 2 + (is_steep ? 0 : shift));
+        CoverageAccumulator &coverage = CoverageAccumulator::get(image.get_bounds());
+
+        coverage.add_segment(Point(v1.x, v1.y) + back, Point(v2.x, v2.y) + back, width);
+        coverage.fill(image, color);
+
+        return;
+    }
+
+    // Axis-aligned thick lines form solid rectangles, which are filled
+    // span by span. Same as with draw_line, the second endpoint is excluded
+    if (v1 != v2 && ((v1.y == v2.y && !is_steep) || (v1.x == v2.x && is_steep)))
+    {
+        auto span = [](int a, int b)
+        { return a < b ? make_pair(a, b - a) : make_pair(b + 1, a - b); };
+
+        if (v1.y == v2.y)
+        {
+            const auto &[x, length] = span(v1.x, v2.x);
+            image.get_buffer().fill_rect(x, v1.y - width_half, length, width, color);
+        }
+        else
+        {
+            const auto &[y, length] = span(v1.y, v2.y);
+            image.get_buffer().fill_rect(v1.x - width_half, y, width, length, color);
+        }
+
+        return;
+    }
 
     // Iterate once for every pixel of width,
     // distributing thickness of the line evenly
     for (int i = -width_half; i <= width_end; i++)
-        if (abs(slope) <= 1)
-            draw_line(image, Coords(x0, y0 + i), Coords(x1, y1 + i));
+        if (!is_steep)
+            draw_line(image, v1 + Coords(0, i), v2 + Coords(0, i), color);
         else
-            draw_line(image, Coords(x0 + i, y0), Coords(x1 + i, y1));
+            draw_line(image, v1 + Coords(i, 0), v2 + Coords(i, 0), color);
 }
 
-unique_ptr<Object> Line::parse_from_str(const string &src)
+Object::ptr Line::parse_from_str(const string &src, pmr::memory_resource *resource)
 {
     const auto &[position_str, style_str] = split_str_once(src);
     vector<Coords> vertices = parse_vertices(position_str, 2, 2);
 
-    return make_unique<Line>(Line(StylableObject::Style(style_str), vertices[0], vertices[1]));
+    return Object::make<Line>(resource, StylableObject::Style(style_str),
+                              vertices[0], vertices[1]);
+}
+
+bool Line::is_steep(const Transform &transform) const
+{
+    // Lines which are only scaled and moved keep the steepness of their source,
+    // so that groups scaled non-uniformly render as they did before rotations
+    if (transform.is_axis_aligned())
+        return abs(calc_slope()) > 1;
+
+    // Rotations change the steepness, so it's decided by the transformed direction.
+    // Offsets don't, so they aren't rounded into it
+    Vec2<double> direction = transform.apply_linear(Vec2<double>(end.x - start.x,
+                                                                 end.y - start.y));
+
+    return direction.x == 0 || abs(direction.y / direction.x) > 1;
 }
 
 double Line::calc_slope() const
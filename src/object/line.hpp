@@ -26,8 +26,16 @@ class Line : public StylableObject
      * @param image Image the line should be rendered into
      * @param v1 First endpoint of the line
      * @param v2 Second endpoint of the line
+     * @param color Color of the line
      */
-    void draw_line(Image &image, const Coords &v1, const Coords &v2) const;
+    static void draw_line(Image &image, const Coords &v1, const Coords &v2, const Color &color);
+
+    /**
+     * @brief Check whether the line is steep, i.e. its slope is greater than 1. Lines
+     * which are only scaled and moved are checked in their own coordinates, the rotated
+     * and skewed ones in the image coordinates
+     */
+    bool is_steep(const Transform &transform) const;
 
 public:
     /**
@@ -39,27 +47,48 @@ public:
      */
     Line(const StylableObject::Style &style_, const Coords &start_, const Coords &end_);
 
-    std::unique_ptr<Object> clone() const override;
+    Object::ptr clone(std::pmr::memory_resource *resource) const override;
 
     /**
-     * @brief Render line with given offset and scale into image
+     * @brief Render line with given transformation into image
      * using Bresenham's line drawing algorithm
      *
      * <a href="https://en.wikipedia.org/wiki/Bresenham%27s_line_algorithm">Bresenham's line algorithm</a>
      * @param image Image the line should be rendered into
-     * @param offset Offset of the line from origin (0,0)
-     * @param scale Scale of the line
+     * @param transform Transformation of the endpoints into the image
+     */
+    void render(Image &image, const Transform &transform) const override;
+
+    Rect get_bounds(const Transform &transform) const override;
+
+    std::string get_name() const override;
+
+    /**
+     * @brief Rasterize a line whose endpoints are already in image coordinates,
+     * as a rectangle filled with anti-aliased edges if the image is anti-aliased
+     *
+     * @param image Image the line should be rendered into
+     * @param v1 First endpoint of the line
+     * @param v2 Second endpoint of the line
+     * @param is_steep Whether the thickness should be distributed along
+     * the X-axis instead of the Y-axis
+     * @param width Thickness of the line
+     * @param color Color of the line
      */
-    void render(Image &image, const Coords &offset, const ScaleFactor &scale) const override;
+    static void rasterize(Image &image, const Coords &v1, const Coords &v2,
+                          bool is_steep, int width, const Color &color);
 
     /**
      * @brief Parse the line from given string
      *
      * @throws std::invalid_argument If the string couldn't be parsed
      * @param src String in the form "((0,0);(100,100)) width=5 color=#ffffff"
-     * @return std::unique_ptr<Object>
+     * @param resource Memory resource the object should be allocated from
+     * @return Object::ptr
      */
-    static std::unique_ptr<Object> parse_from_str(const std::string &src);
+    static Object::ptr parse_from_str(const std::string &src,
+                                      std::pmr::memory_resource *resource =
+                                          std::pmr::get_default_resource());
 
     /**
      * @brief Calculate the slope of this line
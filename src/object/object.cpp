@@ -5,5 +5,81 @@
  */
 
 #include "object.hpp"
+#include "../profile.hpp"
+#include "../trace.hpp"
+
+#include <chrono>
+
+using namespace std;
+
+Object::Deleter::Deleter(pmr::memory_resource *resource_, size_t size_, size_t alignment_)
+    : resource(resource_), size(size_), alignment(alignment_) {}
+
+void Object::Deleter::operator()(Object *obj) const
+{
+    // Storage begins at the most derived object, not necessarily at its Object base
+    void *storage = dynamic_cast<void *>(obj);
+
+    obj->~Object();
+    resource->deallocate(storage, size, alignment);
+}
 
 Object::~Object() = default;
+
+Rect Object::get_bounds(const Transform &) const
+{
+    return Rect::unbounded();
+}
+
+Rect Object::get_opaque_interior(const Transform &) const
+{
+    return Rect();
+}
+
+void Object::count_objects(map<string, size_t> &counts) const
+{
+    counts[get_name()]++;
+}
+
+string Object::get_label() const
+{
+    return get_name();
+}
+
+string Object::get_definition_name() const
+{
+    return "";
+}
+
+size_t Object::get_source_line() const
+{
+    return source_line;
+}
+
+void Object::set_source_line(size_t line)
+{
+    source_line = line;
+}
+
+void Object::render_traced(Image &image, const Transform &transform) const
+{
+    trace::Span span("render", [this]()
+                     { return get_label(); });
+    ObjectProfile *profile = ObjectProfile::get_active();
+
+    if (profile == nullptr)
+    {
+        render(image, transform);
+        return;
+    }
+
+    size_t pixels_written = image.get_buffer().get_pixels_written();
+    auto start = chrono::steady_clock::now();
+    profile->begin_render();
+
+    render(image, transform);
+
+    profile->end_render(source_line, get_label(), get_definition_name(),
+                        chrono::duration<double>(chrono::steady_clock::now() - start).count(),
+                        image.get_buffer().get_pixels_written() - pixels_written);
+}
@@ -7,9 +7,16 @@
 #pragma once
 
 #include "../image/image.hpp"
+#include "../rect.hpp"
+#include "../transform.hpp"
 #include "../vec2.hpp"
 
+#include <map>
 #include <memory>
+#include <memory_resource>
+#include <new>
+#include <string>
+#include <utility>
 
 /**
  * @brief Abstract class providing interface for any
@@ -18,35 +25,154 @@
  */
 class Object
 {
+    /** Line of the image configuration the object was parsed from, 0 if it wasn't parsed */
+    size_t source_line = 0;
+
 public:
+    /**
+     * @brief Deleter for objects allocated from a memory resource,
+     * which destroys the object and returns its storage back to
+     * the resource it was allocated from
+     */
+    class Deleter
+    {
+        std::pmr::memory_resource *resource = nullptr;
+        size_t size = 0, alignment = 0;
+
+    public:
+        Deleter() = default;
+
+        /**
+         * @brief Construct a new Deleter object
+         *
+         * @param resource_ Memory resource the object was allocated from
+         * @param size_ Size of the most derived object
+         * @param alignment_ Alignment of the most derived object
+         */
+        Deleter(std::pmr::memory_resource *resource_, size_t size_, size_t alignment_);
+
+        /** Destroy the object and deallocate its storage */
+        void operator()(Object *obj) const;
+    };
+
+    /** Owning pointer to an object allocated from a memory resource */
+    using ptr = std::unique_ptr<Object, Deleter>;
+
     virtual ~Object();
 
+    /**
+     * @brief Construct a new object of type T inside of given memory resource
+     *
+     * @tparam T Type of the object, derived from Object
+     * @param resource Memory resource the object should be allocated from
+     * @param args Arguments passed to the constructor of T
+     * @return std::unique_ptr<T, Deleter>
+     */
+    template <typename T, typename... Args>
+    static std::unique_ptr<T, Deleter> make(std::pmr::memory_resource *resource, Args &&...args)
+    {
+        void *storage = resource->allocate(sizeof(T), alignof(T));
+        T *obj;
+
+        try
+        {
+            obj = ::new (storage) T(std::forward<Args>(args)...);
+        }
+        catch (...)
+        {
+            resource->deallocate(storage, sizeof(T), alignof(T));
+            throw;
+        }
+
+        return std::unique_ptr<T, Deleter>(obj, Deleter(resource, sizeof(T), alignof(T)));
+    }
+
     /**
      * @brief Clone the object by creating a deep copy
      *
-     * @return std::unique_ptr<Object>
+     * @param resource Memory resource the copy should be allocated from
+     * @return Object::ptr
+     */
+    virtual ptr clone(std::pmr::memory_resource *resource) const = 0;
+
+    /**
+     * @brief Render object into image, given it's transformation
+     * into the image, whose origin (0,0) represents the upper left corner
+     * of the image. The transformation combines the offsets, scales,
+     * reflections, rotations and skews of all the groups the object is in
+     *
+     * @param image Image into which the object should be rendered to
+     * @param transform Transformation of the object's coordinates into the image
+     */
+    virtual void render(Image &image, const Transform &transform) const = 0;
+
+    /**
+     * @brief Get conservative bounding box of all the pixels the object
+     * would render given it's transformation. Objects which don't
+     * provide their own bounds are considered to cover the whole plane
+     *
+     * @param transform Transformation of the object's coordinates into the image
+     * @return Rect
+     */
+    virtual Rect get_bounds(const Transform &transform) const;
+
+    /**
+     * @brief Get conservative rectangle of the pixels the object certainly
+     * overwrites by an opaque color given it's transformation, in any of the
+     * rendering modes, so that objects below it may be skipped. Objects which
+     * don't provide their own interior are considered to hide nothing
+     *
+     * @param transform Transformation of the object's coordinates into the image
+     * @return Rect
+     */
+    virtual Rect get_opaque_interior(const Transform &transform) const;
+
+    /** Get name of the object type as used in image configuration, e.g. "line" */
+    virtual std::string get_name() const = 0;
+
+    /**
+     * @brief Get label identifying the object in traces, which is the name
+     * of its type unless the object provides a more specific one
      */
-    virtual std::unique_ptr<Object> clone() const = 0;
+    virtual std::string get_label() const;
+
+    /**
+     * @brief Get name of the definition the object is an instance of,
+     * empty if it isn't an instance of any definition
+     */
+    virtual std::string get_definition_name() const;
+
+    /** Source line getter, 0 if the object wasn't parsed from an image configuration */
+    size_t get_source_line() const;
+
+    /** Set line of the image configuration the object was parsed from */
+    void set_source_line(size_t line);
 
     /**
-     * @brief Render object into image, given it's offset from
-     * the origin (0,0), which represent the upper left corner
-     * of the image and scale factor which enables two-dimensional
-     * scaling and also reflections
+     * @brief Render the object the same way as render(), recording
+     * a trace span of the rendering if tracing is enabled, and its time and
+     * pixels into the profile active on the calling thread, if any
      *
      * @param image Image into which the object should be rendered to
-     * @param offset Offset from the origin
-     * @param scale Scale of the object in either axis
-     * and/or whether is should also be reflected (indicated by negative values)
+     * @param transform Transformation of the object's coordinates into the image
+     */
+    void render_traced(Image &image, const Transform &transform) const;
+
+    /**
+     * @brief Count the object and all the objects it consists of by their type
+     *
+     * @param counts Number of objects of each type to be incremented
      */
-    virtual void render(Image &image, const Coords &offset, const ScaleFactor &scale) const = 0;
+    virtual void count_objects(std::map<std::string, size_t> &counts) const;
 
     /**
      * @brief Parse a new object from given string. This method
      * is deleted unless it is implemented by a specific Object.
      *
      * @param src Source string for the object to be parsed form
-     * @return std::unique_ptr<Object>
+     * @param resource Memory resource the object should be allocated from
+     * @return Object::ptr
      */
-    static std::unique_ptr<Object> parse_from_str(const std::string &src) = delete;
+    static ptr parse_from_str(const std::string &src,
+                              std::pmr::memory_resource *resource) = delete;
 };
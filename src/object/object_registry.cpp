@@ -23,20 +23,21 @@ ObjectRegistry &ObjectRegistry::add(const string &name, obj_str_ctor constructor
     return *this;
 }
 
-unique_ptr<Object> ObjectRegistry::parse_from_str(const string &src, bool print_err) const
+Object::ptr ObjectRegistry::parse_from_str(const string &src, ostream *err_out,
+                                           pmr::memory_resource *resource) const
 {
     const auto &[obj_name, obj_params] = split_str_once(src);
 
     if (objects.count(obj_name) == 0)
     {
-        if (print_err)
+        if (err_out != nullptr)
         {
-            cerr << "supported objects are: " << endl;
+            *err_out << "supported objects are: " << endl;
 
             for (const auto &[obj_name, _] : objects)
-                cerr << obj_name << endl;
+                *err_out << obj_name << endl;
 
-            cerr << "...and compound object group" << endl;
+            *err_out << "...and compound object group" << endl;
         }
 
         throw invalid_argument("unsupported object: " + obj_name);
@@ -44,7 +45,7 @@ unique_ptr<Object> ObjectRegistry::parse_from_str(const string &src, bool print_
     else if (obj_params.empty())
         throw invalid_argument(obj_name + ": no object parameters entered");
 
-    return objects.at(obj_name)(obj_params);
+    return objects.at(obj_name)(obj_params, resource);
 }
 
 bool ObjectRegistry::is_available(const string &name) const
@@ -9,6 +9,7 @@
 #include "object.hpp"
 
 #include <functional>
+#include <iostream>
 #include <map>
 #include <string>
 
@@ -21,7 +22,8 @@
  */
 class ObjectRegistry
 {
-    using obj_str_ctor = std::function<std::unique_ptr<Object>(const std::string &)>;
+    using obj_str_ctor =
+        std::function<Object::ptr(const std::string &, std::pmr::memory_resource *)>;
     using object_map = std::map<std::string, obj_str_ctor>;
 
     object_map objects;
@@ -51,12 +53,14 @@ public:
      *
      * @throws std::invalid_argument If the string couldn't be parsed
      * @param src String to be parsed into an object
-     * @param print_err Indicator whether verbose error message should
-     * be printed to std::cerr
-     * @return std::unique_ptr<Object>
+     * @param err_out Stream the verbose error message is printed to,
+     * nullptr if it shouldn't be printed
+     * @param resource Memory resource the object should be allocated from
+     * @return Object::ptr
      */
-    std::unique_ptr<Object> parse_from_str(const std::string &src,
-                                           bool print_err = true) const;
+    Object::ptr parse_from_str(const std::string &src, std::ostream *err_out = &std::cerr,
+                               std::pmr::memory_resource *resource =
+                                   std::pmr::get_default_resource()) const;
 
     /**
      * @brief Check whether given object is available from ObjectRegistry
@@ -0,0 +1,217 @@
+/**
+ * @file path.cpp
+ * @author Adam Berkeš <berkeada@fit.cvut.cz>
+ * @date 2026-10-19
+ */
+
+#include "path.hpp"
+#include "../utils.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+using namespace utils;
+
+/**
+ * @brief Parse points of a single command, e.g. "(0,0)(10,10)"
+ *
+ * @throws std::invalid_argument If the string doesn't consist of exactly count points
+ */
+static vector<Coords> parse_command_points(const string &src, size_t count)
+{
+    vector<Coords> points;
+
+    for (size_t begin = 0; begin < src.size();)
+    {
+        size_t end = src.find(')', begin);
+        if (end == string::npos)
+            throw invalid_argument("error parsing path command: " + src);
+
+        points.emplace_back(src.substr(begin, end - begin + 1));
+        begin = end + 1;
+    }
+
+    if (points.size() != count)
+        throw invalid_argument("invalid number of points in path command: " + src);
+
+    return points;
+}
+
+Path::Path(const StylableObject::Style &style_, LineJoin join_, LineCap cap_,
+           pmr::memory_resource *resource)
+    : StylableObject(style_), commands(resource), points(resource), join(join_), cap(cap_) {}
+
+Path::Path(const Path &src, pmr::memory_resource *resource)
+    : StylableObject(src), commands(src.commands, resource), points(src.points, resource),
+      join(src.join), cap(src.cap) {}
+
+Object::ptr Path::clone(pmr::memory_resource *resource) const
+{
+    return Object::make<Path>(resource, *this, resource);
+}
+
+Path &Path::move_to(const Coords &point)
+{
+    commands.push_back(Command::Move);
+    points.push_back(point);
+
+    return *this;
+}
+
+Path &Path::line_to(const Coords &point)
+{
+    if (commands.empty())
+        throw invalid_argument("path has to start by moving to a point");
+
+    commands.push_back(Command::Line);
+    points.push_back(point);
+
+    return *this;
+}
+
+Path &Path::quad_to(const Coords &control, const Coords &end)
+{
+    if (commands.empty())
+        throw invalid_argument("path has to start by moving to a point");
+
+    commands.push_back(Command::Quad);
+    points.push_back(control);
+    points.push_back(end);
+
+    return *this;
+}
+
+Path &Path::close()
+{
+    if (commands.empty())
+        throw invalid_argument("path has to start by moving to a point");
+
+    commands.push_back(Command::Close);
+
+    return *this;
+}
+
+Point Path::to_samples(const Image &image, const Transform &transform, const Vec2<double> &point)
+{
+    double samples = image.get_supersampling();
+    Vec2<double> transformed = transform.apply(point);
+
+    return Point((transformed.x + 0.5) * samples, (transformed.y + 0.5) * samples);
+}
+
+void Path::render(Image &image, const Transform &transform) const
+{
+    auto to_image = [&](const Coords &point)
+    { return to_samples(image, transform, Vec2<double>(point.x, point.y)); };
+
+    CoverageAccumulator &coverage = CoverageAccumulator::get(image.get_bounds());
+    Stroker stroker(coverage, style.width * image.get_supersampling(), join, cap);
+    const Coords *point = points.data();
+
+    for (Command command : commands)
+        switch (command)
+        {
+        case Command::Move:
+            stroker.move_to(to_image(*point++));
+            break;
+        case Command::Line:
+            stroker.line_to(to_image(*point++));
+            break;
+        case Command::Quad:
+            stroker.quad_to(to_image(point[0]), to_image(point[1]));
+            point += 2;
+            break;
+        case Command::Close:
+            stroker.close();
+            break;
+        }
+
+    stroker.finish();
+    coverage.fill(image, style.color, image.is_antialiased());
+}
+
+Rect Path::get_bounds(const Transform &transform) const
+{
+    // The stroke lies inside of the convex hull of the points widened by the longest miter
+    int padding = ceil(style.width * MITER_LIMIT / 2) + 2;
+    Rect bounds;
+
+    for (const Coords &point : points)
+    {
+        Coords p = transform.map(point);
+        bounds = bounds.united(Rect::around(p, p, padding));
+    }
+
+    return bounds;
+}
+
+string Path::get_name() const
+{
+    return "path";
+}
+
+StylableObject::Style Path::parse_stroke(const string &src, LineJoin &join_, LineCap &cap_)
+{
+    const map<string, LineJoin> JOINS = {
+        {"miter", LineJoin::Miter}, {"round", LineJoin::Round}, {"bevel", LineJoin::Bevel}};
+    const map<string, LineCap> CAPS = {
+        {"butt", LineCap::Butt}, {"round", LineCap::Round}, {"square", LineCap::Square}};
+    string style_str;
+
+    join_ = LineJoin::Miter;
+    cap_ = LineCap::Butt;
+
+    for (const string &param : split_str(src))
+    {
+        const auto &[name, value] = split_str_once(param, '=');
+
+        if (name == "join" && JOINS.count(value))
+            join_ = JOINS.at(value);
+        else if (name == "cap" && CAPS.count(value))
+            cap_ = CAPS.at(value);
+        else if (name == "join" || name == "cap")
+            throw invalid_argument("unsupported " + name + ": " + value);
+        else
+            style_str += param + ' ';
+    }
+
+    return StylableObject::Style(style_str);
+}
+
+Object::ptr Path::parse_from_str(const string &src, pmr::memory_resource *resource)
+{
+    const auto &[commands_str, style_str] = split_str_once(src);
+    LineJoin join;
+    LineCap cap;
+    StylableObject::Style style = parse_stroke(style_str, join, cap);
+    auto path = Object::make<Path>(resource, style, join, cap, resource);
+
+    if (commands_str.size() < 2 || commands_str.front() != '(' || commands_str.back() != ')')
+        throw invalid_argument("error parsing path: " + commands_str);
+
+    for (const string &command : split_str(commands_str.substr(1, commands_str.size() - 2), ';'))
+    {
+        string points_str = command.substr(1);
+
+        if (command == "Z")
+            path->close();
+        else if (command[0] == 'M')
+            path->move_to(parse_command_points(points_str, 1)[0]);
+        else if (command[0] == 'L')
+            path->line_to(parse_command_points(points_str, 1)[0]);
+        else if (command[0] == 'Q')
+        {
+            vector<Coords> quad_points = parse_command_points(points_str, 2);
+            path->quad_to(quad_points[0], quad_points[1]);
+        }
+        else
+            throw invalid_argument("unsupported path command: " + command);
+    }
+
+    if (none_of(path->commands.begin(), path->commands.end(), [](Command command)
+                { return command == Command::Line || command == Command::Quad; }))
+        throw invalid_argument("path has no segments: " + commands_str);
+
+    return path;
+}
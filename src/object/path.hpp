@@ -0,0 +1,128 @@
+/**
+ * @file path.hpp
+ * @author Adam Berkeš <berkeada@fit.cvut.cz>
+ * @date 2026-10-19
+ */
+
+#pragma once
+
+#include "stylable_object.hpp"
+#include "../image/stroker.hpp"
+
+/**
+ * @brief Path consisting of any number of subpaths, each of which is a sequence
+ * of straight segments and quadratic Bézier curves. The whole path is stroked
+ * as a single outline, so the segments are connected by proper joins
+ * and the open subpaths end with caps
+ */
+class Path : public StylableObject
+{
+public:
+    /** Command of the path, each one consumes its own number of points */
+    enum class Command : unsigned char
+    {
+        /** Start a new subpath at a point */
+        Move,
+        /** Straight segment to a point */
+        Line,
+        /** Quadratic Bézier curve given by its control point and end */
+        Quad,
+        /** Segment back to the first point of the subpath */
+        Close
+    };
+
+private:
+    std::pmr::vector<Command> commands;
+    /** Points of all the commands in order */
+    std::pmr::vector<Coords> points;
+    LineJoin join;
+    LineCap cap;
+
+protected:
+    /**
+     * @brief Parse the style of the stroke along with its join and cap
+     *
+     * @throws std::invalid_argument If the style couldn't be parsed
+     * @param src String in the form "width=3 join=round cap=square color=#fff"
+     * @param join_ Parsed shape of the corners, miter unless given
+     * @param cap_ Parsed shape of the ends, butt unless given
+     * @return StylableObject::Style
+     */
+    static StylableObject::Style parse_stroke(const std::string &src, LineJoin &join_,
+                                              LineCap &cap_);
+
+public:
+    /**
+     * @brief Construct a new empty Path object
+     *
+     * @param style_ Optional width and color of the stroke
+     * @param join_ Shape of the corners
+     * @param cap_ Shape of the ends of open subpaths
+     * @param resource Memory resource the commands should be allocated from
+     */
+    explicit Path(const StylableObject::Style &style_, LineJoin join_ = LineJoin::Miter,
+                  LineCap cap_ = LineCap::Butt,
+                  std::pmr::memory_resource *resource = std::pmr::get_default_resource());
+
+    /**
+     * @brief Construct a new Path object by copying src, allocating
+     * the commands from given memory resource
+     *
+     * @param src Path to be copied
+     * @param resource Memory resource the commands should be allocated from
+     */
+    Path(const Path &src, std::pmr::memory_resource *resource);
+
+    Object::ptr clone(std::pmr::memory_resource *resource) const override;
+
+    /**
+     * @brief Map a point onto the image, points lie on the centers of the pixels
+     * and supersampled images are drawn in the coordinates of their samples
+     *
+     * @param image Image the point is mapped onto
+     * @param transform Transformation of the point into the image
+     * @param point Point to be mapped
+     * @return Point
+     */
+    static Point to_samples(const Image &image, const Transform &transform,
+                            const Vec2<double> &point);
+
+    /** Start a new subpath at the point */
+    Path &move_to(const Coords &point);
+
+    /** Add a straight segment to the point, it has to follow move_to */
+    Path &line_to(const Coords &point);
+
+    /** Add a quadratic Bézier curve, it has to follow move_to */
+    Path &quad_to(const Coords &control, const Coords &end);
+
+    /** Close the current subpath, it has to follow move_to */
+    Path &close();
+
+    /**
+     * @brief Render the path with given transformation into image, the whole
+     * stroke is filled at once by the scanline coverage accumulator
+     *
+     * @param image Image the path should be rendered into
+     * @param transform Transformation of the path into the image
+     */
+    void render(Image &image, const Transform &transform) const override;
+
+    Rect get_bounds(const Transform &transform) const override;
+
+    std::string get_name() const override;
+
+    /**
+     * @brief Parse the path from given string. Commands are M(x,y) to move,
+     * L(x,y) for a straight segment, Q(x,y)(x,y) for a quadratic curve
+     * given by its control point and end and Z to close the subpath
+     *
+     * @throws std::invalid_argument If the string couldn't be parsed
+     * @param src String in the form "(M(0,0);L(100,0);Q(150,50)(100,100);Z) width=3 join=round"
+     * @param resource Memory resource the object should be allocated from
+     * @return Object::ptr
+     */
+    static Object::ptr parse_from_str(const std::string &src,
+                                      std::pmr::memory_resource *resource =
+                                          std::pmr::get_default_resource());
+};
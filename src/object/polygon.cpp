@@ -12,13 +12,16 @@ using namespace std;
 using namespace utils;
 
 Polygon::Polygon(const StylableObject::Style &style_,
-                 const vector<Coords> &vertices_)
-    : StylableObject(style_), vertices(vertices_)
+                 const vector<Coords> &vertices_, pmr::memory_resource *resource)
+    : StylableObject(style_), vertices(vertices_.begin(), vertices_.end(), resource)
 {
     if (vertices.size() < 3 || !check_polygon())
         throw invalid_argument("invalid polygon entered");
 }
 
+Polygon::Polygon(const Polygon &src, pmr::memory_resource *resource)
+    : StylableObject(src), vertices(src.vertices, resource) {}
+
 bool Polygon::check_polygon() const
 {
     vector<double> slopes;
@@ -35,23 +38,39 @@ bool Polygon::check_polygon() const
     return true;
 }
 
-unique_ptr<Object> Polygon::clone() const
+Object::ptr Polygon::clone(pmr::memory_resource *resource) const
 {
-    return make_unique<Polygon>(*this);
+    return Object::make<Polygon>(resource, *this, resource);
 }
 
-void Polygon::render(Image &image, const Coords &offset, const ScaleFactor &scale) const
+void Polygon::render(Image &image, const Transform &transform) const
 {
     for (size_t i = 0; i <= vertices.size() - 2; i++)
-        Line(style, vertices[i], vertices[i + 1]).render(image, offset, scale);
+        Line(style, vertices[i], vertices[i + 1]).render(image, transform);
+
+    Line(style, vertices[vertices.size() - 1], vertices[0]).render(image, transform);
+}
+
+string Polygon::get_name() const
+{
+    return "polygon";
+}
+
+Rect Polygon::get_bounds(const Transform &transform) const
+{
+    Rect bounds;
+
+    for (size_t i = 0; i < vertices.size(); i++)
+        bounds = bounds.united(
+            Line(style, vertices[i], vertices[(i + 1) % vertices.size()]).get_bounds(transform));
 
-    Line(style, vertices[vertices.size() - 1], vertices[0]).render(image, offset, scale);
+    return bounds;
 }
 
-unique_ptr<Object> Polygon::parse_from_str(const string &src)
+Object::ptr Polygon::parse_from_str(const string &src, pmr::memory_resource *resource)
 {
     const auto &[vertices_str, style_str] = split_str_once(src);
     vector<Coords> vertices = parse_vertices(vertices_str, 3);
 
-    return make_unique<Polygon>(Polygon(StylableObject::Style(style_str), vertices));
+    return Object::make<Polygon>(resource, StylableObject::Style(style_str), vertices, resource);
 }
@@ -14,7 +14,7 @@
  */
 class Polygon : public StylableObject
 {
-    std::vector<Coords> vertices;
+    std::pmr::vector<Coords> vertices;
 
     /**
      * @brief Check whether each 3 consecutive vertices are colinear
@@ -34,26 +34,43 @@ public:
      * the vertices given are colinear
      * @param style_ Optional width and color of the polygon
      * @param vertices_ Set of vertices which form the polygon
+     * @param resource Memory resource the vertices should be allocated from
      */
-    Polygon(const StylableObject::Style &style_, const std::vector<Coords> &vertices_);
+    Polygon(const StylableObject::Style &style_, const std::vector<Coords> &vertices_,
+            std::pmr::memory_resource *resource = std::pmr::get_default_resource());
 
-    std::unique_ptr<Object> clone() const override;
+    /**
+     * @brief Construct a new Polygon object by copying src, allocating
+     * the vertices from given memory resource
+     *
+     * @param src Polygon to be copied
+     * @param resource Memory resource the vertices should be allocated from
+     */
+    Polygon(const Polygon &src, std::pmr::memory_resource *resource);
+
+    Object::ptr clone(std::pmr::memory_resource *resource) const override;
 
     /**
-     * @brief Render polygon with given offset and scale into image
+     * @brief Render polygon with given transformation into image
      *
      * @param image Image the polygon should be rendered into
-     * @param offset Offset of the polygon from origin (0,0)
-     * @param scale Scale of the polygon
+     * @param transform Transformation of the polygon into the image
      */
-    void render(Image &image, const Coords &offset, const ScaleFactor &scale) const override;
+    void render(Image &image, const Transform &transform) const override;
+
+    Rect get_bounds(const Transform &transform) const override;
+
+    std::string get_name() const override;
 
     /**
      * @brief Parse the polygon from given string
      *
      * @throws std::invalid_argument If the string couldn't be parsed
      * @param src String in the form "((100,100);(200,200);(100,300);(0,200)) width=2 color=#dcba98"
-     * @return std::unique_ptr<Object>
+     * @param resource Memory resource the object should be allocated from
+     * @return Object::ptr
      */
-    static std::unique_ptr<Object> parse_from_str(const std::string &src);
+    static Object::ptr parse_from_str(const std::string &src,
+                                      std::pmr::memory_resource *resource =
+                                          std::pmr::get_default_resource());
 };
@@ -0,0 +1,46 @@
+/**
+ * @file polyline.cpp
+ * @author Adam Berkeš <berkeada@fit.cvut.cz>
+ * @date 2026-10-19
+ */
+
+#include "polyline.hpp"
+#include "../utils.hpp"
+
+using namespace std;
+using namespace utils;
+
+Polyline::Polyline(const StylableObject::Style &style_, const vector<Coords> &vertices,
+                   LineJoin join_, LineCap cap_, pmr::memory_resource *resource)
+    : Path(style_, join_, cap_, resource)
+{
+    if (vertices.size() < 2)
+        throw invalid_argument("polyline needs at least 2 vertices");
+
+    move_to(vertices.front());
+    for (auto vertex = vertices.begin() + 1; vertex != vertices.end(); vertex++)
+        line_to(*vertex);
+}
+
+Polyline::Polyline(const Polyline &src, pmr::memory_resource *resource) : Path(src, resource) {}
+
+Object::ptr Polyline::clone(pmr::memory_resource *resource) const
+{
+    return Object::make<Polyline>(resource, *this, resource);
+}
+
+string Polyline::get_name() const
+{
+    return "polyline";
+}
+
+Object::ptr Polyline::parse_from_str(const string &src, pmr::memory_resource *resource)
+{
+    const auto &[vertices_str, style_str] = split_str_once(src);
+    vector<Coords> vertices = parse_vertices(vertices_str, 2);
+    LineJoin join;
+    LineCap cap;
+    StylableObject::Style style = parse_stroke(style_str, join, cap);
+
+    return Object::make<Polyline>(resource, style, vertices, join, cap, resource);
+}
@@ -0,0 +1,56 @@
+/**
+ * @file polyline.hpp
+ * @author Adam Berkeš <berkeada@fit.cvut.cz>
+ * @date 2026-10-19
+ */
+
+#pragma once
+
+#include "path.hpp"
+
+/**
+ * @brief Open path going straight through a sequence of vertices,
+ * stroked as a single outline with joins at the vertices and caps at its ends
+ */
+class Polyline : public Path
+{
+public:
+    /**
+     * @brief Construct a new Polyline object going through given vertices
+     *
+     * @throws std::invalid_argument If less than 2 vertices are given
+     * @param style_ Optional width and color of the polyline
+     * @param vertices Vertices the polyline goes through in order
+     * @param join_ Shape of the corners
+     * @param cap_ Shape of the ends
+     * @param resource Memory resource the vertices should be allocated from
+     */
+    Polyline(const StylableObject::Style &style_, const std::vector<Coords> &vertices,
+             LineJoin join_ = LineJoin::Miter, LineCap cap_ = LineCap::Butt,
+             std::pmr::memory_resource *resource = std::pmr::get_default_resource());
+
+    /**
+     * @brief Construct a new Polyline object by copying src, allocating
+     * the vertices from given memory resource
+     *
+     * @param src Polyline to be copied
+     * @param resource Memory resource the vertices should be allocated from
+     */
+    Polyline(const Polyline &src, std::pmr::memory_resource *resource);
+
+    Object::ptr clone(std::pmr::memory_resource *resource) const override;
+
+    std::string get_name() const override;
+
+    /**
+     * @brief Parse the polyline from given string
+     *
+     * @throws std::invalid_argument If the string couldn't be parsed
+     * @param src String in the form "((0,0);(100,50);(200,0)) width=4 join=bevel cap=round"
+     * @param resource Memory resource the object should be allocated from
+     * @return Object::ptr
+     */
+    static Object::ptr parse_from_str(const std::string &src,
+                                      std::pmr::memory_resource *resource =
+                                          std::pmr::get_default_resource());
+};
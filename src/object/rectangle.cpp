@@ -4,12 +4,9 @@
  * @date 2023-05-13
  */
 
-#include "line.hpp"
 #include "rectangle.hpp"
 #include "../utils.hpp"
 
-#include <array>
-
 using namespace std;
 using namespace utils;
 
@@ -18,15 +15,14 @@ Rectangle::Rectangle(const StylableObject::Style &style_, const Coords &start_,
 {
 }
 
-unique_ptr<Object> Rectangle::clone() const
+Object::ptr Rectangle::clone(pmr::memory_resource *resource) const
 {
-    return make_unique<Rectangle>(*this);
+    return Object::make<Rectangle>(resource, *this);
 }
 
-void Rectangle::render(Image &image, const Coords &offset,
-                       const ScaleFactor &scale) const
+array<Line, 4> Rectangle::get_lines() const
 {
-    array<Line, 4> lines{
+    return {
         // Upper line
         Line(style, start - Coords(style.width / 2, 0),
              Coords(end.x + style.width / 2 + style.width % 2, start.y)),
@@ -37,16 +33,64 @@ void Rectangle::render(Image &image, const Coords &offset,
              end + Coords(style.width / 2 + style.width % 2, 0)),
         // Right line
         Line(style, Coords(end.x, start.y), end)};
+}
+
+void Rectangle::render(Image &image, const Transform &transform) const
+{
+    for (const Line &line : get_lines())
+        line.render(image, transform);
+}
+
+string Rectangle::get_name() const
+{
+    return "rectangle";
+}
+
+Rect Rectangle::get_bounds(const Transform &transform) const
+{
+    Rect bounds;
+
+    for (const Line &line : get_lines())
+        bounds = bounds.united(line.get_bounds(transform));
+
+    return bounds;
+}
+
+Rect Rectangle::get_opaque_interior(const Transform &transform) const
+{
+    // Lines of reversed rectangles extend inwards
+    if (!style.color.is_opaque() || style.width < 1 || !transform.is_axis_aligned() ||
+        transform.xx == 0 || transform.yy == 0 || start.x > end.x || start.y > end.y)
+        return Rect();
+
+    Coords a = transform.map(start), b = transform.map(end),
+           min(std::min(a.x, b.x), std::min(a.y, b.y)), max(std::max(a.x, b.x), std::max(a.y, b.y));
+    // First of the pixels covered by a line across the width, the same as when it's rasterized
+    int width_half = style.width / 2;
+    Rect interior;
+
+    // The rectangle is filled once the lines on its opposite sides meet, the pixels
+    // on the edges of the lines may be covered only partially, so they are left out
+    if (style.width >= max.y - min.y)
+        interior = Rect(Coords(min.x + 1, min.y - width_half + 1),
+                        Coords(max.x, max.y - width_half + style.width - 1));
+    if (style.width >= max.x - min.x)
+    {
+        Rect columns(Coords(min.x - width_half + 1, min.y + 1),
+                     Coords(max.x - width_half + style.width - 1, max.y));
+        if (interior.is_empty() ||
+            columns.get_width() * columns.get_height() > interior.get_width() * interior.get_height())
+            interior = columns;
+    }
 
-    for (const Line &line : lines)
-        line.render(image, offset, scale);
+    return interior;
 }
 
-unique_ptr<Object> Rectangle::parse_from_str(const string &src)
+Object::ptr Rectangle::parse_from_str(const string &src, pmr::memory_resource *resource)
 {
     const auto &[position_str, style_str] = split_str_once(src);
     vector<Coords> vertices = parse_vertices(position_str, 2, 2);
 
-    return make_unique<Rectangle>(
-        Rectangle(StylableObject::Style(style_str), vertices[0], vertices[1]));
+    return Object::make<Rectangle>(
+        resource, StylableObject::Style(style_str), vertices[0], vertices[1]);
 }
@@ -6,8 +6,11 @@
 
 #pragma once
 
+#include "line.hpp"
 #include "stylable_object.hpp"
 
+#include <array>
+
 /**
  * @brief Rectangle object represented by two 2D vectors,
  * its upper left and lower right corner
@@ -16,6 +19,9 @@ class Rectangle : public StylableObject
 {
     Coords start, end;
 
+    /** Get the four lines which form the outline of the rectangle */
+    std::array<Line, 4> get_lines() const;
+
 public:
     /**
      * @brief Construct a new Rectangle object with given parameters
@@ -26,24 +32,32 @@ public:
      */
     Rectangle(const StylableObject::Style &style_, const Coords &start_, const Coords &end_);
 
-    std::unique_ptr<Object> clone() const override;
+    Object::ptr clone(std::pmr::memory_resource *resource) const override;
 
     /**
-     * @brief Render rectangle with given offset and scale into image by
+     * @brief Render rectangle with given transformation into image by
      * by forming 4 lines that connect at right angle
      *
      * @param image Image the rectangle should be rendered into
-     * @param offset Offset of the rectangle from origin (0,0)
-     * @param scale Scale of the rectangle
+     * @param transform Transformation of the rectangle into the image
      */
-    void render(Image &image, const Coords &offset, const ScaleFactor &scale) const override;
+    void render(Image &image, const Transform &transform) const override;
+
+    Rect get_bounds(const Transform &transform) const override;
+
+    Rect get_opaque_interior(const Transform &transform) const override;
+
+    std::string get_name() const override;
 
     /**
      * @brief Parse the rectangle from given string
      *
      * @throws std::invalid_argument If the string couldn't be parsed
      * @param src String in the form "((0,0);(100,100)) width=34 color=#abcdef"
-     * @return std::unique_ptr<Object>
+     * @param resource Memory resource the object should be allocated from
+     * @return Object::ptr
      */
-    static std::unique_ptr<Object> parse_from_str(const std::string &src);
+    static Object::ptr parse_from_str(const std::string &src,
+                                      std::pmr::memory_resource *resource =
+                                          std::pmr::get_default_resource());
 };
@@ -5,10 +5,11 @@
  */
 
 #include "regular_polygon.hpp"
-#include "line.hpp"
+#include "path.hpp"
 #include "../utils.hpp"
 
 #include <cmath>
+#include <unordered_map>
 
 using namespace std;
 using namespace utils;
@@ -17,38 +18,77 @@ RegularPolygon::RegularPolygon(const StylableObject::Style &style_, const Coords
                                int n_sides_, int side_)
     : StylableObject(style_), center(center_), n_sides(n_sides_), side(side_) {}
 
-unique_ptr<Object> RegularPolygon::clone() const
+Object::ptr RegularPolygon::clone(pmr::memory_resource *resource) const
 {
-    return make_unique<RegularPolygon>(*this);
+    return Object::make<RegularPolygon>(resource, *this);
 }
 
-void RegularPolygon::render(Image &image, const Coords &offset, const ScaleFactor &scale) const
+const vector<Vec2<double>> &RegularPolygon::get_unit_vertices(int n_sides)
 {
     const double FULL_ANGLE = 360.0;
     const double HALF_ANGLE = FULL_ANGLE / 2.0;
-    const double BASE_ANGLE = FULL_ANGLE / n_sides;
 
-    double angle = ((n_sides - 2) * HALF_ANGLE) / (n_sides * 2);
-    Coords start(cos(angle * M_PI / HALF_ANGLE) * side + center.x,
-                 sin(angle * M_PI / HALF_ANGLE) * side + center.y);
+    thread_local unordered_map<int, vector<Vec2<double>>> cache;
+    auto [found, inserted] = cache.try_emplace(n_sides);
+    vector<Vec2<double>> &vertices = found->second;
 
-    for (int i = 0; i < n_sides; i++)
+    if (inserted)
     {
-        angle -= BASE_ANGLE;
-        Coords next(cos(angle * M_PI / HALF_ANGLE) * side + center.x,
-                    sin(angle * M_PI / HALF_ANGLE) * side + center.y);
-        Line(style, start, next).render(image, offset, scale);
-        start = next;
+        const double BASE_ANGLE = FULL_ANGLE / n_sides;
+
+        double angle = ((n_sides - 2) * HALF_ANGLE) / (n_sides * 2);
+        vertices.reserve(n_sides);
+
+        for (int i = 0; i < n_sides; i++, angle -= BASE_ANGLE)
+            vertices.emplace_back(cos(angle * M_PI / HALF_ANGLE), sin(angle * M_PI / HALF_ANGLE));
     }
+
+    return vertices;
+}
+
+void RegularPolygon::render(Image &image, const Transform &transform) const
+{
+    const vector<Vec2<double>> &vertices = get_unit_vertices(n_sides);
+    auto to_image = [&](const Vec2<double> &vertex)
+    {
+        return Path::to_samples(image, transform, Vec2<double>(vertex.x * side + center.x,
+                                                               vertex.y * side + center.y));
+    };
+
+    CoverageAccumulator &coverage = CoverageAccumulator::get(image.get_bounds());
+    Stroker stroker(coverage, style.width * image.get_supersampling());
+
+    stroker.move_to(to_image(vertices.front()));
+    for (auto vertex = vertices.begin() + 1; vertex != vertices.end(); vertex++)
+        stroker.line_to(to_image(*vertex));
+    stroker.close();
+
+    coverage.fill(image, style.color, image.is_antialiased());
+}
+
+string RegularPolygon::get_name() const
+{
+    return "regular_polygon";
+}
+
+Rect RegularPolygon::get_bounds(const Transform &transform) const
+{
+    // The polygon is inscribed in the circle of radius side, widened by the longest miter
+    Vec2<double> extent = transform.transform_ellipse(side, side).get_extent();
+    int padding = ceil(style.width * MITER_LIMIT / 2) + 2;
+    Coords mapped = transform.map(center),
+           radius(ceil(abs(extent.x)) + padding, ceil(abs(extent.y)) + padding);
+
+    return Rect::around(mapped - radius, mapped + radius);
 }
 
-unique_ptr<Object> RegularPolygon::parse_from_str(const string &src)
+Object::ptr RegularPolygon::parse_from_str(const string &src, pmr::memory_resource *resource)
 {
     const auto &[center_str, params] = split_str_once(src);
     const auto &[n_sides_str, params_rest] = split_str_once(params);
     const auto &[side_str, style_str] = split_str_once(params_rest);
 
-    return make_unique<RegularPolygon>(
-        RegularPolygon(StylableObject::Style(style_str),
-                       Coords(center_str), extract_int_arg(n_sides_str, "n_sides", 3), extract_int_arg(side_str, "side")));
+    return Object::make<RegularPolygon>(
+        resource, StylableObject::Style(style_str), Coords(center_str),
+        extract_int_arg(n_sides_str, "n_sides", 3), extract_int_arg(side_str, "side"));
 }
@@ -17,6 +17,16 @@ class RegularPolygon : public StylableObject
     Coords center;
     int n_sides, side;
 
+    /**
+     * @brief Get the vertices of the polygon with given number of sides inscribed
+     * in the unit circle. They are calculated once per thread for each number
+     * of sides, so that the polygons don't have to evaluate any trigonometric functions
+     *
+     * @param n_sides Number of sides of the polygon
+     * @return const std::vector<Vec2<double>>&
+     */
+    static const std::vector<Vec2<double>> &get_unit_vertices(int n_sides);
+
 public:
     /**
      * @brief Construct a new Regular Polygon object with given parameters
@@ -29,24 +39,30 @@ public:
     RegularPolygon(const StylableObject::Style &style_, const Coords &center_,
                    int n_sides_, int side_);
 
-    std::unique_ptr<Object> clone() const override;
+    Object::ptr clone(std::pmr::memory_resource *resource) const override;
 
     /**
-     * @brief Render polygon with given offset and scale into image by constructing
-     * consecutive lines of same length which form a regular polygon
+     * @brief Render polygon with given transformation into image, its outline
+     * is stroked at once as a closed path with mitered corners
      *
      * @param image Image the polygon should be rendered into
-     * @param offset Offset from the origin (0,0)
-     * @param scale Scale of the polygon
+     * @param transform Transformation of the polygon into the image
      */
-    void render(Image &image, const Coords &offset, const ScaleFactor &scale) const override;
+    void render(Image &image, const Transform &transform) const override;
+
+    Rect get_bounds(const Transform &transform) const override;
+
+    std::string get_name() const override;
 
     /**
      * @brief Parse the polygon from given string
      *
      * @throws std::invalid_argument If the string couldn't be parsed
      * @param src String in the form "(100,100) n_sides=8 side=50 width=10 color=#f00"
-     * @return std::unique_ptr<Object>
+     * @param resource Memory resource the object should be allocated from
+     * @return Object::ptr
      */
-    static std::unique_ptr<Object> parse_from_str(const std::string &src);
+    static Object::ptr parse_from_str(const std::string &src,
+                                      std::pmr::memory_resource *resource =
+                                          std::pmr::get_default_resource());
 };
@@ -4,13 +4,11 @@
  * @date 2023-06-01
  */
 
-#include "curve.hpp"
 #include "spiral.hpp"
+#include "path.hpp"
 #include "../utils.hpp"
 
-#include <array>
 #include <cmath>
-#include <iostream>
 
 using namespace std;
 using namespace utils;
@@ -22,48 +20,84 @@ Spiral::Spiral(const StylableObject::Style &style_, const Coords &center_, int r
         throw invalid_argument("number of rotations for spiral has to be at least 1");
 }
 
-unique_ptr<Object> Spiral::clone() const
+Object::ptr Spiral::clone(pmr::memory_resource *resource) const
 {
-    return make_unique<Spiral>(*this);
+    return Object::make<Spiral>(resource, *this);
 }
 
-void Spiral::render(Image &image, const Coords &offset, const ScaleFactor &scale) const
+array<Coords, 3> Spiral::get_curve_points(int i) const
 {
     // Golden ratio
     const double PHI = (1 + sqrt(5)) / 2;
     const int R_BASE = 4 * style.width;
-    bool is_upper = true;
+    bool is_upper = i % 2 == 0;
+    array<Coords, 3> curve_points;
 
+    if (is_upper)
+    {
+        curve_points[0] = center - Coords(i * R_BASE, 0);
+        curve_points[2] = center + Coords((i + 1) * R_BASE, 0);
+        curve_points[1] = Coords((curve_points[0].x + curve_points[2].x) / 2,
+                                 center.y + i * R_BASE * (PHI * PHI));
+    }
+    else
+    {
+        curve_points[0] = center + Coords(i * R_BASE, 0);
+        curve_points[2] = center - Coords((i + 1) * R_BASE, 0);
+        curve_points[1] = Coords((curve_points[0].x + curve_points[2].x) / 2,
+                                 center.y - i * R_BASE * (PHI * PHI));
+    }
+
+    return curve_points;
+}
+
+void Spiral::render(Image &image, const Transform &transform) const
+{
+    auto to_image = [&](const Coords &point)
+    { return Path::to_samples(image, transform, Vec2<double>(point.x, point.y)); };
+
+    CoverageAccumulator &coverage = CoverageAccumulator::get(image.get_bounds());
+    Stroker stroker(coverage, style.width * image.get_supersampling());
+
+    // Each half-rotation starts where the previous one ends, so they form a single path
+    stroker.move_to(to_image(get_curve_points(0)[0]));
     for (int i = 0; i < 2 * rotations; i++)
     {
-        array<Coords, 3> curve_points;
+        array<Coords, 3> points = get_curve_points(i);
+        stroker.quad_to(to_image(points[1]), to_image(points[2]));
+    }
+    stroker.finish();
 
-        if (is_upper)
-        {
-            curve_points[0] = center - Coords(i * R_BASE, 0);
-            curve_points[2] = center + Coords((i + 1) * R_BASE, 0);
-            curve_points[1] = Coords((curve_points[0].x + curve_points[2].x) / 2,
-                                     center.y + i * R_BASE * (PHI * PHI));
-        }
-        else
+    coverage.fill(image, style.color, image.is_antialiased());
+}
+
+string Spiral::get_name() const
+{
+    return "spiral";
+}
+
+Rect Spiral::get_bounds(const Transform &transform) const
+{
+    // The curves lie inside of the convex hulls of their control points, widened by the longest miter
+    int padding = ceil(style.width * MITER_LIMIT / 2) + 2;
+    Rect bounds;
+
+    for (int i = 0; i < 2 * rotations; i++)
+        for (const Coords &point : get_curve_points(i))
         {
-            curve_points[0] = center + Coords(i * R_BASE, 0);
-            curve_points[2] = center - Coords((i + 1) * R_BASE, 0);
-            curve_points[1] = Coords((curve_points[0].x + curve_points[2].x) / 2,
-                                     center.y - i * R_BASE * (PHI * PHI));
+            Coords p = transform.map(point);
+            bounds = bounds.united(Rect::around(p, p, padding));
         }
 
-        Curve(style, curve_points).render(image, offset, scale);
-        is_upper = !is_upper;
-    }
+    return bounds;
 }
 
-unique_ptr<Object> Spiral::parse_from_str(const string &src)
+Object::ptr Spiral::parse_from_str(const string &src, pmr::memory_resource *resource)
 {
     const auto &[center_str, params_str] = split_str_once(src);
     const auto &[rotations_str, style_str] = split_str_once(params_str);
     int rotations = extract_int_arg(rotations_str, "rotations");
 
-    return make_unique<Spiral>(
-        Spiral(StylableObject::Style(style_str), Coords(center_str), rotations));
+    return Object::make<Spiral>(
+        resource, StylableObject::Style(style_str), Coords(center_str), rotations);
 }
@@ -8,6 +8,8 @@
 
 #include "stylable_object.hpp"
 
+#include <array>
+
 /**
  * @brief Spiral given by its center and number of rotations
  */
@@ -16,6 +18,14 @@ class Spiral : public StylableObject
     Coords center;
     int rotations;
 
+    /**
+     * @brief Calculate control points of the curve forming the i-th half-rotation
+     *
+     * @param i Index of the half-rotation, starting from the center
+     * @return std::array<Coords, 3>
+     */
+    std::array<Coords, 3> get_curve_points(int i) const;
+
 public:
     /**
      * @brief Construct a new Spiral object with given parameters. Beware that
@@ -29,26 +39,32 @@ public:
      */
     Spiral(const StylableObject::Style &style_, const Coords &center_, int rotations_);
 
-    std::unique_ptr<Object> clone() const override;
+    Object::ptr clone(std::pmr::memory_resource *resource) const override;
 
     /**
-     * @brief Render spiral with given offset and scale into image. Spiral is rendered
-     * using quadratic Bezier curves, which form connected semi-circles with increasing
-     * radii, creating a spiral
+     * @brief Render spiral with given transformation into image. Spiral is formed
+     * by quadratic Bezier curves, which form connected semi-circles with increasing
+     * radii. They are flattened and stroked as a single path, so the cost follows
+     * the length of the spiral
      *
      * @param image Image the spiral should be rendere into
-     * @param offset Offset from the origin (0,0)
-     * @param scale Scale of the spiral
+     * @param transform Transformation of the spiral into the image
      */
-    void render(Image &image, const Coords &offset,
-                const ScaleFactor &scale) const override;
+    void render(Image &image, const Transform &transform) const override;
+
+    Rect get_bounds(const Transform &transform) const override;
+
+    std::string get_name() const override;
 
     /**
      * @brief Parse spiral from given string
      *
      * @throws std::invalid_argument If the string couldn't be parsed
      * @param src String in the form "(100,100) rotations=5 width=2 color=#abcdef"
-     * @return std::unique_ptr<Object>
+     * @param resource Memory resource the object should be allocated from
+     * @return Object::ptr
      */
-    static std::unique_ptr<Object> parse_from_str(const std::string &src);
+    static Object::ptr parse_from_str(const std::string &src,
+                                      std::pmr::memory_resource *resource =
+                                          std::pmr::get_default_resource());
 };
@@ -10,7 +10,7 @@
 using namespace std;
 using namespace utils;
 
-StylableObject::Style::Style(int width_, Pixel color_)
+StylableObject::Style::Style(int width_, Color color_)
     : width(width_), color(color_) {}
 
 StylableObject::Style::Style(const string &src) : StylableObject::Style()
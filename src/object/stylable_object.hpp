@@ -26,7 +26,7 @@ public:
         /** Width of the outline of the object */
         int width;
         /** Color of the outline of the object */
-        Pixel color;
+        Color color;
 
         /**
          * @brief Construct a new Style object with
@@ -35,7 +35,7 @@ public:
          * @param width_ Width of the outline
          * @param color_ Color of the outline
          */
-        Style(int width_ = 1, Pixel color_ = {255, 255, 255});
+        Style(int width_ = 1, Color color_ = {255, 255, 255});
 
         /**
          * @brief Construct a new Style object from source string
@@ -0,0 +1,130 @@
+/**
+ * @file profile.cpp
+ * @author Adam Berkeš <berkeada@fit.cvut.cz>
+ * @date 2026-10-19
+ */
+
+#include "profile.hpp"
+
+#include <algorithm>
+#include <iomanip>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+/** Profile active on each thread */
+static thread_local ObjectProfile *active_profile = nullptr;
+
+ObjectProfile::Activation::Activation(ObjectProfile *profile) : previous(active_profile)
+{
+    active_profile = profile;
+}
+
+ObjectProfile::Activation::~Activation()
+{
+    active_profile = previous;
+}
+
+ObjectProfile *ObjectProfile::get_active()
+{
+    return active_profile;
+}
+
+void ObjectProfile::begin_render()
+{
+    depth++;
+}
+
+void ObjectProfile::end_render(size_t source_line, const string &label,
+                               const string &group_definition, double seconds,
+                               size_t pixels_written)
+{
+    auto add_to = [&](Entry &entry)
+    {
+        entry.label = label;
+        entry.seconds += seconds;
+        entry.pixels_written += pixels_written;
+        entry.renders++;
+    };
+
+    if (source_line > 0)
+        add_to(lines[source_line]);
+    if (!group_definition.empty())
+        add_to(groups[group_definition]);
+
+    if (--depth == 0)
+        total_seconds += seconds;
+}
+
+void ObjectProfile::merge(const ObjectProfile &other)
+{
+    auto add_to = [](Entry &entry, const Entry &added)
+    {
+        entry.label = added.label;
+        entry.seconds += added.seconds;
+        entry.pixels_written += added.pixels_written;
+        entry.renders += added.renders;
+    };
+
+    for (const auto &[line, entry] : other.lines)
+        add_to(lines[line], entry);
+    for (const auto &[name, entry] : other.groups)
+        add_to(groups[name], entry);
+
+    total_seconds += other.total_seconds;
+}
+
+const map<size_t, ObjectProfile::Entry> &ObjectProfile::get_lines() const
+{
+    return lines;
+}
+
+const map<string, ObjectProfile::Entry> &ObjectProfile::get_groups() const
+{
+    return groups;
+}
+
+double ObjectProfile::get_total_seconds() const
+{
+    return total_seconds;
+}
+
+void ObjectProfile::print(ostream &os, size_t count) const
+{
+    vector<pair<string, const Entry *>> entries;
+
+    for (const auto &[line, entry] : lines)
+        entries.push_back({"line " + to_string(line), &entry});
+    for (const auto &[name, entry] : groups)
+        entries.push_back({"definition", &entry});
+
+    count = min(count, entries.size());
+    partial_sort(entries.begin(), entries.begin() + count, entries.end(),
+                 [](const pair<string, const Entry *> &a, const pair<string, const Entry *> &b)
+                 { return a.second->seconds > b.second->seconds; });
+
+    ios_base::fmtflags flags = os.flags();
+
+    os << "top " << count << " of " << entries.size()
+       << " source lines and group definitions by render time"
+       << " (groups include the objects they contain)\n"
+       << right << setw(12) << "time [ms]" << setw(9) << "share" << setw(16) << "pixels"
+       << setw(10) << "renders" << "  " << left << setw(12) << "source" << "object\n"
+       << fixed;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        const auto &[source, entry] = entries[i];
+        double share = total_seconds > 0 ? 100.0 * entry->seconds / total_seconds : 0;
+
+        os << right << setprecision(3) << setw(12) << entry->seconds * 1e3
+           << setprecision(1) << setw(7) << share << " %" << setw(16) << entry->pixels_written
+           << setw(10) << entry->renders << "  " << left << setw(12) << source
+           << entry->label << '\n';
+    }
+
+    os << "total render time: " << setprecision(3) << total_seconds * 1e3 << " ms" << endl;
+
+    os.flags(flags);
+}
@@ -0,0 +1,112 @@
+/**
+ * @file profile.hpp
+ * @author Adam Berkeš <berkeada@fit.cvut.cz>
+ * @date 2026-10-19
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <map>
+#include <ostream>
+#include <string>
+
+/**
+ * @brief Profile attributing render time and written pixels to the lines
+ * of the image configuration the objects were parsed from and to the group
+ * definitions. Time and pixels of a group include the objects it contains
+ */
+class ObjectProfile
+{
+public:
+    /** Cost accumulated by a single source line or group definition */
+    struct Entry
+    {
+        /** Label of the object, e.g. "polygon" or "group tree" */
+        std::string label;
+        /** Time spent rendering in seconds */
+        double seconds = 0;
+        size_t pixels_written = 0;
+        /** Number of times the objects were rendered */
+        size_t renders = 0;
+    };
+
+    /**
+     * @brief Profile made active on the calling thread for its lifetime,
+     * so that the objects rendered by the thread are recorded into it
+     */
+    class Activation
+    {
+        ObjectProfile *previous;
+
+    public:
+        /**
+         * @brief Construct a new Activation object
+         *
+         * @param profile Profile to be activated, nullptr to record no profile
+         */
+        explicit Activation(ObjectProfile *profile);
+
+        Activation(const Activation &) = delete;
+
+        Activation &operator=(const Activation &) = delete;
+
+        ~Activation();
+    };
+
+private:
+    /** Entries of source lines, keyed by the line number */
+    std::map<size_t, Entry> lines;
+    /** Entries of group definitions, keyed by the name of the definition */
+    std::map<std::string, Entry> groups;
+    /** Time of all the top-level renders, nested renders are already included in it */
+    double total_seconds = 0;
+    /** Number of renders in progress on the thread the profile is active on */
+    size_t depth = 0;
+
+public:
+    /** Get profile active on the calling thread, nullptr if there is none */
+    static ObjectProfile *get_active();
+
+    /** Note that rendering of an object begins, so that nested renders can be told apart */
+    void begin_render();
+
+    /**
+     * @brief Record a finished render of an object
+     *
+     * @param source_line Line the object was parsed from, 0 if it wasn't parsed
+     * @param label Label of the object
+     * @param group_definition Name of the group definition the object is an instance of,
+     * empty if it isn't an instance of a group
+     * @param seconds Time spent rendering
+     * @param pixels_written Number of pixels written
+     */
+    void end_render(size_t source_line, const std::string &label,
+                    const std::string &group_definition, double seconds, size_t pixels_written);
+
+    /**
+     * @brief Add all the entries of another profile into this one, so that
+     * renders running in parallel may be profiled separately first
+     *
+     * @param other Profile to be added
+     */
+    void merge(const ObjectProfile &other);
+
+    /** Source lines getter */
+    const std::map<size_t, Entry> &get_lines() const;
+
+    /** Group definitions getter */
+    const std::map<std::string, Entry> &get_groups() const;
+
+    /** Get time of all the recorded top-level renders in seconds */
+    double get_total_seconds() const;
+
+    /**
+     * @brief Print the most expensive source lines and group definitions
+     * as a human readable table
+     *
+     * @param os Output stream
+     * @param count Maximum number of entries printed
+     */
+    void print(std::ostream &os, size_t count) const;
+};
@@ -0,0 +1,105 @@
+/**
+ * @file rect.hpp
+ * @author Adam Berkeš <berkeada@fit.cvut.cz>
+ * @date 2026-10-19
+ */
+
+#pragma once
+
+#include "vec2.hpp"
+
+#include <algorithm>
+#include <limits>
+
+/**
+ * @brief Axis-aligned rectangle in the Cartesian plane given by
+ * its upper left corner (inclusive) and lower right corner (exclusive)
+ */
+class Rect
+{
+public:
+    /** Upper left corner, inclusive */
+    Coords min;
+    /** Lower right corner, exclusive */
+    Coords max;
+
+    /**
+     * @brief Construct a new Rect object, the default rectangle is empty
+     *
+     * @param min_ Upper left corner, inclusive
+     * @param max_ Lower right corner, exclusive
+     */
+    Rect(const Coords &min_ = {}, const Coords &max_ = {}) : min(min_), max(max_){};
+
+    /** Construct a rectangle covering the whole plane */
+    static Rect unbounded()
+    {
+        return Rect(Coords(std::numeric_limits<int>::min(), std::numeric_limits<int>::min()),
+                    Coords(std::numeric_limits<int>::max(), std::numeric_limits<int>::max()));
+    }
+
+    /**
+     * @brief Construct the smallest rectangle containing both points
+     * and padded by given amount of pixels on each side
+     *
+     * @param a First point
+     * @param b Second point
+     * @param padding Number of pixels to pad the rectangle with
+     * @return Rect
+     */
+    static Rect around(const Coords &a, const Coords &b, int padding = 0)
+    {
+        return Rect(Coords(std::min(a.x, b.x) - padding, std::min(a.y, b.y) - padding),
+                    Coords(std::max(a.x, b.x) + padding + 1, std::max(a.y, b.y) + padding + 1));
+    }
+
+    /** Check whether the rectangle contains no pixels */
+    bool is_empty() const
+    {
+        return min.x >= max.x || min.y >= max.y;
+    }
+
+    /** Check whether the rectangles share at least one pixel */
+    bool intersects(const Rect &rhs) const
+    {
+        return !intersected(rhs).is_empty();
+    }
+
+    /** Check whether rhs lies completely inside of this rectangle */
+    bool contains(const Rect &rhs) const
+    {
+        return rhs.is_empty() || (min.x <= rhs.min.x && min.y <= rhs.min.y &&
+                                  max.x >= rhs.max.x && max.y >= rhs.max.y);
+    }
+
+    /** Get the intersection of both rectangles */
+    Rect intersected(const Rect &rhs) const
+    {
+        return Rect(Coords(std::max(min.x, rhs.min.x), std::max(min.y, rhs.min.y)),
+                    Coords(std::min(max.x, rhs.max.x), std::min(max.y, rhs.max.y)));
+    }
+
+    /** Get the smallest rectangle containing both rectangles */
+    Rect united(const Rect &rhs) const
+    {
+        if (is_empty())
+            return rhs;
+        else if (rhs.is_empty())
+            return *this;
+
+        return Rect(Coords(std::min(min.x, rhs.min.x), std::min(min.y, rhs.min.y)),
+                    Coords(std::max(max.x, rhs.max.x), std::max(max.y, rhs.max.y)));
+    }
+
+    /** Width of the rectangle */
+    int get_width() const
+    {
+        return max.x - min.x;
+    }
+
+    /** Height of the rectangle */
+    int get_height() const
+    {
+        return max.y - min.y;
+    }
+};
@@ -0,0 +1,114 @@
+/**
+ * @file stats.cpp
+ * @author Adam Berkeš <berkeada@fit.cvut.cz>
+ * @date 2026-10-19
+ */
+
+#include "stats.hpp"
+
+#include <algorithm>
+#include <ctime>
+#include <iomanip>
+#include <sys/resource.h>
+
+using namespace std;
+
+Stopwatch::Stopwatch() : wall_start(chrono::steady_clock::now()), cpu_start(get_cpu_time()) {}
+
+Timing Stopwatch::elapsed() const
+{
+    return {chrono::duration<double>(chrono::steady_clock::now() - wall_start).count(),
+            get_cpu_time() - cpu_start};
+}
+
+double Stopwatch::get_cpu_time()
+{
+    timespec time;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &time);
+
+    return time.tv_sec + time.tv_nsec / 1e9;
+}
+
+void Stats::add_time(const string &phase, const Timing &time)
+{
+    auto it = find_if(phases.begin(), phases.end(), [&](const pair<string, Timing> &entry)
+                      { return entry.first == phase; });
+
+    if (it == phases.end())
+        phases.push_back({phase, time});
+    else
+        it->second += time;
+}
+
+void Stats::add_object_counts(const map<string, size_t> &counts)
+{
+    for (const auto &[type, count] : counts)
+        object_counts[type] += count;
+}
+
+void Stats::add_pixels(size_t written, size_t rejected)
+{
+    pixels_written += written;
+    pixels_rejected += rejected;
+}
+
+void Stats::add_culled_objects(size_t count)
+{
+    objects_culled += count;
+}
+
+long Stats::get_peak_rss()
+{
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+
+    // Linux reports the size in kilobytes, while macOS reports it in bytes
+#ifdef __APPLE__
+    return usage.ru_maxrss;
+#else
+    return usage.ru_maxrss * 1024L;
+#endif
+}
+
+void Stats::print(ostream &os) const
+{
+    ios_base::fmtflags flags = os.flags();
+
+    os << left << setw(24) << "phase" << right << setw(12) << "wall [ms]"
+       << setw(12) << "cpu [ms]" << '\n'
+       << fixed << setprecision(3);
+    for (const auto &[phase, time] : phases)
+        os << left << setw(24) << phase << right << setw(12) << time.wall * 1e3
+           << setw(12) << time.cpu * 1e3 << '\n';
+
+    os << "objects:";
+    for (const auto &[type, count] : object_counts)
+        os << ' ' << type << '=' << count;
+    os << ", culled: " << objects_culled << '\n';
+
+    size_t pixels_total = pixels_written + pixels_rejected;
+    os << "pixels written: " << pixels_written << ", rejected: " << pixels_rejected
+       << setprecision(1) << " (" << (pixels_total > 0 ? 100.0 * pixels_rejected / pixels_total : 0)
+       << " %)\n"
+       << "peak RSS: " << get_peak_rss() / (1024.0 * 1024.0) << " MiB" << endl;
+
+    os.flags(flags);
+}
+
+void Stats::print_json(ostream &os) const
+{
+    os << "{\n  \"phases\": [";
+    for (size_t i = 0; i < phases.size(); i++)
+        os << (i == 0 ? "\n" : ",\n") << "    {\"name\": \"" << phases[i].first
+           << "\", \"wall_ms\": " << phases[i].second.wall * 1e3
+           << ", \"cpu_ms\": " << phases[i].second.cpu * 1e3 << '}';
+
+    os << "\n  ],\n  \"objects\": {";
+    for (auto it = object_counts.begin(); it != object_counts.end(); it++)
+        os << (it == object_counts.begin() ? "" : ", ") << '"' << it->first << "\": " << it->second;
+
+    os << "},\n  \"objects_culled\": " << objects_culled
+       << ",\n  \"pixels_written\": " << pixels_written
+       << ",\n  \"pixels_rejected\": " << pixels_rejected
+       << ",\n  \"peak_rss_bytes\": " << get_peak_rss() << "\n}" << endl;
+}
@@ -0,0 +1,101 @@
+/**
+ * @file stats.hpp
+ * @author Adam Berkeš <berkeada@fit.cvut.cz>
+ * @date 2026-10-19
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <map>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+/** Wall and CPU time spent in a phase, both in seconds */
+struct Timing
+{
+    double wall = 0, cpu = 0;
+
+    /** Addition-assignment operator */
+    Timing &operator+=(const Timing &rhs)
+    {
+        wall += rhs.wall;
+        cpu += rhs.cpu;
+
+        return *this;
+    }
+
+    /** Subtraction operator */
+    Timing operator-(const Timing &rhs) const
+    {
+        return {wall - rhs.wall, cpu - rhs.cpu};
+    }
+};
+
+/** Stopwatch measuring both wall and CPU time since it was started */
+class Stopwatch
+{
+    std::chrono::steady_clock::time_point wall_start;
+    double cpu_start;
+
+public:
+    /** Construct a new Stopwatch object and start it */
+    Stopwatch();
+
+    /** Get time elapsed since the stopwatch was started */
+    Timing elapsed() const;
+
+    /** Get CPU time consumed by all the threads of the process in seconds */
+    static double get_cpu_time();
+};
+
+/**
+ * @brief Statistics collected while building and exporting an image, i.e.
+ * time spent in each phase, number of objects of each type and of the hidden ones
+ * skipped, and number of pixels written into the image or rejected for being out of its bounds
+ */
+class Stats
+{
+    /** Phases in the order they were first entered */
+    std::vector<std::pair<std::string, Timing>> phases;
+    std::map<std::string, size_t> object_counts;
+    size_t pixels_written = 0, pixels_rejected = 0;
+    /** Number of objects skipped for being hidden by the objects drawn over them */
+    size_t objects_culled = 0;
+
+public:
+    /**
+     * @brief Add time spent in a phase, time of phases entered
+     * repeatedly is summed up
+     *
+     * @param phase Name of the phase
+     * @param time Time spent in the phase
+     */
+    void add_time(const std::string &phase, const Timing &time);
+
+    /** Add number of objects of each type */
+    void add_object_counts(const std::map<std::string, size_t> &counts);
+
+    /**
+     * @brief Add number of pixels processed by an image
+     *
+     * @param written Number of pixels written
+     * @param rejected Number of pixels rejected for being out of bounds
+     */
+    void add_pixels(size_t written, size_t rejected);
+
+    /** Add number of objects skipped for being hidden by the objects drawn over them */
+    void add_culled_objects(size_t count);
+
+    /** Get peak resident set size of the process in bytes */
+    static long get_peak_rss();
+
+    /** Print the statistics as a human readable table */
+    void print(std::ostream &os) const;
+
+    /** Print the statistics as JSON */
+    void print_json(std::ostream &os) const;
+};
@@ -0,0 +1,158 @@
+/**
+ * @file trace.cpp
+ * @author Adam Berkeš <berkeada@fit.cvut.cz>
+ * @date 2026-10-19
+ */
+
+#include "trace.hpp"
+
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+using namespace std;
+
+namespace
+{
+    /** Finished span, times are in microseconds since tracing was enabled */
+    struct Event
+    {
+        const char *category;
+        string name;
+        double start, duration;
+    };
+
+    /** Spans recorded by a single thread, kept alive after the thread exits */
+    struct ThreadBuffer
+    {
+        int id;
+        string name;
+        vector<Event> events;
+    };
+
+    mutex buffers_mutex;
+    vector<shared_ptr<ThreadBuffer>> buffers;
+    chrono::steady_clock::time_point trace_start;
+
+    /** Get buffer of the calling thread, registering it on the first call */
+    ThreadBuffer &get_thread_buffer()
+    {
+        thread_local shared_ptr<ThreadBuffer> buffer;
+
+        if (!buffer)
+        {
+            lock_guard<mutex> lock(buffers_mutex);
+            buffer = make_shared<ThreadBuffer>();
+            buffer->id = static_cast<int>(buffers.size()) + 1;
+            buffers.push_back(buffer);
+        }
+
+        return *buffer;
+    }
+
+    /** Write the string as a JSON string literal */
+    void write_string(ostream &os, const string &str)
+    {
+        os << '"';
+
+        for (char c : str)
+        {
+            if (c == '"' || c == '\\')
+                os << '\\' << c;
+            else if (static_cast<unsigned char>(c) < 0x20)
+                os << "\\u" << hex << setw(4) << setfill('0') << static_cast<int>(c) << dec;
+            else
+                os << c;
+        }
+
+        os << '"';
+    }
+
+    /** Get number of microseconds since tracing was enabled */
+    double since_start(chrono::steady_clock::time_point time)
+    {
+        return chrono::duration<double, micro>(time - trace_start).count();
+    }
+}
+
+namespace trace
+{
+    atomic<bool> enabled = false;
+
+    void enable()
+    {
+        lock_guard<mutex> lock(buffers_mutex);
+
+        for (const shared_ptr<ThreadBuffer> &buffer : buffers)
+            buffer->events.clear();
+
+        trace_start = chrono::steady_clock::now();
+        enabled.store(true, memory_order_release);
+    }
+
+    void disable()
+    {
+        enabled.store(false, memory_order_release);
+    }
+
+    void set_thread_name(const string &name)
+    {
+        get_thread_buffer().name = name;
+    }
+
+    void write_json(ostream &os)
+    {
+        lock_guard<mutex> lock(buffers_mutex);
+        bool is_first = true;
+
+        auto separate = [&]()
+        {
+            os << (is_first ? "\n" : ",\n");
+            is_first = false;
+        };
+
+        os << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [" << fixed << setprecision(3);
+
+        for (const shared_ptr<ThreadBuffer> &buffer : buffers)
+        {
+            if (!buffer->name.empty())
+            {
+                separate();
+                os << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": "
+                   << buffer->id << ", \"args\": {\"name\": ";
+                write_string(os, buffer->name);
+                os << "}}";
+            }
+
+            for (const Event &event : buffer->events)
+            {
+                separate();
+                os << "{\"name\": ";
+                write_string(os, event.name);
+                os << ", \"cat\": \"" << event.category << "\", \"ph\": \"X\", \"ts\": "
+                   << event.start << ", \"dur\": " << event.duration
+                   << ", \"pid\": 1, \"tid\": " << buffer->id << '}';
+            }
+        }
+
+        os << "\n]}" << defaultfloat << endl;
+    }
+
+    void Span::begin(const char *category_, string name_)
+    {
+        category = category_;
+        name = std::move(name_);
+        is_active = true;
+        start = chrono::steady_clock::now();
+    }
+
+    void Span::end()
+    {
+        auto finish = chrono::steady_clock::now();
+
+        get_thread_buffer().events.push_back(
+            {category, std::move(name), since_start(start),
+             chrono::duration<double, micro>(finish - start).count()});
+    }
+}
@@ -0,0 +1,96 @@
+/**
+ * @file trace.hpp
+ * @author Adam Berkeš <berkeada@fit.cvut.cz>
+ * @date 2026-10-19
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <ostream>
+#include <string>
+#include <type_traits>
+
+/**
+ * @brief Recording of scoped spans in the Chrome trace event format, which
+ * can be viewed in chrome://tracing or Perfetto. Tracing is always compiled in,
+ * but while it's disabled a span costs only a single relaxed load of a flag
+ */
+namespace trace
+{
+    /** Whether the spans are being recorded, use is_enabled() to check it */
+    extern std::atomic<bool> enabled;
+
+    /** Check whether the spans are being recorded */
+    inline bool is_enabled()
+    {
+        return enabled.load(std::memory_order_relaxed);
+    }
+
+    /** Start recording spans, discarding all the previously recorded ones */
+    void enable();
+
+    /** Stop recording spans, the already recorded ones are kept */
+    void disable();
+
+    /** Name the calling thread in the trace */
+    void set_thread_name(const std::string &name);
+
+    /**
+     * @brief Write all the recorded spans of all the threads as a JSON trace,
+     * none of the threads may be recording spans at the moment
+     *
+     * @param os Output stream
+     */
+    void write_json(std::ostream &os);
+
+    /**
+     * @brief Span recorded from its construction until its destruction,
+     * spans of a single thread nest the same way as their scopes do
+     */
+    class Span
+    {
+        const char *category = nullptr;
+        std::string name;
+        std::chrono::steady_clock::time_point start;
+        bool is_active = false;
+
+        /** Start recording the span */
+        void begin(const char *category_, std::string name_);
+
+        /** Finish the span and store it into the buffer of the calling thread */
+        void end();
+
+    public:
+        /**
+         * @brief Construct a new Span object, which is recorded only if tracing is enabled
+         *
+         * @tparam Name Either a string, or a callable returning the name, which is
+         * called only if tracing is enabled, so that building the name costs nothing otherwise
+         * @param category_ Category of the span, e.g. "render"
+         * @param name_ Name of the span
+         */
+        template <typename Name>
+        Span(const char *category_, const Name &name_)
+        {
+            if (!is_enabled())
+                return;
+
+            if constexpr (std::is_invocable_v<const Name &>)
+                begin(category_, name_());
+            else
+                begin(category_, std::string(name_));
+        }
+
+        Span(const Span &) = delete;
+
+        Span &operator=(const Span &) = delete;
+
+        ~Span()
+        {
+            if (is_active)
+                end();
+        }
+    };
+}
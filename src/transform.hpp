@@ -0,0 +1,183 @@
+/**
+ * @file transform.hpp
+ * @author Adam Berkeš <berkeada@fit.cvut.cz>
+ * @date 2026-10-19
+ */
+
+#pragma once
+
+#include "vec2.hpp"
+
+#include <cmath>
+
+/**
+ * @brief Ellipse centered at the origin given by its radii and the rotation
+ * of its X-axis radius in radians, clockwise on the image
+ */
+struct EllipseAxes
+{
+    double radius_x, radius_y, rotation;
+
+    /** Get distance of the furthest points of the ellipse from its center in either axis */
+    Vec2<double> get_extent() const
+    {
+        double cos_rotation = std::cos(rotation), sin_rotation = std::sin(rotation);
+
+        return Vec2<double>(std::hypot(radius_x * cos_rotation, radius_y * sin_rotation),
+                            std::hypot(radius_x * sin_rotation, radius_y * cos_rotation));
+    }
+};
+
+/**
+ * @brief Two-dimensional affine transformation given by a 2x3 matrix
+ *
+ *     | xx xy tx |
+ *     | yx yy ty |
+ *
+ * which maps the point (x, y) onto (xx * x + xy * y + tx, yx * x + yy * y + ty).
+ * The Y-axis points down, so positive angles rotate clockwise on the image
+ */
+class Transform
+{
+public:
+    double xx = 1, xy = 0, yx = 0, yy = 1;
+    double tx = 0, ty = 0;
+
+    /** Construct the identity transformation */
+    Transform() = default;
+
+    /** Construct a transformation given by the elements of its matrix */
+    Transform(double xx_, double xy_, double yx_, double yy_, double tx_, double ty_)
+        : xx(xx_), xy(xy_), yx(yx_), yy(yy_), tx(tx_), ty(ty_){};
+
+    /** Construct a translation by given vector */
+    static Transform translation(double x, double y)
+    {
+        return Transform(1, 0, 0, 1, x, y);
+    }
+
+    /** Construct a scaling in either axis, negative factors reflect the objects */
+    static Transform scaling(const ScaleFactor &scale)
+    {
+        return Transform(scale.x, 0, 0, scale.y, 0, 0);
+    }
+
+    /** Construct a rotation around the origin by given angle in degrees */
+    static Transform rotation(double degrees)
+    {
+        double angle = degrees * M_PI / 180, cos_angle = std::cos(angle),
+               sin_angle = std::sin(angle);
+
+        return Transform(cos_angle, -sin_angle, sin_angle, cos_angle, 0, 0);
+    }
+
+    /**
+     * @brief Construct a skew, which tilts the Y-axis by the first angle towards
+     * the X-axis and the X-axis by the second angle towards the Y-axis
+     *
+     * @param degrees Angles in degrees along the X-axis and the Y-axis
+     */
+    static Transform skewing(const Vec2<double> &degrees)
+    {
+        return Transform(1, std::tan(degrees.x * M_PI / 180),
+                         std::tan(degrees.y * M_PI / 180), 1, 0, 0);
+    }
+
+    /** Compose the transformations, rhs is applied first and this one after it */
+    Transform operator*(const Transform &rhs) const
+    {
+        return Transform(xx * rhs.xx + xy * rhs.yx, xx * rhs.xy + xy * rhs.yy,
+                         yx * rhs.xx + yy * rhs.yx, yx * rhs.xy + yy * rhs.yy,
+                         xx * rhs.tx + xy * rhs.ty + tx, yx * rhs.tx + yy * rhs.ty + ty);
+    }
+
+    /** Get the transformation followed by a translation by the offset */
+    Transform translated(const Coords &offset) const
+    {
+        Transform res(*this);
+        res.tx += offset.x;
+        res.ty += offset.y;
+
+        return res;
+    }
+
+    /** Transform a point */
+    Vec2<double> apply(const Vec2<double> &point) const
+    {
+        return Vec2<double>(xx * point.x + xy * point.y + tx, yx * point.x + yy * point.y + ty);
+    }
+
+    /** Transform a direction, which isn't affected by the translation */
+    Vec2<double> apply_linear(const Vec2<double> &direction) const
+    {
+        return Vec2<double>(xx * direction.x + xy * direction.y,
+                            yx * direction.x + yy * direction.y);
+    }
+
+    /** Transform a point onto the pixel it falls into, the coordinates are truncated */
+    Coords map(const Coords &point) const
+    {
+        return Coords(xx * point.x + xy * point.y + tx, yx * point.x + yy * point.y + ty);
+    }
+
+    /** Check whether the transformation neither rotates nor skews the objects */
+    bool is_axis_aligned() const
+    {
+        return xy == 0 && yx == 0;
+    }
+
+    /**
+     * @brief Check whether the transformation keeps the shape of the objects, i.e. it only
+     * rotates, reflects and scales them uniformly, so that circles stay circles
+     */
+    bool is_conformal() const
+    {
+        // Composed rotations may differ in the last bits of their elements
+        double tolerance = 1e-9 * (std::abs(xx) + std::abs(xy) + std::abs(yx) + std::abs(yy));
+        auto is_near = [tolerance](double a, double b)
+        { return std::abs(a - b) <= tolerance; };
+
+        return (is_near(xx, yy) && is_near(xy, -yx)) || (is_near(xx, -yy) && is_near(xy, yx));
+    }
+
+    /**
+     * @brief Transform an axis-aligned ellipse centered at the origin, the result is given
+     * by its principal radii and their rotation. Transformations which are axis-aligned
+     * keep the sign of reflections and no rotation, so that they are rendered the same
+     * way as before they could rotate
+     *
+     * @param radius_x X-axis radius of the ellipse
+     * @param radius_y Y-axis radius of the ellipse
+     * @return EllipseAxes
+     */
+    EllipseAxes transform_ellipse(double radius_x, double radius_y) const
+    {
+        if (is_axis_aligned())
+            return {radius_x * xx, radius_y * yy, 0};
+
+        // Singular value decomposition of the matrix mapping the unit circle onto
+        // the ellipse, M = R(rotation) * diag(radius_x, radius_y) * R(angle)
+        double m_xx = xx * radius_x, m_xy = xy * radius_y, m_yx = yx * radius_x,
+               m_yy = yy * radius_y,
+               e = (m_xx + m_yy) / 2, f = (m_xx - m_yy) / 2,
+               g = (m_yx + m_xy) / 2, h = (m_yx - m_xy) / 2,
+               q = std::hypot(e, h), r = std::hypot(f, g);
+
+        return {q + r, std::abs(q - r), (std::atan2(h, e) + std::atan2(g, f)) / 2};
+    }
+
+    /**
+     * @brief Get scale of the objects in either axis. It keeps the sign of reflections
+     * of transformations which are axis-aligned, otherwise it's the length
+     * the unit vectors of the axes are transformed to
+     *
+     * @return ScaleFactor
+     */
+    ScaleFactor get_scale() const
+    {
+        if (is_axis_aligned())
+            return ScaleFactor(xx, yy);
+
+        return ScaleFactor(std::hypot(xx, yx), std::hypot(xy, yy));
+    }
+};
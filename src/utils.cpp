@@ -121,7 +121,7 @@ vector<Coords> utils::parse_vertices(const string &src, unsigned int min, unsign
     return res;
 }
 
-void utils::check_fstream(const fstream &stream, const string &filename)
+void utils::check_fstream(const ios &stream, const string &filename)
 {
     if ((stream.fail() || stream.bad()) && (!stream.eof()))
         throw runtime_error("error working with file: " + filename);
@@ -99,11 +99,11 @@ namespace utils
                                        unsigned int max = std::numeric_limits<int>::max());
 
     /**
-     * @brief Check for fails in fstream
+     * @brief Check for fails in a file stream, or any other stream
      *
      * @throws std::runtime_exception If something went wrong with the stream
      * @param stream Stream to be checked
      * @param filename Optional filename for prettier error message
      */
-    void check_fstream(const std::fstream &stream, const std::string &filename = "");
+    void check_fstream(const std::ios &stream, const std::string &filename = "");
 }
@@ -0,0 +1,158 @@
+/**
+ * @file work_stealing_pool.cpp
+ * @author Adam Berkeš <berkeada@fit.cvut.cz>
+ * @date 2026-10-19
+ */
+
+#include "work_stealing_pool.hpp"
+#include "trace.hpp"
+
+#include <algorithm>
+#include <string>
+
+using namespace std;
+
+/** Pool the calling thread is a worker of and its index in the pool */
+static thread_local const WorkStealingPool *current_pool = nullptr;
+static thread_local size_t current_worker = 0;
+
+WorkStealingPool::WorkStealingPool(size_t worker_count)
+{
+    if (worker_count == 0)
+        worker_count = max(thread::hardware_concurrency(), 1u);
+
+    for (size_t i = 0; i < worker_count; i++)
+        queues.push_back(make_unique<Queue>());
+
+    for (size_t i = 0; i < worker_count; i++)
+        workers.emplace_back(&WorkStealingPool::work, this, i);
+}
+
+WorkStealingPool::~WorkStealingPool()
+{
+    wait();
+
+    {
+        lock_guard<std::mutex> lock(mutex);
+        is_stopping = true;
+    }
+    task_queued.notify_all();
+
+    for (thread &worker : workers)
+        worker.join();
+}
+
+bool WorkStealingPool::reserve_task()
+{
+    size_t count = queued.load();
+
+    while (count > 0)
+        if (queued.compare_exchange_weak(count, count - 1))
+            return true;
+
+    return false;
+}
+
+bool WorkStealingPool::take_task(size_t worker, Task &task)
+{
+    for (size_t i = 0; i < queues.size(); i++)
+    {
+        Queue &queue = *queues[(worker + i) % queues.size()];
+        lock_guard<std::mutex> lock(queue.mutex);
+
+        if (queue.tasks.empty())
+            continue;
+
+        // The own queue is used as a stack, the stolen tasks are the oldest ones
+        if (i == 0)
+        {
+            task = std::move(queue.tasks.back());
+            queue.tasks.pop_back();
+        }
+        else
+        {
+            task = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+        }
+
+        return true;
+    }
+
+    return false;
+}
+
+void WorkStealingPool::work(size_t worker)
+{
+    current_pool = this;
+    current_worker = worker;
+    if (trace::is_enabled())
+        trace::set_thread_name("worker " + to_string(worker));
+
+    while (true)
+    {
+        if (!reserve_task())
+        {
+            // Submitters check the sleeping workers only after queueing, so a task
+            // queued after the check below always wakes this worker up
+            unique_lock<std::mutex> lock(mutex);
+            sleeping++;
+            task_queued.wait(lock, [this]()
+                             { return queued > 0 || is_stopping; });
+            sleeping--;
+
+            if (queued == 0)
+                return;
+
+            continue;
+        }
+
+        // The task was reserved above, so it's guaranteed to be found in one of the queues
+        Task task;
+        while (!take_task(worker, task))
+            this_thread::yield();
+
+        task();
+
+        if (pending.fetch_sub(1) == 1)
+        {
+            lock_guard<std::mutex> lock(mutex);
+            all_done.notify_all();
+        }
+    }
+}
+
+void WorkStealingPool::submit(Task task)
+{
+    size_t queue = current_pool == this ? current_worker : next_queue++ % queues.size();
+    pending++;
+
+    {
+        lock_guard<std::mutex> lock(queues[queue]->mutex);
+        queues[queue]->tasks.push_back(std::move(task));
+    }
+
+    queued++;
+    if (sleeping > 0)
+    {
+        // Locking makes sure the worker either sees the task or is already waiting
+        lock_guard<std::mutex> lock(mutex);
+        task_queued.notify_one();
+    }
+}
+
+void WorkStealingPool::wait()
+{
+    unique_lock<std::mutex> lock(mutex);
+    all_done.wait(lock, [this]()
+                  { return pending == 0; });
+}
+
+size_t WorkStealingPool::get_worker_count() const
+{
+    return workers.size();
+}
+
+size_t WorkStealingPool::get_worker_index() const
+{
+    return current_pool == this ? current_worker : workers.size();
+}
@@ -0,0 +1,98 @@
+/**
+ * @file work_stealing_pool.hpp
+ * @author Adam Berkeš <berkeada@fit.cvut.cz>
+ * @date 2026-10-19
+ */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Pool of worker threads, each of which has its own queue of tasks.
+ * A worker takes the most recently queued task from its own queue, and once
+ * it runs out of tasks it steals the oldest task of another worker, so that
+ * the workers stay busy even if some tasks take much longer than the others
+ */
+class WorkStealingPool
+{
+public:
+    using Task = std::function<void()>;
+
+private:
+    /** Queue of a single worker */
+    struct Queue
+    {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::thread> workers;
+    /**
+     * Taken only to put idle workers to sleep and wake them up, or to wait for
+     * all the tasks, the counters are atomic and the queues have their own mutexes
+     */
+    std::mutex mutex;
+    std::condition_variable task_queued, all_done;
+    /** Number of tasks waiting in the queues which no worker has reserved yet */
+    std::atomic<size_t> queued = 0;
+    /** Number of tasks which were submitted and haven't finished yet */
+    std::atomic<size_t> pending = 0;
+    /** Queue the next task submitted from outside of the pool is pushed into */
+    std::atomic<size_t> next_queue = 0;
+    /** Number of workers sleeping, or about to sleep, until a task is queued */
+    std::atomic<size_t> sleeping = 0;
+    /** Guarded by the mutex */
+    bool is_stopping = false;
+
+    /** Reserve one of the queued tasks, false if there are none */
+    bool reserve_task();
+
+    /** Take a task from the queue of the worker, or steal one from the other queues */
+    bool take_task(size_t worker, Task &task);
+
+    /** Run tasks until the pool is destroyed */
+    void work(size_t worker);
+
+public:
+    /**
+     * @brief Construct a new Work Stealing Pool object and start its workers
+     *
+     * @param worker_count Number of worker threads, 0 to use one per hardware thread
+     */
+    explicit WorkStealingPool(size_t worker_count = 0);
+
+    WorkStealingPool(const WorkStealingPool &) = delete;
+
+    WorkStealingPool &operator=(const WorkStealingPool &) = delete;
+
+    /** Finish all the submitted tasks and stop the workers */
+    ~WorkStealingPool();
+
+    /**
+     * @brief Submit a task to be run by one of the workers, the task must not throw.
+     * Tasks submitted from outside of the pool are distributed among the workers
+     * in turn, tasks submitted by a worker are pushed into its own queue
+     *
+     * @param task Task to be run
+     */
+    void submit(Task task);
+
+    /** Block until all the submitted tasks are finished */
+    void wait();
+
+    /** Get number of worker threads */
+    size_t get_worker_count() const;
+
+    /** Get index of the worker the calling thread is, or get_worker_count() if it isn't one */
+    size_t get_worker_index() const;
+};
@@ -6,7 +6,10 @@
 
 #include "../src/utils.hpp"
 #include "../src/vec2.hpp"
+#include "../src/work_stealing_pool.hpp"
 
+#include <atomic>
+#include <cassert>
 #include <iostream>
 #include <stdexcept>
 #include <vector>
@@ -18,6 +21,30 @@ int main()
 {
     cout << "TESTING: utils" << endl;
 
+    // Tasks submitted by the workers themselves are finished before wait() returns
+    atomic<int> finished = 0;
+    {
+        WorkStealingPool pool(4);
+        assert(pool.get_worker_count() == 4 && pool.get_worker_index() == 4);
+
+        for (int i = 0; i < 100; i++)
+            pool.submit(
+                [&]()
+                {
+                    assert(pool.get_worker_index() < 4);
+                    for (int j = 0; j < 10; j++)
+                        pool.submit([&]()
+                                    { finished++; });
+                    finished++;
+                });
+        pool.wait();
+        assert(finished == 1100);
+
+        pool.submit([&]()
+                    { finished++; });
+    }
+    assert(finished == 1101);
+
     fstream stream = try_open_file("zadani.txt");
     try
     {
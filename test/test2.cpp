@@ -4,11 +4,36 @@
  * @date 2023-06-03
  */
 
+#include "../src/application/render_server.hpp"
 #include "../src/image/pixel.hpp"
 #include "../src/image/image.hpp"
+#include "../src/image/image_builder.hpp"
+#include "../src/image/span_fill.hpp"
+#include "../src/encoder/bmp_encoder.hpp"
+#include "../src/encoder/png_encoder.hpp"
+#include "../src/encoder/ppm_encoder.hpp"
+#include "../src/object/circle.hpp"
+#include "../src/object/curve.hpp"
+#include "../src/object/ellipse.hpp"
+#include "../src/object/line.hpp"
+#include "../src/object/path.hpp"
+#include "../src/object/rectangle.hpp"
+#include "../src/object/spiral.hpp"
+#include "../src/object/stylable_object.hpp"
 
+#include <cassert>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
 #include <iostream>
+#include <map>
+#include <memory>
+#include <sstream>
 #include <stdexcept>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <thread>
+#include <unistd.h>
 
 using namespace std;
 
@@ -59,6 +84,697 @@ int main()
         assert(false);
     }
 
+    Image bg(301, 7, Pixel("#123456"));
+    for (int y = 0; y < bg.get_height(); y++)
+        for (int x = 0; x < bg.get_width(); x++)
+            assert(bg.get_buffer()(x, y).r == 0x12 && bg.get_buffer()(x, y).g == 0x34 &&
+                   bg.get_buffer()(x, y).b == 0x56);
+
+    // Spans of various lengths and alignments, partially outside of the image
+    for (int x = -40; x < 300; x += 37)
+        for (int length : {0, 1, 15, 16, 17, 63, 64, 65, 200, 400})
+        {
+            Image filled(301, 3), expected(301, 3);
+            filled.get_buffer().fill_span(x, 1, length, Pixel(1, 2, 3));
+            for (int i = 0; i < length; i++)
+                expected.get_buffer().set_pixel(x + i, 1, Pixel(1, 2, 3));
+            for (int y = 0; y < 3; y++)
+                for (int i = 0; i < 301; i++)
+                {
+                    Pixel a = filled.get_buffer()(i, y), b = expected.get_buffer()(i, y);
+                    assert(a.r == b.r && a.g == b.g && a.b == b.b);
+                }
+        }
+
+    Image rect(100, 100);
+    rect.get_buffer().fill_rect(-10, 90, 200, 50, Pixel(9, 9, 9));
+    rect.get_buffer().fill_rect(10, 10, 5, 5, Pixel(7, 7, 7));
+    assert(rect.get_buffer()(0, 89).r == 0 && rect.get_buffer()(0, 90).r == 9);
+    assert(rect.get_buffer()(99, 99).r == 9);
+    assert(rect.get_buffer()(10, 10).r == 7 && rect.get_buffer()(14, 14).r == 7);
+    assert(rect.get_buffer()(15, 14).r == 0 && rect.get_buffer()(14, 15).r == 0);
+
+    // Translucent colors are composited over the pixels, opaque ones overwrite them
+    Color translucent("#ff804080");
+    assert(translucent == Color(255, 128, 64, 128) && Color("#f84c") == Color(255, 136, 68, 204));
+    assert(Color("#123") == Color(Pixel("#123")) && Color("#123456").is_opaque());
+    for (const char *invalid : {"#12345", "#1234567", "#12345g7f", "#123g"})
+    {
+        try
+        {
+            Color color(invalid);
+            assert(false);
+        }
+        catch (const invalid_argument &e)
+        {
+        }
+    }
+    for (int length : {1, 15, 16, 17, 31, 32, 33, 100, 301})
+    {
+        Image blended(301, 1, Pixel("#204060"));
+        blended.get_buffer().fill_span(0, 0, length, translucent);
+        for (int x = 0; x < 301; x++)
+        {
+            Pixel expected = x < length ? Pixel(128 + div255(0x20 * 127), 64 + div255(0x40 * 127),
+                                                32 + div255(0x60 * 127))
+                                        : Pixel("#204060");
+            assert(blended.get_buffer()(x, 0) == expected);
+        }
+    }
+    Image overlay(4, 1, Color(0, 0, 0, 0));
+    assert(overlay.get_buffer().has_alpha() && !bg.get_buffer().has_alpha());
+    overlay.get_buffer().set_pixel(0, 0, translucent);
+    overlay.get_buffer().set_pixel(1, 0, translucent);
+    overlay.get_buffer().set_pixel(1, 0, translucent);
+    overlay.get_buffer().set_pixel(2, 0, Pixel(1, 2, 3));
+    assert(overlay.get_buffer().get_alpha(0, 0) == 128 && overlay.get_buffer().get_alpha(1, 0) == 192);
+    assert(overlay.get_buffer()(0, 0) == translucent.get_premultiplied());
+    assert(overlay.get_buffer().get_alpha(2, 0) == 255 && overlay.get_buffer()(2, 0) == Pixel(1, 2, 3));
+    assert(overlay.get_buffer().get_alpha(3, 0) == 0 && overlay.get_buffer()(3, 0) == Pixel());
+
+    // Image covering only a part of the canvas
+    Image part(10, 10, Pixel(), Coords(20, 30));
+    assert(part.get_buffer().set_pixel(25, 35, Pixel(5, 5, 5)));
+    assert(!part.get_buffer().set_pixel(5, 5, Pixel(5, 5, 5)));
+    assert(!part.get_buffer().set_pixel(30, 35, Pixel(5, 5, 5)));
+    assert(part.get_buffer()(5, 5).r == 5);
+    part.get_buffer().fill_rect(0, 0, 22, 32, Pixel(6, 6, 6));
+    assert(part.get_buffer()(1, 1).r == 6 && part.get_buffer()(2, 2).r == 0);
+    part.reset(Coords(0, 0));
+    assert(part.get_buffer()(5, 5).r == 0 && part.get_buffer()(1, 1).r == 0);
+    assert(part.get_bounds().min == Coords(0, 0) && part.get_bounds().max == Coords(10, 10));
+
+    // Pixels drawn out of bounds are counted as rejected
+    Image counted(10, 10);
+    counted.get_buffer().set_pixel(5, 5, Pixel(1, 1, 1));
+    counted.get_buffer().set_pixel(-1, 5, Pixel(1, 1, 1));
+    counted.get_buffer().fill_rect(8, 8, 4, 4, Pixel(1, 1, 1));
+    assert(counted.get_buffer().get_pixels_written() == 5);
+    assert(counted.get_buffer().get_pixels_rejected() == 13);
+
+    // Streamed rendering has to produce the same output as the full one
+    auto add_objects = [](ImageBuilder &builder)
+    {
+        builder
+            .add_object(*Line::parse_from_str("((-10,5);(130,90)) width=3"))
+            .add_object(*Circle::parse_from_str("(60,50) radius=40 width=5 color=#f00"))
+            .add_object(*Rectangle::parse_from_str("((5,60);(100,95)) width=2 color=#0f0"));
+    };
+    PPMEncoder ppm;
+    BMPEncoder bmp;
+    PNGEncoder png;
+    for (const Encoder *encoder : {static_cast<const Encoder *>(&ppm),
+                                   static_cast<const Encoder *>(&bmp),
+                                   static_cast<const Encoder *>(&png)})
+    {
+        ImageBuilder full(123, 97, Pixel("#203040")), streamed(123, 97, Pixel("#203040"));
+        stringstream expected;
+        add_objects(full);
+        add_objects(streamed);
+        full.render();
+        assert((full.count_objects() ==
+                map<string, size_t>{{"circle", 1}, {"line", 1}, {"rectangle", 1}}));
+        encoder->encode(expected, full.get_image());
+
+        for (int band_height : {1, 8, 50, 97, 500})
+        {
+            stringstream out;
+            streamed.render_streamed(*encoder, out, band_height);
+            assert(out.str() == expected.str());
+        }
+    }
+
+    // Bands of outlines filled by coverage have to get exactly the same cells as the whole image,
+    // including the pixels covered by exactly a half, e.g. at the start of the spiral
+    ObjectRegistry stroked_objects;
+    stroked_objects
+        .add("spiral", Spiral::parse_from_str)
+        .add("path", Path::parse_from_str);
+    for (const string &scene : {string("image 200 200 background=#fff\n"
+                                       "spiral (100,100) rotations=3 width=5 color=#000\n"),
+                                string("image 150 120 background=#fff\n"
+                                       "path (M(10,10);L(140,30);Q(150,110)(20,100);Z) width=7 "
+                                       "join=round color=#00f8\n"
+                                       "path (M(-20,60);Q(75,-40)(170,60);L(75,119)) width=4 "
+                                       "cap=square\n")})
+        for (int factor : {1, 2})
+            for (bool antialiased : {false, true})
+            {
+                istringstream is(scene);
+                ImageBuilder stroked(stroked_objects, is);
+                stroked.set_supersampling(factor);
+                stroked.set_antialiased(antialiased);
+                stringstream expected;
+                stroked.render();
+                ppm.encode(expected, stroked.get_image());
+
+                for (int band_height : {1, 3, 7, 37})
+                {
+                    stringstream out;
+                    stroked.render_streamed(ppm, out, band_height);
+                    assert(out.str() == expected.str());
+                }
+            }
+
+    // Translucent backgrounds are kept in PNG, which stores the channels not premultiplied
+    ImageBuilder transparent(3, 2, Color("#0000")), transparent_streamed(3, 2, Color("#0000"));
+    for (ImageBuilder *builder : {&transparent, &transparent_streamed})
+        builder->add_object(*Line::parse_from_str("((0,0);(2,0)) color=#ff000080"));
+    stringstream transparent_png, transparent_streamed_png;
+    transparent.render();
+    png.encode(transparent_png, transparent.get_image());
+    transparent_streamed.render_streamed(png, transparent_streamed_png, 1);
+    assert(transparent_png.str() == transparent_streamed_png.str());
+    // Color type of the IHDR chunk
+    assert(transparent_png.str()[25] == PNG_COLOR_TYPE_RGBA);
+    assert(!transparent.map_image(ppm, "unused.ppm"));
+
+    // Images rendered into the mapped output file have to be encoded identically
+    // to the raw variant of the format, PPM is binary only when it's mapped
+    for (const Encoder *encoder : {static_cast<const Encoder *>(&ppm),
+                                   static_cast<const Encoder *>(&bmp)})
+    {
+        filesystem::path file = filesystem::temp_directory_path() / "shapescape_test2_mapped";
+        ImageBuilder full(123, 97, Pixel("#203040")), mapped(123, 97, Pixel("#203040"));
+        stringstream expected, expected_raw;
+        add_objects(full);
+        add_objects(mapped);
+        full.render();
+        encoder->encode(expected, full.get_image());
+        auto raw_writer = encoder->open_raw(expected_raw, 123, 97);
+        encoder->write_rows(*raw_writer, full.get_image(), 97);
+        raw_writer->finish();
+        assert((expected.str() == expected_raw.str()) == (encoder == &bmp));
+        assert(expected.str().substr(0, 2) == (encoder == &bmp ? "BM" : "P3"));
+
+        assert(mapped.map_image(*encoder, file));
+        mapped.render();
+        assert(!mapped.map_image(*encoder, file));
+        assert(mapped.get_image().get_buffer()(60, 10).r == full.get_image().get_buffer()(60, 10).r);
+        encoder->encode_to_file(file, mapped.get_image());
+
+        fstream in(file, ios_base::in | ios_base::binary);
+        stringstream encoded;
+        encoded << in.rdbuf();
+        assert(encoded.str() == expected_raw.str());
+
+        // Copies of the mapped image are stored in memory
+        Image copy = mapped.get_image();
+        assert(copy.get_buffer().get_mapping() == nullptr);
+        stringstream copy_encoded;
+        encoder->encode(copy_encoded, copy);
+        assert(copy_encoded.str() == expected.str());
+
+        filesystem::remove(file);
+    }
+    assert(!ImageBuilder(10, 10).map_image(png, "unused.png"));
+
+    ObjectRegistry registry;
+    registry
+        .add("line", Line::parse_from_str)
+        .add("circle", Circle::parse_from_str);
+
+    // Only the regions of the changed objects are rendered again, producing the same image
+    auto parse_scene = [&](const string &scene)
+    {
+        istringstream is(scene);
+        return make_unique<ImageBuilder>(registry, is);
+    };
+    const string watched_scene = "image 100 80 background=#123\n"
+                                 "start_group cross\n"
+                                 "    line ((0,0);(10,10))\n"
+                                 "    line ((10,0);(0,10))\n"
+                                 "end_group\n"
+                                 "circle (20,20) radius=10\n"
+                                 "line ((0,40);(99,40)) width=3 color=#f00\n"
+                                 "cross (60,60) scale=(2,2)\n"
+                                 "circle (70,20) radius=5\n";
+    auto previous = parse_scene(watched_scene);
+    previous->render();
+    const string circle = "circle (20,20) radius=10\n", line = "line ((0,40);(99,40)) width=3 color=#f00\n";
+    for (const auto &[from, to] : {pair<string, string>("radius=5", "radius=7"),
+                                   pair<string, string>("#f00", "#0f0"),
+                                   pair<string, string>("(10,0);(0,10)", "(10,0);(0,9)"),
+                                   pair<string, string>(circle + line, line + circle)})
+    {
+        string changed_scene = watched_scene;
+        changed_scene.replace(changed_scene.find(from), from.size(), to);
+        auto next = parse_scene(changed_scene), full = parse_scene(changed_scene);
+
+        Rect dirty = next->render_incrementally(*previous);
+        assert(!dirty.is_empty() && dirty.get_width() * dirty.get_height() < 100 * 80);
+        full->render();
+        for (int y = 0; y < 80; y++)
+            for (int x = 0; x < 100; x++)
+                assert(next->get_image().get_buffer()(x, y) == full->get_image().get_buffer()(x, y));
+
+        assert(parse_scene(changed_scene)->render_incrementally(*next).is_empty());
+        previous = parse_scene(watched_scene);
+        previous->render();
+    }
+
+    // Objects added, removed or replaced after a render give the same image as a fresh builder
+    auto assert_same_image = [](ImageBuilder &a, ImageBuilder &b)
+    {
+        a.render();
+        b.render();
+        for (int y = 0; y < 80; y++)
+            for (int x = 0; x < 100; x++)
+                assert(a.get_image().get_buffer()(x, y) == b.get_image().get_buffer()(x, y));
+    };
+    const Circle small(StylableObject::Style(2, Pixel("#f00")), Coords(30, 30), 8),
+        big(StylableObject::Style(1, Pixel("#0f0")), Coords(40, 30), 15);
+    const Line diagonal(StylableObject::Style(3, Pixel("#00f")), Coords(0, 0), Coords(99, 79));
+    ImageBuilder edited(100, 80, Pixel("#123")), fresh(100, 80, Pixel("#123"));
+    edited.add_object(small).render();
+    edited.add_object(diagonal);
+    fresh.add_object(small).add_object(diagonal);
+    assert_same_image(edited, fresh);
+    edited.add_object(big).replace_object(0, big).remove_object(1).render();
+    ImageBuilder expected(100, 80, Pixel("#123"));
+    expected.add_object(big).add_object(big);
+    assert(edited.get_object_count() == 2);
+    assert_same_image(edited, expected);
+    edited.remove_object(1).remove_object(0);
+    ImageBuilder empty(100, 80, Pixel("#123"));
+    assert_same_image(edited, empty);
+    try
+    {
+        edited.remove_object(0);
+        assert(false);
+    }
+    catch (const invalid_argument &e)
+    {
+    }
+
+    // Memory of the replaced and removed objects is reused, so editing doesn't grow it
+    struct CountingResource : pmr::memory_resource
+    {
+        size_t allocated = 0;
+
+        void *do_allocate(size_t bytes, size_t alignment) override
+        {
+            allocated += bytes;
+            return pmr::new_delete_resource()->allocate(bytes, alignment);
+        }
+
+        void do_deallocate(void *p, size_t bytes, size_t alignment) override
+        {
+            allocated -= bytes;
+            pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+        }
+
+        bool do_is_equal(const pmr::memory_resource &other) const noexcept override
+        {
+            return this == &other;
+        }
+    } counting;
+    {
+        ImageBuilder long_edited(100, 80, Pixel("#123"), &counting);
+        long_edited.add_object(small).add_object(diagonal);
+        size_t allocated = counting.allocated;
+        for (int i = 0; i < 10000; i++)
+            long_edited.replace_object(0, i % 2 ? small : big).remove_object(1).add_object(diagonal);
+        assert(counting.allocated == allocated);
+    }
+    assert(counting.allocated == 0);
+
+    // Clip masks keep runs of opaque pixels of each row
+    Image mask_image(10, 4, Color(0, 0, 0, 0));
+    for (int x : {1, 2, 3, 7})
+        mask_image.get_buffer().set_pixel(x, 1, Color("#fff"));
+    mask_image.get_buffer().set_pixel(5, 1, Color("#ffffff40"));
+    ClipMask mask = ClipMask::from_alpha(mask_image);
+    assert(mask.get_span_count() == 2);
+    assert(mask.contains(1, 1) && mask.contains(3, 1) && mask.contains(7, 1));
+    assert(!mask.contains(4, 1) && !mask.contains(5, 1) && !mask.contains(1, 0));
+    // Masks rendered strip by strip are the same as the ones rendered at once
+    ClipMask appended;
+    Image mask_strip(10, 3, Color(0, 0, 0, 0));
+    mask_strip.get_buffer().set_pixel(2, 1, Color("#fff"));
+    appended.append_alpha(mask_strip, 2);
+    mask_strip.reset(Coords(0, 2));
+    mask_strip.get_buffer().set_pixel(7, 3, Color("#fff"));
+    appended.append_alpha(mask_strip, 3);
+    assert(appended.get_span_count() == 2 && appended.contains(2, 1) && appended.contains(7, 3));
+    assert(!appended.contains(2, 2) && !appended.contains(7, 1));
+    try
+    {
+        appended.append_alpha(mask_strip, 3);
+        assert(false);
+    }
+    catch (const invalid_argument &e)
+    {
+    }
+    try
+    {
+        ClipMask::from_alpha(Image(10, 4, Pixel("#fff")));
+        assert(false);
+    }
+    catch (const invalid_argument &e)
+    {
+    }
+
+    // Clipped objects are drawn only inside the region covered by the group
+    const string clipped_scene = "image 100 80 background=#123\n"
+                                 "start_group disk\n"
+                                 "    circle (50,40) radius=15 width=30\n"
+                                 "end_group\n"
+                                 "start_group cross\n"
+                                 "    line ((0,0);(10,10))\n"
+                                 "    line ((10,0);(0,10))\n"
+                                 "end_group\n"
+                                 "line ((0,40);(99,40)) width=20 color=#f00 clip=disk\n"
+                                 "cross (0,0) scale=(10,8) clip=disk\n";
+    auto clipped = parse_scene(clipped_scene);
+    clipped->render();
+    const auto &clipped_buffer = clipped->get_image().get_buffer();
+    assert(clipped_buffer(60, 45) == Pixel("#f00") && clipped_buffer(30, 24) != Pixel("#123"));
+    assert(clipped_buffer(5, 40) == Pixel("#123") && clipped_buffer(94, 40) == Pixel("#123"));
+    assert(clipped_buffer(10, 8) == Pixel("#123") && clipped_buffer(90, 72) == Pixel("#123"));
+    assert(clipped_buffer.get_clip() == nullptr && clipped_buffer.get_pixels_rejected() > 0);
+    stringstream clipped_expected, clipped_streamed;
+    ppm.encode(clipped_expected, clipped->get_image());
+    parse_scene(clipped_scene)->render_streamed(ppm, clipped_streamed, 7);
+    assert(clipped_streamed.str() == clipped_expected.str());
+    for (const string &invalid : {string("image 10 10\nline ((0,0);(9,9)) clip=nothing\n"),
+                                  string("image 10 10\nstart_group a\n    line ((0,0);(9,9))\n"
+                                         "end_group\nstart_group b\n"
+                                         "    line ((0,0);(9,9)) clip=a\nend_group\n")})
+        try
+        {
+            parse_scene(invalid);
+            assert(false);
+        }
+        catch (const invalid_argument &e)
+        {
+        }
+
+    // Objects hidden by filled rectangles and discs drawn over them are skipped
+    registry.add("rectangle", Rectangle::parse_from_str);
+    const string occluded_scene = "image 100 80 background=#123\n"
+                                  "circle (30,25) radius=10\n"
+                                  "line ((0,40);(99,40)) width=3 color=#f00\n"
+                                  "circle (70,50) radius=3 width=2 color=#0f0\n"
+                                  "line ((40,0);(40,79)) color=#00f8\n"
+                                  "rectangle ((10,10);(90,70)) width=60 color=#fff\n"
+                                  "circle (70,50) radius=0 width=20 color=#f0f\n"
+                                  "rectangle ((20,20);(80,60)) width=5 color=#ff0\n";
+    for (int factor : {1, 2})
+        for (bool antialiased : {false, true})
+        {
+            Stats occluded_stats;
+            istringstream occluded_stream(occluded_scene);
+            ImageBuilder occluded(registry, occluded_stream, &occluded_stats);
+            auto unculled = parse_scene(occluded_scene);
+            for (ImageBuilder *builder : {&occluded, unculled.get()})
+            {
+                builder->set_supersampling(factor);
+                builder->set_antialiased(antialiased);
+            }
+            // Streamed rendering draws all the objects intersecting each band
+            occluded.render();
+            stringstream occluded_encoded, unculled_encoded, stats_json;
+            ppm.encode(occluded_encoded, occluded.get_image());
+            unculled->render_streamed(ppm, unculled_encoded, 80);
+            assert(occluded_encoded.str() == unculled_encoded.str());
+            // Each output adds its pixels, but the objects of the scene are counted once
+            for (int output = 0; output < 2; output++)
+            {
+                stringstream streamed;
+                occluded.render_streamed(ppm, streamed, 7);
+                occluded.render();
+            }
+            occluded_stats.print_json(stats_json);
+            assert(stats_json.str().find("\"objects_culled\": 3,") != string::npos);
+            assert(stats_json.str().find("\"objects\": {\"circle\": 3, \"line\": 2, "
+                                         "\"rectangle\": 2}") != string::npos);
+        }
+
+    // Frames of an animation are the same as the scenes with the interpolated parameters
+    const string cross = "start_group cross\n"
+                         "    line ((0,0);(10,10))\n"
+                         "    line ((10,0);(0,10))\n"
+                         "end_group\n";
+    auto animation = parse_scene("image 100 80 background=#123 frames=5\n" + cross +
+                                 "line ((0,40);(99,40)) width=3 color=#f00\n"
+                                 "circle (20,20) radius=10 color=#000\n"
+                                 "animate radius 0:10 4:30\n"
+                                 "animate color 2:#0f0\n"
+                                 "cross (60,60)\n"
+                                 "animate offset 0:(0,0) 4:(-20,-40)\n"
+                                 "animate scale 0:(1,1) 2:(2,3)\n"
+                                 "circle (70,20) radius=5\n");
+    assert(animation->get_frame_count() == 5);
+    const map<size_t, string> expected_frames = {
+        {0, "circle (20,20) radius=10 color=#0f0\n"
+            "cross (60,60)\n"},
+        {1, "circle (20,20) radius=15 color=#0f0\n"
+            "cross (55,50) scale=(1.5,2)\n"},
+        {4, "circle (20,20) radius=30 color=#0f0\n"
+            "cross (40,20) scale=(2,3)\n"}};
+    for (const auto &[frame, animated] : expected_frames)
+    {
+        Image rendered = animation->render_frame(frame);
+        auto expected_frame = parse_scene("image 100 80 background=#123\n" + cross +
+                                          "line ((0,40);(99,40)) width=3 color=#f00\n" +
+                                          animated + "circle (70,20) radius=5\n");
+        expected_frame->render();
+        for (int y = 0; y < 80; y++)
+            for (int x = 0; x < 100; x++)
+                assert(rendered.get_buffer()(x, y) ==
+                       expected_frame->get_image().get_buffer()(x, y));
+    }
+    // Frames rendered in parallel are profiled together with the base layer they share
+    auto profiled_animation = parse_scene("image 100 80 background=#123 frames=5\n" + cross +
+                                          "line ((0,40);(99,40)) width=3 color=#f00\n"
+                                          "circle (20,20) radius=10 color=#000\n"
+                                          "animate radius 0:10 4:30\n");
+    ObjectProfile frames_profile;
+    profiled_animation->set_profile(&frames_profile);
+    thread other_frame([&]()
+                       { profiled_animation->render_frame(1); });
+    profiled_animation->render_frame(3);
+    other_frame.join();
+    assert(frames_profile.get_lines().at(6).renders == 1);
+    assert(frames_profile.get_lines().at(7).renders == 2);
+    for (const char *invalid : {"animate radius 0:10\n", "line ((0,0);(1,1))\nanimate radius 0:1\n",
+                                "circle (1,1) radius=1\nanimate radius 5:1\n",
+                                "circle (1,1) radius=1\nanimate radius 2:1 1:3\n",
+                                "circle (1,1) radius=1\nanimate offset 0:(1,1)\nanimate offset 1:(2,2)\n"})
+    {
+        try
+        {
+            parse_scene("image 10 10 frames=5\n" + string(invalid));
+            assert(false);
+        }
+        catch (const invalid_argument &e)
+        {
+        }
+    }
+
+    // Anti-aliased axis-aligned lines cover exactly the pixels of the aliased ones
+    ImageBuilder aliased_lines(100, 80, Pixel("#fff")), smooth_lines(100, 80, Pixel("#fff"));
+    smooth_lines.set_antialiased(true);
+    for (ImageBuilder *builder : {&aliased_lines, &smooth_lines})
+        builder->add_object(*Line::parse_from_str("((5,10);(35,10)) width=3"))
+            .add_object(*Line::parse_from_str("((20,2);(20,28)) width=2 color=#f00"));
+    assert_same_image(aliased_lines, smooth_lines);
+
+    // Edges get partial opacity, while the covered area stays the same
+    ImageBuilder smooth(100, 80, Pixel("#fff"));
+    smooth.set_antialiased(true);
+    smooth.add_object(*Line::parse_from_str("((10,10);(90,50)) width=4 color=#000")).render();
+    double covered = 0;
+    size_t partial = 0;
+    for (int y = 0; y < 80; y++)
+        for (int x = 0; x < 100; x++)
+        {
+            unsigned char value = smooth.get_image().get_buffer()(x, y).r;
+            covered += (255 - value) / 255.0;
+            partial += value != 0 && value != 255;
+        }
+    assert(abs(covered - hypot(80, 40) * 4) < 4);
+    assert(partial > 100);
+
+    // Anti-aliased objects are clipped to bands and regions rendered again without seams
+    auto add_smooth_objects = [&](ImageBuilder &builder)
+    {
+        builder.set_antialiased(true);
+        add_objects(builder);
+        builder
+            .add_object(*Curve::parse_from_str("((0,90);(60,-40);(120,90)) width=2 color=#ff0"))
+            .add_object(*Ellipse::parse_from_str("(60,50) radius_x=50 radius_y=20 color=#0ff8"));
+    };
+    ImageBuilder smooth_full(123, 97, Pixel("#203040")), smooth_streamed(123, 97, Pixel("#203040"));
+    add_smooth_objects(smooth_full);
+    add_smooth_objects(smooth_streamed);
+    smooth_full.render();
+    stringstream smooth_expected;
+    ppm.encode(smooth_expected, smooth_full.get_image());
+    for (int band_height : {1, 7, 97})
+    {
+        stringstream out;
+        smooth_streamed.render_streamed(ppm, out, band_height);
+        assert(out.str() == smooth_expected.str());
+    }
+    ImageBuilder smooth_edited(100, 80, Pixel("#123")), smooth_fresh(100, 80, Pixel("#123"));
+    smooth_edited.set_antialiased(true);
+    smooth_fresh.set_antialiased(true);
+    smooth_edited.add_object(small).add_object(diagonal).add_object(big).render();
+    smooth_edited.remove_object(1).render();
+    smooth_fresh.add_object(small).add_object(big);
+    assert_same_image(smooth_edited, smooth_fresh);
+
+    // Downsampling averages blocks of samples, the vectorized row sums match scalar ones
+    for (size_t factor : {2, 4})
+    {
+        const size_t count = 37, channels = 3, width = count * factor * channels;
+        vector<vector<unsigned char>> samples(factor, vector<unsigned char>(width));
+        vector<const unsigned char *> rows;
+        for (size_t row = 0; row < factor; row++)
+        {
+            for (size_t i = 0; i < width; i++)
+                samples[row][i] = static_cast<unsigned char>((i * 31 + row * 97) % 256);
+            rows.push_back(samples[row].data());
+        }
+
+        vector<unsigned char> averaged(count * channels);
+        span_fill::downsample(rows.data(), factor, channels, count, averaged.data());
+        for (size_t block = 0; block < count; block++)
+            for (size_t channel = 0; channel < channels; channel++)
+            {
+                size_t sum = 0;
+                for (size_t row = 0; row < factor; row++)
+                    for (size_t i = 0; i < factor; i++)
+                        sum += samples[row][(block * factor + i) * channels + channel];
+                assert(averaged[block * channels + channel] ==
+                       (sum + factor * factor / 2) / (factor * factor));
+            }
+    }
+
+    // Supersampled images keep their size, and are streamed the same as rendered at once
+    auto add_supersampled_objects = [&](ImageBuilder &builder)
+    {
+        builder.set_supersampling(4);
+        add_smooth_objects(builder);
+    };
+    ImageBuilder supersampled_full(123, 97, Pixel("#203040")),
+        supersampled_streamed(123, 97, Pixel("#203040"));
+    add_supersampled_objects(supersampled_full);
+    add_supersampled_objects(supersampled_streamed);
+    supersampled_full.render();
+    assert(supersampled_full.get_image().get_output_width() == 123 &&
+           supersampled_full.get_image().get_output_height() == 97);
+    stringstream supersampled_expected;
+    ppm.encode(supersampled_expected, supersampled_full.get_image());
+    assert(supersampled_expected.str().find("P3\n123 97\n255\n") == 0);
+    assert(supersampled_expected.str() != smooth_expected.str());
+    for (int band_height : {1, 13})
+    {
+        stringstream out;
+        supersampled_streamed.render_streamed(ppm, out, band_height);
+        assert(out.str() == supersampled_expected.str());
+    }
+
+    // Supersampled backgrounds stay exact and the images aren't mapped onto the output
+    ImageBuilder plain(10, 10, Pixel("#abc")), plain_supersampled(10, 10, Pixel("#abc"));
+    plain_supersampled.set_supersampling(2);
+    assert(!plain_supersampled.map_image(ppm, (filesystem::temp_directory_path() /
+                                               "shapescape_test2_ssaa.ppm").string()));
+    stringstream plain_expected, plain_out;
+    plain.render();
+    plain_supersampled.render();
+    ppm.encode(plain_expected, plain.get_image());
+    ppm.encode(plain_out, plain_supersampled.get_image());
+    assert(plain_out.str() == plain_expected.str());
+    for (int factor : {0, 3, 8})
+    {
+        try
+        {
+            plain.set_supersampling(factor);
+            assert(false);
+        }
+        catch (const invalid_argument &e)
+        {
+        }
+    }
+
+    // The server renders scenes received over the socket the same way as the builder
+    EncoderRegistry encoders;
+    encoders.add("ppm", ppm);
+    const string scene = "image 64 48 background=#102030\n"
+                         "line ((0,0);(63,47)) width=3\n"
+                         "circle (30,20) radius=10 color=#f00\n";
+    string socket_path = (filesystem::temp_directory_path() / "shapescape_test2.sock").string();
+    RenderServer server(registry, encoders, socket_path, 1, 4, 0, false, 1, 10000);
+    // Only the request log is written to the server's stderr, errors go to the client
+    ostringstream server_log;
+    streambuf *cerr_buffer = cerr.rdbuf(server_log.rdbuf());
+    thread server_thread([&]()
+                         { server.run(); });
+
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    socket_path.copy(address.sun_path, sizeof(address.sun_path) - 1);
+    auto connect_client = [&]()
+    {
+        int client = socket(AF_UNIX, SOCK_STREAM, 0);
+        assert(connect(client, reinterpret_cast<sockaddr *>(&address), sizeof(address)) == 0);
+        return client;
+    };
+    int fd = connect_client();
+
+    auto request = [&](const string &format, const string &body)
+    {
+        string message = format + ' ' + to_string(body.size()) + '\n' + body, response;
+        assert(send(fd, message.data(), message.size(), 0) == static_cast<ssize_t>(message.size()));
+
+        char c;
+        while (recv(fd, &c, 1, 0) == 1 && c != '\n')
+            response += c;
+
+        size_t size = stoul(response.substr(response.find(' ') + 1));
+        string data(size, '\0');
+        for (size_t read = 0; read < size;)
+            read += recv(fd, &data[read], size - read, 0);
+
+        return make_pair(response.substr(0, response.find(' ')), data);
+    };
+
+    istringstream scene_stream(scene);
+    ImageBuilder expected_builder(registry, scene_stream);
+    expected_builder.render();
+    stringstream expected_image;
+    ppm.encode(expected_image, expected_builder.get_image());
+
+    assert(request("ppm", scene) == make_pair(string("OK"), expected_image.str()));
+    assert(request("png", scene).first == "ERROR");
+    auto unsupported = request("ppm", "image 10 10\nsquare (1,1)\n");
+    assert(unsupported.first == "ERROR");
+    assert(unsupported.second.find("unsupported object: square") != string::npos);
+
+    // An idle connection doesn't keep the only worker from the other clients,
+    // and canvases over the limit are refused before they are allocated
+    int idle_fd = fd;
+    fd = connect_client();
+    assert(request("ppm", scene).first == "OK");
+    auto oversized = request("ppm", "image 200 100\n");
+    assert(oversized.first == "ERROR");
+    assert(oversized.second.find("exceeds the limit of 10000 pixels") != string::npos);
+    close(idle_fd);
+    close(fd);
+    fd = connect_client();
+    assert(request("ppm", scene).first == "OK");
+    close(fd);
+
+    server.stop();
+    server_thread.join();
+    cerr.rdbuf(cerr_buffer);
+    assert(server_log.str().find("request") != string::npos);
+    assert(server_log.str().find("supported") == string::npos);
+    assert(server.get_request_count() == 6);
+
     cout
         << "ALL TESTS SUCCESSFUL" << endl;
 
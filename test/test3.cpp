@@ -5,6 +5,7 @@
  */
 
 #include "../src/object/object_registry.hpp"
+#include "../src/object/group.hpp"
 #include "../src/object/line.hpp"
 #include "../src/object/circle.hpp"
 #include "../src/object/rectangle.hpp"
@@ -13,8 +14,16 @@
 #include "../src/object/curve.hpp"
 #include "../src/object/spiral.hpp"
 #include "../src/object/regular_polygon.hpp"
+#include "../src/object/path.hpp"
+#include "../src/object/polyline.hpp"
+#include "../src/profile.hpp"
+#include "../src/trace.hpp"
 
+#include <cassert>
+#include <cmath>
 #include <iostream>
+#include <memory_resource>
+#include <sstream>
 #include <stdexcept>
 
 using namespace std;
@@ -32,7 +41,9 @@ int main()
         .add("polygon", Polygon::parse_from_str)
         .add("curve", Curve::parse_from_str)
         .add("spiral", Spiral::parse_from_str)
-        .add("regular_polygon", RegularPolygon::parse_from_str);
+        .add("regular_polygon", RegularPolygon::parse_from_str)
+        .add("path", Path::parse_from_str)
+        .add("polyline", Polyline::parse_from_str);
 
     supported_objects.parse_from_str("line ((100,100);(200,200)) width=4 color=#1A2B3C");
     supported_objects.parse_from_str("circle (250,250) radius=20");
@@ -42,6 +53,8 @@ int main()
     supported_objects.parse_from_str("curve ((100,100);(150,150);(200,100))");
     supported_objects.parse_from_str("polygon ((100,100);(200,200);(100,300);(0,200))");
     supported_objects.parse_from_str("regular_polygon (100,100) n_sides=6 side=20");
+    supported_objects.parse_from_str("path (M(0,0);L(100,0);Q(150,50)(100,100);Z) width=3");
+    supported_objects.parse_from_str("polyline ((0,0);(100,50);(200,0)) join=bevel cap=round");
 
     try
     {
@@ -186,8 +199,274 @@ int main()
         assert(false);
     }
 
+    // Verbose errors are printed into the given stream only
+    ostringstream err_out;
+    for (ostream *out : {static_cast<ostream *>(&err_out), static_cast<ostream *>(nullptr)})
+        try
+        {
+            supported_objects.parse_from_str("square (1,1)", out);
+            assert(false);
+        }
+        catch (const invalid_argument &e)
+        {
+        }
+    assert(err_out.str().find("supported objects are:") == 0);
+    assert(err_out.str().find("polyline\n") != string::npos);
+    assert(err_out.str().find("supported objects are:", 1) == string::npos);
+
     supported_objects.parse_from_str("circle (0,0) radius=2 width=2");
 
+    pmr::monotonic_buffer_resource arena;
+    Group group(&arena);
+    group.add_object(supported_objects.parse_from_str(
+        "polygon ((100,100);(200,200);(100,300))", nullptr, &arena));
+    group.add_object(*supported_objects.parse_from_str("spiral (50,50) rotations=5"));
+    Object::ptr group_copy = group.clone(&arena);
+    Image image(300, 300);
+    group_copy->render(image, Transform());
+    assert(image.get_buffer()(100, 200).r == 255);
+
+    Group scene_group;
+    for (const char *src : {"line ((10,10);(200,150)) width=4 color=#1A2B3C",
+                            "circle (150,150) radius=40 width=3 color=#f00",
+                            "rectangle ((20,20);(120,80)) width=5 color=#0f0",
+                            "ellipse (150,150) radius_x=60 radius_y=20 color=#00f",
+                            "spiral (150,150) rotations=3",
+                            "curve ((100,100);(150,250);(200,100)) width=3",
+                            "polygon ((100,100);(200,200);(100,280);(0,200)) width=2",
+                            "regular_polygon (150,150) n_sides=7 side=60 width=3"})
+        scene_group.add_object(supported_objects.parse_from_str(src));
+    Group nested_group(Coords(300, 0), Transform::scaling(ScaleFactor(-1, 1.5)), {});
+    nested_group.add_object(scene_group);
+    Group rotated_group(Coords(150, 200), Transform::rotation(30) * Transform::skewing({10, 0}), {});
+    rotated_group.add_object(scene_group);
+
+    Image by_object(300, 400);
+    for (const Group *g : {&scene_group, &nested_group, &rotated_group})
+        g->render(by_object, Transform());
+
+    // Transformations are composed in the order they are written, the last one applied first
+    Transform quarter_turn = Transform::rotation(90);
+    assert(quarter_turn.map(Coords(10, 0)) == Coords(0, 10));
+    assert((Transform::translation(5, 0) * quarter_turn).map(Coords(10, 0)) == Coords(5, 10));
+    assert((quarter_turn * Transform::translation(5, 0)).map(Coords(10, 0)) == Coords(0, 15));
+    assert(Transform::scaling(ScaleFactor(-2, 3)).is_axis_aligned() && !quarter_turn.is_axis_aligned());
+
+    auto render_group = [&](const string &params, const Object &obj)
+    {
+        Group parsed;
+        parsed.add_params(params);
+        parsed.add_object(obj);
+        Image rendered(100, 100);
+        parsed.render(rendered, Transform());
+        return rendered;
+    };
+    auto same_pixels = [](const Image &a, const Image &b)
+    {
+        for (int y = 0; y < a.get_height(); y++)
+            for (int x = 0; x < a.get_width(); x++)
+                if (a.get_buffer()(x, y).r != b.get_buffer()(x, y).r)
+                    return false;
+        return true;
+    };
+    Object::ptr horizontal = supported_objects.parse_from_str("line ((0,0);(20,0))");
+    Image turned = render_group("(50,50) rotate=90", *horizontal);
+    assert(turned.get_buffer()(50, 60).r == 255 && turned.get_buffer()(60, 50).r == 0);
+    assert(same_pixels(render_group("(50,50) translate=(0,10) rotate=90", *horizontal),
+                       render_group("(50,60) rotate=90", *horizontal)));
+
+    // Rotations of nested groups add up, and rotate the translations of the groups inside
+    Group half_turn;
+    half_turn.add_params("(0,0) rotate=45");
+    half_turn.add_object(*horizontal);
+    Group inner;
+    inner.add_params("(0,0) translate=(10,0) rotate=45");
+    inner.add_object(*horizontal);
+    assert(same_pixels(render_group("(50,50) rotate=45", half_turn),
+                       render_group("(50,50) rotate=90", *horizontal)));
+    assert(same_pixels(render_group("(50,50) rotate=45", inner),
+                       render_group("(50,50) rotate=45 translate=(10,0) rotate=45", *horizontal)));
+    // Lines scaled non-uniformly keep their thickness along the same axis as unscaled
+    Object::ptr gentle = supported_objects.parse_from_str("line ((0,0);(10,8)) width=3");
+    Image stretched = render_group("(5,5) scale=(1,3)", *gentle);
+    assert(stretched.get_buffer()(5, 4).r == 255 && stretched.get_buffer()(4, 5).r == 0);
+    Image sheared = render_group("(5,5) skew=(0,60)", *gentle);
+    assert(sheared.get_buffer()(4, 5).r == 255 && sheared.get_buffer()(5, 4).r == 0);
+    Rect turned_bounds = Group(Coords(50, 50), quarter_turn, {}).add_object(*horizontal)
+                             .get_bounds(Transform());
+    assert(turned_bounds.contains(Rect(Coords(50, 50), Coords(51, 70))));
+
+    // Circles scaled non-uniformly become ellipses, rotated ellipses keep their radii
+    Object::ptr round = supported_objects.parse_from_str("circle (0,0) radius=20");
+    assert(same_pixels(render_group("(50,50) scale=(2,1)", *round),
+                       render_group("(50,50)", *supported_objects.parse_from_str(
+                                                   "ellipse (0,0) radius_x=40 radius_y=20"))));
+    EllipseAxes axes = (quarter_turn * Transform::scaling(ScaleFactor(2, -1)))
+                           .transform_ellipse(10, 10);
+    assert(abs(axes.radius_x - 20) < 1e-9 && abs(axes.radius_y - 10) < 1e-9);
+    assert(abs(abs(axes.rotation) - M_PI / 2) < 1e-9);
+
+    Object::ptr flat = supported_objects.parse_from_str("ellipse (0,0) radius_x=40 radius_y=10");
+    for (const char *params : {"(50,50) rotate=30", "(50,50) skew=(20,0) scale=(1,0.5)"})
+    {
+        Group tilted;
+        tilted.add_params(params);
+        tilted.add_object(*flat);
+        Image rendered(100, 100);
+        tilted.render(rendered, Transform());
+        Rect bounds = tilted.get_bounds(Transform());
+        size_t lit = 0;
+        for (int y = 0; y < 100; y++)
+            for (int x = 0; x < 100; x++)
+                if (rendered.get_buffer()(x, y).r == 255)
+                {
+                    assert(bounds.contains(Rect(Coords(x, y), Coords(x + 1, y + 1))));
+                    lit++;
+                }
+        assert(lit > 100);
+    }
+    Image tilted = render_group("(50,50) rotate=30", *flat);
+    Coords tip(50 + 40 * cos(M_PI / 6), 50 + 40 * sin(M_PI / 6));
+    bool has_tip = false;
+    for (int dy = -1; dy <= 1; dy++)
+        for (int dx = -1; dx <= 1; dx++)
+            has_tip |= tilted.get_buffer()(tip.x + dx, tip.y + dy).r == 255;
+    assert(has_tip && tilted.get_buffer()(90, 50).r == 0 && tilted.get_buffer()(50, 50).r == 0);
+
+    // Corners of polylines are mitered or beveled, ends are capped only when asked to
+    auto render_object = [&](const string &src)
+    {
+        Image rendered(100, 100);
+        supported_objects.parse_from_str(src)->render(rendered, Transform());
+        return rendered;
+    };
+    const string corner = "polyline ((10,10);(50,10);(50,50)) width=6";
+    assert(render_object(corner).get_buffer()(52, 8).r == 255);
+    assert(render_object(corner + " join=bevel").get_buffer()(52, 8).r == 0);
+    assert(render_object(corner).get_buffer()(7, 10).r == 0);
+    assert(render_object(corner + " cap=square").get_buffer()(8, 10).r == 255);
+
+    // The whole stroke is filled at once, so overlapping pieces are blended only once
+    Image translucent = render_object("polyline ((10,50);(90,50);(20,20);(50,90)) width=7 "
+                                      "join=round cap=round color=#ffffff80");
+    Rect stroke_bounds = supported_objects.parse_from_str(
+        "polyline ((10,50);(90,50);(20,20);(50,90)) width=7 join=round cap=round")
+                             ->get_bounds(Transform());
+    for (int y = 0; y < 100; y++)
+        for (int x = 0; x < 100; x++)
+        {
+            uint8_t value = translucent.get_buffer()(x, y).r;
+            assert(value == 0 || value == translucent.get_buffer()(10, 50).r);
+            assert(value == 0 || stroke_bounds.contains(Rect(Coords(x, y), Coords(x + 1, y + 1))));
+        }
+    assert(translucent.get_buffer()(10, 50).r > 0 && translucent.get_buffer()(10, 50).r < 255);
+
+    Image closed = render_object("path (M(20,20);L(80,20);Q(80,80)(20,80);Z) width=3");
+    assert(closed.get_buffer()(20, 50).r == 255 && closed.get_buffer()(50, 20).r == 255);
+    assert(closed.get_buffer()(50, 50).r == 0 && closed.get_buffer()(80, 80).r == 0);
+
+    // Regular polygons are closed outlines, so all of their corners are mitered
+    for (const char *src : {"regular_polygon (50,50) n_sides=4 side=30 width=5",
+                            "regular_polygon (50,50) n_sides=500 side=40 width=2 color=#ffffff80"})
+    {
+        Object::ptr regular = supported_objects.parse_from_str(src);
+        Image rendered(100, 100);
+        regular->render(rendered, Transform());
+        Rect bounds = regular->get_bounds(Transform());
+        size_t lit = 0;
+        uint8_t value = 0;
+        for (int y = 0; y < 100; y++)
+            for (int x = 0; x < 100; x++)
+                if (rendered.get_buffer()(x, y).r != 0)
+                {
+                    assert(bounds.contains(Rect(Coords(x, y), Coords(x + 1, y + 1))));
+                    assert(lit++ == 0 || rendered.get_buffer()(x, y).r == value);
+                    value = rendered.get_buffer()(x, y).r;
+                }
+        assert(lit > 200 && rendered.get_buffer()(50, 50).r == 0);
+    }
+    Image square = render_object("regular_polygon (50,50) n_sides=4 side=30 width=5");
+    assert(square.get_buffer()(73, 73).r == 255 && square.get_buffer()(27, 27).r == 255);
+
+    // Spirals are stroked as a single path, so their half-rotations are blended only once
+    Object::ptr spiral = supported_objects.parse_from_str("spiral (50,50) rotations=4 width=2 color=#ffffff80");
+    Image spiral_image(100, 100);
+    spiral->render(spiral_image, Transform());
+    Rect spiral_bounds = spiral->get_bounds(Transform());
+    size_t spiral_lit = 0;
+    uint8_t spiral_value = 0;
+    for (int y = 0; y < 100; y++)
+        for (int x = 0; x < 100; x++)
+            if (spiral_image.get_buffer()(x, y).r != 0)
+            {
+                assert(spiral_bounds.contains(Rect(Coords(x, y), Coords(x + 1, y + 1))));
+                assert(spiral_lit++ == 0 || spiral_image.get_buffer()(x, y).r == spiral_value);
+                spiral_value = spiral_image.get_buffer()(x, y).r;
+            }
+    assert(spiral_lit > 300 && spiral_value < 255);
+
+    for (const char *src : {"path (L(0,0))", "path (M(0,0);Q(1,1))", "path (M(0,0))",
+                            "path M(0,0);L(1,1)", "path (M(0,0);X(1,1))",
+                            "polyline ((0,0))", "polyline ((0,0);(1,1)) join=sharp"})
+    {
+        try
+        {
+            supported_objects.parse_from_str(src);
+            assert(false);
+        }
+        catch (const invalid_argument &e)
+        {
+        }
+    }
+
+    for (const char *params : {"(0,0) shear=(1,1)", "(0,0) rotate=abc", "(0,0) skew=10",
+                               "(0,0) translate=(1,2"})
+    {
+        try
+        {
+            Group invalid;
+            invalid.add_params(params);
+            assert(false);
+        }
+        catch (const invalid_argument &e)
+        {
+        }
+    }
+
+    // Spans are recorded only while tracing is enabled, nested groups are labeled by their definition
+    ostringstream trace_json;
+    nested_group.render_traced(by_object, Transform());
+    trace::write_json(trace_json);
+    assert(trace_json.str().find("\"ph\": \"X\"") == string::npos);
+
+    nested_group.set_definition_name("nested");
+    assert(nested_group.get_label() == "group nested" && scene_group.get_label() == "group");
+    assert(Group(nested_group).get_definition_name() == "nested");
+    trace::enable();
+    trace::set_thread_name("test");
+    nested_group.render_traced(by_object, Transform());
+    trace::disable();
+    trace::write_json(trace_json);
+    for (const char *span : {"\"group nested\"", "\"regular_polygon\"", "\"thread_name\""})
+        assert(trace_json.str().find(span) != string::npos);
+
+    // Profiled renders are attributed to source lines and group definitions, including nested ones
+    ObjectProfile profile;
+    Image profiled(300, 400);
+    nested_group.set_source_line(7);
+    {
+        ObjectProfile::Activation activation(&profile);
+        assert(ObjectProfile::get_active() == &profile);
+        nested_group.render_traced(profiled, Transform());
+        nested_group.render_traced(profiled, Transform());
+    }
+    assert(ObjectProfile::get_active() == nullptr);
+    assert(profile.get_lines().size() == 1 && profile.get_lines().at(7).renders == 2);
+    assert(profile.get_lines().at(7).label == "group nested");
+    assert(profile.get_groups().at("nested").pixels_written ==
+           profiled.get_buffer().get_pixels_written());
+    assert(profile.get_total_seconds() >= profile.get_groups().at("nested").seconds);
+
     cout << "ALL TESTS SUCCESSFUL" << endl;
 
     return EXIT_SUCCESS;
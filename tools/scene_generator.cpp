@@ -0,0 +1,463 @@
+/**
+ * @file scene_generator.cpp
+ * @author Adam Berkeš <berkeada@fit.cvut.cz>
+ * @date 2026-10-19
+ *
+ * Generator of synthetic scene configs for scale and stress testing,
+ * the generated scene is printed to stdout.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <getopt.h>
+#include <iostream>
+#include <map>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+static const char *help_msg =
+    "Usage: shapescape_gen <option(s)> > SCENE\n"
+    "Options:\n"
+    "\t-h, --help\tShow this help message\n"
+    "\t-n, --count=N\tNumber of top-level objects (default 1000)\n"
+    "\t-s, --size=WxH\tCanvas size (default 1000x1000)\n"
+    "\t-m, --mix=TYPE:WEIGHT,...\tRelative weights of object types, e.g. line:3,circle:1\n"
+    "\t\t(default all of line, circle, ellipse, rectangle, polygon, curve, spiral,\n"
+    "\t\tregular_polygon equally)\n"
+    "\t-d, --depth=D\tNesting depth of generated groups, 0 for no groups (default 0)\n"
+    "\t-i, --instances=K\tInstances of the nested group in each group and top-level\n"
+    "\t\tinstances of the outermost group (default 4)\n"
+    "\t-g, --group-objects=M\tObjects in the innermost group (default 8)\n"
+    "\t-o, --off-canvas=F\tFraction of top-level geometry placed completely\n"
+    "\t\toff the canvas, from 0 to 1 (default 0)\n"
+    "\t-z, --object-size=S\tMaximum extent of a single object (default 100)\n"
+    "\t-w, --max-width=W\tMaximum stroke width (default 5)\n"
+    "\t-r, --seed=SEED\tSeed of the random generator (default 1)\n";
+
+/** Configuration of the generated scene */
+struct GeneratorConfig
+{
+    int count = 1000;
+    int width = 1000, height = 1000;
+    map<string, double> mix = {{"line", 1}, {"circle", 1}, {"ellipse", 1}, {"rectangle", 1},
+                               {"polygon", 1}, {"curve", 1}, {"spiral", 1},
+                               {"regular_polygon", 1}};
+    int depth = 0;
+    int instances = 4;
+    int group_objects = 8;
+    double off_canvas = 0;
+    int object_size = 100;
+    int max_width = 5;
+    unsigned seed = 1;
+};
+
+/** Parse integer option value which has to be at least min */
+static int parse_int(const string &name, const string &value, int min)
+{
+    size_t parsed = 0;
+    int res;
+
+    try
+    {
+        res = stoi(value, &parsed);
+    }
+    catch (...)
+    {
+        parsed = 0;
+    }
+
+    if (parsed != value.size() || parsed == 0 || res < min)
+        throw invalid_argument(name + " has to be an integer of at least " + to_string(min));
+
+    return res;
+}
+
+/** Parse decimal option value which has to be in the range <min,max> */
+static double parse_double(const string &name, const string &value, double min, double max)
+{
+    size_t parsed = 0;
+    double res;
+
+    try
+    {
+        res = stod(value, &parsed);
+    }
+    catch (...)
+    {
+        parsed = 0;
+    }
+
+    if (parsed != value.size() || parsed == 0 || res < min || res > max)
+        throw invalid_argument(name + " has to be a number in range <" + to_string(min) + ',' +
+                               to_string(max) + '>');
+
+    return res;
+}
+
+/** Parse object mix in the form type:weight,type:weight,... */
+static map<string, double> parse_mix(const string &value)
+{
+    const map<string, double> supported = GeneratorConfig().mix;
+    map<string, double> mix;
+    size_t start = 0;
+
+    while (start <= value.size())
+    {
+        size_t end = value.find(',', start);
+        string item = value.substr(start, end == string::npos ? string::npos : end - start);
+        size_t colon = item.find(':');
+        string type = item.substr(0, colon);
+
+        if (supported.count(type) == 0)
+            throw invalid_argument("unsupported object in mix: " + type);
+
+        mix[type] = colon == string::npos
+                        ? 1
+                        : parse_double("weight of " + type, item.substr(colon + 1), 0, 1e9);
+
+        if (end == string::npos)
+            break;
+        start = end + 1;
+    }
+
+    double total = 0;
+    for (const auto &[_, weight] : mix)
+        total += weight;
+
+    if (total <= 0)
+        throw invalid_argument("object mix needs at least one positive weight");
+
+    return mix;
+}
+
+/** Parse command line options into the generator config */
+static bool parse_opts(int argc, char *argv[], GeneratorConfig &config)
+{
+    const option opts[] = {
+        {"help", no_argument, nullptr, 'h'},
+        {"count", required_argument, nullptr, 'n'},
+        {"size", required_argument, nullptr, 's'},
+        {"mix", required_argument, nullptr, 'm'},
+        {"depth", required_argument, nullptr, 'd'},
+        {"instances", required_argument, nullptr, 'i'},
+        {"group-objects", required_argument, nullptr, 'g'},
+        {"off-canvas", required_argument, nullptr, 'o'},
+        {"object-size", required_argument, nullptr, 'z'},
+        {"max-width", required_argument, nullptr, 'w'},
+        {"seed", required_argument, nullptr, 'r'},
+        {nullptr, no_argument, nullptr, 0}};
+
+    while (true)
+    {
+        const int opt = getopt_long(argc, argv, "hn:s:m:d:i:g:o:z:w:r:", opts, 0);
+
+        if (opt == -1)
+            break;
+
+        switch (opt)
+        {
+        case 'h':
+            cerr << help_msg;
+            return false;
+        case 'n':
+            config.count = parse_int("count", optarg, 0);
+            break;
+        case 's':
+        {
+            string size = optarg;
+            size_t x = size.find('x');
+            if (x == string::npos)
+                throw invalid_argument("size has to be in the form WxH");
+            config.width = parse_int("width", size.substr(0, x), 1);
+            config.height = parse_int("height", size.substr(x + 1), 1);
+            break;
+        }
+        case 'm':
+            config.mix = parse_mix(optarg);
+            break;
+        case 'd':
+            config.depth = parse_int("depth", optarg, 0);
+            break;
+        case 'i':
+            config.instances = parse_int("instances", optarg, 0);
+            break;
+        case 'g':
+            config.group_objects = parse_int("group-objects", optarg, 1);
+            break;
+        case 'o':
+            config.off_canvas = parse_double("off-canvas", optarg, 0, 1);
+            break;
+        case 'z':
+            config.object_size = parse_int("object-size", optarg, 4);
+            break;
+        case 'w':
+            config.max_width = parse_int("max-width", optarg, 1);
+            break;
+        case 'r':
+            config.seed = parse_int("seed", optarg, 0);
+            break;
+        default:
+            throw invalid_argument("invalid option entered");
+        }
+    }
+
+    if (optind != argc)
+        throw invalid_argument("invalid argument entered: " + string(argv[optind]));
+
+    return true;
+}
+
+/** Generator of random scenes based on the config */
+class SceneGenerator
+{
+    GeneratorConfig config;
+    mt19937 rng;
+    vector<string> types;
+    discrete_distribution<size_t> type_dist;
+
+    /** Random integer from <min,max> */
+    int random_int(int min, int max)
+    {
+        return uniform_int_distribution<int>(min, max)(rng);
+    }
+
+    /** Format point as (x,y) */
+    static string point(int x, int y)
+    {
+        return '(' + to_string(x) + ',' + to_string(y) + ')';
+    }
+
+    /** Random style with given width and random color */
+    string random_style(int width)
+    {
+        const char *hex = "0123456789abcdef";
+        string color = "#";
+
+        for (int i = 0; i < 6; i++)
+            color += hex[random_int(0, 15)];
+
+        return " width=" + to_string(width) + " color=" + color;
+    }
+
+    /**
+     * Random star-shaped polygon around the center, no three consecutive
+     * vertices are colinear, since such polygons are rejected when parsed
+     */
+    vector<pair<int, int>> random_polygon(int cx, int cy, int radius)
+    {
+        const double PI = acos(-1);
+        vector<pair<int, int>> vertices;
+
+        while (true)
+        {
+            int count = random_int(3, 8);
+            vector<double> angles;
+            for (int i = 0; i < count; i++)
+                angles.push_back(uniform_real_distribution<double>(0, 2 * PI)(rng));
+            sort(angles.begin(), angles.end());
+
+            vertices.clear();
+            for (double angle : angles)
+            {
+                int r = random_int(max(1, radius / 3), max(1, radius));
+                vertices.push_back({cx + static_cast<int>(r * cos(angle)),
+                                    cy + static_cast<int>(r * sin(angle))});
+            }
+
+            bool is_valid = true;
+            for (int i = 0; i < count; i++)
+            {
+                const auto &[ax, ay] = vertices[i];
+                const auto &[bx, by] = vertices[(i + 1) % count];
+                const auto &[px, py] = vertices[(i + 2) % count];
+                long cross = static_cast<long>(bx - ax) * (py - by) -
+                             static_cast<long>(by - ay) * (px - bx);
+                is_valid = is_valid && cross != 0;
+            }
+
+            if (is_valid)
+                return vertices;
+        }
+    }
+
+    /** Random object of random type fitting into the object box at x, y */
+    string random_object(int x, int y)
+    {
+        const string &type = types[type_dist(rng)];
+        int size = config.object_size, half = size / 2, width = random_int(1, config.max_width);
+        string style = random_style(width);
+        auto random_point = [&]()
+        { return point(x + random_int(0, size), y + random_int(0, size)); };
+
+        if (type == "line" || type == "rectangle")
+            return type + " (" + random_point() + ';' + random_point() + ')' + style;
+        else if (type == "circle")
+            return type + ' ' + point(x + half, y + half) +
+                   " radius=" + to_string(random_int(1, half)) + style;
+        else if (type == "ellipse")
+            return type + ' ' + point(x + half, y + half) +
+                   " radius_x=" + to_string(random_int(1, half)) +
+                   " radius_y=" + to_string(random_int(1, half)) + style;
+        else if (type == "polygon")
+        {
+            vector<pair<int, int>> vertices = random_polygon(x + half, y + half, half);
+            string vertices_str;
+
+            for (const auto &[vx, vy] : vertices)
+                vertices_str += (vertices_str.empty() ? "" : ";") + point(vx, vy);
+
+            return type + " (" + vertices_str + ')' + style;
+        }
+        else if (type == "curve")
+            return type + " (" + random_point() + ';' + random_point() + ';' + random_point() +
+                   ')' + style;
+        else if (type == "spiral")
+            // Each rotation grows the spiral by 8 times its width
+            return type + ' ' + point(x + half, y + half) + " rotations=" +
+                   to_string(max(1, min(6, half / (8 * width)))) + style;
+        else
+            return type + ' ' + point(x + half, y) + " n_sides=" + to_string(random_int(3, 12)) +
+                   " side=" + to_string(max(1, random_int(size / 8, size / 3))) + style;
+    }
+
+    /**
+     * Random scale of a group instance, mostly identity. Groups are never
+     * enlarged, so that they always stay within the extent of their level
+     */
+    string random_scale()
+    {
+        switch (random_int(0, 7))
+        {
+        case 0:
+            return " scale=(-1,1)";
+        case 1:
+            return " scale=(1,-1)";
+        case 2:
+            return " scale=(0.5,0.5)";
+        default:
+            return "";
+        }
+    }
+
+    /** Get extent of the group of given level */
+    int get_group_extent(int level) const
+    {
+        int extent = config.object_size;
+
+        for (int i = 0; i <= level; i++)
+            extent *= 3;
+
+        return extent;
+    }
+
+    /** Random position of a top-level box of given extent, either on or off the canvas */
+    pair<int, int> random_position(int extent)
+    {
+        if (uniform_real_distribution<double>(0, 1)(rng) >= config.off_canvas)
+            return {random_int(0, max(0, config.width - extent)),
+                    random_int(0, max(0, config.height - extent))};
+
+        // Place the box completely outside of one of the canvas sides, keeping a margin
+        // for strokes, mirrored groups and geometry protruding from its box
+        int margin = 2 * extent + 2 * config.max_width + 16;
+        switch (random_int(0, 3))
+        {
+        case 0:
+            return {-margin - random_int(0, config.width), random_int(-margin, config.height)};
+        case 1:
+            return {config.width + margin + random_int(0, config.width),
+                    random_int(-margin, config.height)};
+        case 2:
+            return {random_int(-margin, config.width), -margin - random_int(0, config.height)};
+        default:
+            return {random_int(-margin, config.width),
+                    config.height + margin + random_int(0, config.height)};
+        }
+    }
+
+public:
+    SceneGenerator(const GeneratorConfig &config_) : config(config_), rng(config_.seed)
+    {
+        vector<double> weights;
+
+        for (const auto &[type, weight] : config.mix)
+        {
+            types.push_back(type);
+            weights.push_back(weight);
+        }
+
+        type_dist = discrete_distribution<size_t>(weights.begin(), weights.end());
+    }
+
+    /** Generate the whole scene into the output stream */
+    void generate(ostream &out)
+    {
+        out << "image " << config.width << ' ' << config.height << " background=#000\n\n";
+
+        // Each group consists of instances of the group nested in it,
+        // the innermost group consists of objects
+        for (int level = 0; level < config.depth; level++)
+        {
+            out << "start_group g" << level << '\n';
+
+            if (level == 0)
+            {
+                int range = get_group_extent(0) - config.object_size;
+                for (int i = 0; i < config.group_objects; i++)
+                    out << "    " << random_object(random_int(0, range), random_int(0, range))
+                        << '\n';
+            }
+            else
+            {
+                int range = get_group_extent(level) - get_group_extent(level - 1);
+                for (int i = 0; i < config.instances; i++)
+                    out << "    g" << level - 1 << ' '
+                        << point(random_int(0, range), random_int(0, range)) << random_scale()
+                        << '\n';
+            }
+
+            out << "end_group\n\n";
+        }
+
+        int group_instances = config.depth > 0 ? config.instances : 0,
+            remaining_objects = config.count;
+
+        // Spread the group instances randomly among the objects
+        for (int remaining = config.count + group_instances; remaining > 0; remaining--)
+            if (random_int(1, remaining) <= remaining_objects)
+            {
+                const auto &[x, y] = random_position(config.object_size);
+                out << random_object(x, y) << '\n';
+                remaining_objects--;
+            }
+            else
+            {
+                const auto &[x, y] = random_position(get_group_extent(config.depth - 1));
+                out << 'g' << config.depth - 1 << ' ' << point(x, y) << random_scale() << '\n';
+            }
+    }
+};
+
+int main(int argc, char *argv[])
+{
+    GeneratorConfig config;
+
+    try
+    {
+        if (!parse_opts(argc, argv, config))
+            return EXIT_SUCCESS;
+
+        SceneGenerator(config).generate(cout);
+    }
+    catch (const invalid_argument &e)
+    {
+        cerr << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}